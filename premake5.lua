@@ -3,6 +3,42 @@ workspace "glfx"
     configurations { "Debug", "Release" }
     startproject "Pglang"
 
+newoption {
+    trigger = "gfxl-shared",
+    description = "Build libgfxl as a shared library instead of a static one"
+}
+
+-- Embeddable compiler library (C API in src/gfxl.h)
+project "gfxl"
+    language "C++"
+    cppdialect "C++20"
+    targetdir ("bin/%{cfg.buildcfg}")
+    objdir ("bin-int/%{cfg.buildcfg}")
+
+    files { "src/**.h", "src/**.cpp" }
+    removefiles { "src/Main.cpp" }
+
+    includedirs { "src" }
+
+    if _OPTIONS["gfxl-shared"] then
+        kind "SharedLib"
+        defines { "GFXL_SHARED", "GFXL_BUILD" }
+        visibility "Hidden"
+    else
+        kind "StaticLib"
+    end
+
+    filter "system:windows"
+        systemversion "latest"
+
+    filter "configurations:Debug"
+        symbols "On"
+        defines { "DEBUG" }
+
+    filter "configurations:Release"
+        optimize "On"
+        defines { "NDEBUG" }
+
 project "GLFX"
     kind "ConsoleApp"
     language "C++"
@@ -10,9 +46,10 @@ project "GLFX"
     targetdir ("bin/%{cfg.buildcfg}")
     objdir ("bin-int/%{cfg.buildcfg}")
 
-    files { "src/**.h", "src/**.cpp" }
+    files { "src/Main.cpp" }
 
     includedirs { "src" }
+    links { "gfxl" }
 
     filter "system:windows"
         systemversion "latest"
@@ -21,6 +58,57 @@ project "GLFX"
         symbols "On"
         defines { "DEBUG" }
 
+    filter "configurations:Release"
+        optimize "On"
+        defines { "NDEBUG" }
+
+-- Performance-pathology fuzzer: flags inputs whose compile time or memory grows super-linearly
+project "GLFXFuzz"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++20"
+    targetdir ("bin/%{cfg.buildcfg}")
+    objdir ("bin-int/%{cfg.buildcfg}")
+
+    files { "tools/pathology_fuzz.cpp" }
+
+    includedirs { "src" }
+    links { "gfxl" }
+
+    filter "system:windows"
+        systemversion "latest"
+
+    filter "configurations:Debug"
+        symbols "On"
+        defines { "DEBUG" }
+
+    filter "configurations:Release"
+        optimize "On"
+        defines { "NDEBUG" }
+
+-- Compiler throughput benchmarks (lexer, parser, ...)
+project "GLFXBench"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++20"
+    targetdir ("bin/%{cfg.buildcfg}")
+    objdir ("bin-int/%{cfg.buildcfg}")
+
+    files { "tools/compile_bench.cpp" }
+
+    includedirs { "src" }
+    links { "gfxl" }
+
+    filter "system:windows"
+        systemversion "latest"
+
+    filter "system:linux"
+        links { "pthread" }
+
+    filter "configurations:Debug"
+        symbols "On"
+        defines { "DEBUG" }
+
     filter "configurations:Release"
         optimize "On"
         defines { "NDEBUG" }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdbool.h>
 
 void print_int(long n) {
   printf("%ld\n", n);
@@ -0,0 +1,165 @@
+#!/bin/bash
+# Runtime benchmark harness for the kernels in bench/kernels.
+#
+# Every kernel is compiled with each backend in $BACKENDS, executed $RUNS
+# times, and the stdout of each backend is checked against the first one.
+# Reports the median wall time and, when `perf` is usable, the number of
+# user-space instructions retired by a single run.
+#
+# Usage: scripts/bench.sh [kernel.glx ...]
+#   GFXL=path/to/GLFX   compiler binary   (default: bin/Release/GLFX)
+#   BACKENDS="asm ..."  backends to run   (default: every known backend)
+#   RUNS=N              timed runs        (default: 5)
+#   GFXL_FLAGS="..."    extra compiler flags, e.g. "-O0" or "--passes=fold,propagate"
+#                       to measure optimization passes one at a time
+set -uo pipefail
+
+ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+GFXL="${GFXL:-$ROOT/bin/Release/GLFX}"
+RUNS="${RUNS:-5}"
+read -r -a FLAGS <<< "${GFXL_FLAGS:-}"
+BACKENDS="${BACKENDS:-asm obj c mv_sse2 mv_avx2 mv_avx512 jit interp}"
+PRINT_INT_C="$ROOT/print_int.c"
+
+if [ ! -x "$GFXL" ]; then
+    echo "[!] Compiler not found at $GFXL (build with premake, or set GFXL=...)"
+    exit 1
+fi
+
+WORK="$(mktemp -d)"
+trap 'rm -rf "$WORK"' EXIT
+
+HAVE_PERF=0
+if command -v perf >/dev/null 2>&1 && perf stat -x, -e instructions:u true >/dev/null 2>&1; then
+    HAVE_PERF=1
+fi
+
+# Runtime helpers are shared by every natively linked backend.
+gcc -O2 -c -o "$WORK/print_int.o" "$PRINT_INT_C" || {
+    echo "[!] print_int.c compile error"
+    exit 1
+}
+
+# --- Backends ---
+# Each build_<backend> takes (kernel, output_dir) and leaves an executable
+# command line in "$2/cmd". A non-zero return marks the backend unavailable.
+
+build_asm() {
+    local kernel="$1" dir="$2"
+    (cd "$dir" && "$GFXL" "$kernel" "$dir/out.s" "${FLAGS[@]}") > "$dir/compile.log" 2>&1 || return 1
+    as -o "$dir/out.o" "$dir/out.s" 2>> "$dir/compile.log" || return 1
+    gcc -o "$dir/program" "$dir/out.o" "$WORK/print_int.o" 2>> "$dir/compile.log" || return 1
+    echo "$dir/program" > "$dir/cmd"
+}
+
+# Object file written directly by the built-in assembler (--emit=obj); no `as`.
+build_obj() {
+    local kernel="$1" dir="$2"
+    (cd "$dir" && "$GFXL" "$kernel" "${FLAGS[@]}" --emit=obj -o "$dir/out.o") > "$dir/compile.log" 2>&1 || return 1
+    gcc -o "$dir/program" "$dir/out.o" "$WORK/print_int.o" 2>> "$dir/compile.log" || return 1
+    echo "$dir/program" > "$dir/cmd"
+}
+
+# Portable C (--emit=c) optimized by the system C compiler; CC/CFLAGS override it.
+build_c() {
+    local kernel="$1" dir="$2"
+    (cd "$dir" && "$GFXL" "$kernel" "${FLAGS[@]}" --emit=c -o "$dir/out.c") > "$dir/compile.log" 2>&1 || return 1
+    ${CC:-cc} ${CFLAGS:--O3} -std=c11 -o "$dir/program" "$dir/out.c" "$WORK/print_int.o" 2>> "$dir/compile.log" || return 1
+    echo "$dir/program" > "$dir/cmd"
+}
+
+# Multiversioned C (--emit=c --multiversion) with the startup dispatch forced to
+# one level through GFXL_ISA; on CPUs without that level the next lower one runs.
+build_mv() {
+    local isa="$1" kernel="$2" dir="$3"
+    (cd "$dir" && "$GFXL" "$kernel" "${FLAGS[@]}" --emit=c --multiversion -o "$dir/out.c") > "$dir/compile.log" 2>&1 || return 1
+    ${CC:-cc} ${CFLAGS:--O3} -std=c11 -o "$dir/program" "$dir/out.c" "$WORK/print_int.o" 2>> "$dir/compile.log" || return 1
+    echo "env GFXL_ISA=$isa $dir/program" > "$dir/cmd"
+}
+build_mv_sse2() { build_mv sse2 "$@"; }
+build_mv_avx2() { build_mv avx2 "$@"; }
+build_mv_avx512() { build_mv avx512 "$@"; }
+
+# Compiled in memory and run in-process by the JIT (--run); timings include compilation.
+build_jit() {
+    local kernel="$1" dir="$2"
+    "$GFXL" "$kernel" "${FLAGS[@]}" --run > /dev/null 2> "$dir/compile.log" || return 1
+    echo "$GFXL $kernel ${FLAGS[*]} --run" > "$dir/cmd"
+}
+
+# Bytecode interpreter only (--run=interp).
+build_interp() {
+    local kernel="$1" dir="$2"
+    "$GFXL" "$kernel" --run=interp > /dev/null 2> "$dir/compile.log" || return 1
+    echo "$GFXL $kernel --run=interp" > "$dir/cmd"
+}
+
+# --- Measurement helpers ---
+
+now_ns() {
+    date +%s%N
+}
+
+median() {
+    sort -n | awk '{ v[NR] = $1 } END { if (NR % 2) print v[(NR + 1) / 2]; else print int((v[NR / 2] + v[NR / 2 + 1]) / 2) }'
+}
+
+instructions() {
+    perf stat -x, -e instructions:u "$@" 2>&1 >/dev/null | awk -F, '/instructions/ { print $1; exit }'
+}
+
+# --- Main loop ---
+
+KERNELS=("$@")
+if [ ${#KERNELS[@]} -eq 0 ]; then
+    KERNELS=("$ROOT"/bench/kernels/*.glx)
+fi
+
+FAILED=0
+printf "%-20s %-8s %12s %14s  %s\n" "kernel" "backend" "median(us)" "instructions" "output"
+
+for kernel in "${KERNELS[@]}"; do
+    kernel="$(cd "$(dirname "$kernel")" && pwd)/$(basename "$kernel")"
+    name="$(basename "$kernel" .glx)"
+    reference=""
+
+    for backend in $BACKENDS; do
+        dir="$WORK/$name.$backend"
+        mkdir -p "$dir"
+
+        if ! "build_$backend" "$kernel" "$dir"; then
+            printf "%-20s %-8s %12s %14s  %s\n" "$name" "$backend" "-" "-" "build failed ($dir/compile.log)"
+            sed 's/^/    /' "$dir/compile.log" | tail -n 5
+            FAILED=1
+            continue
+        fi
+        read -r -a cmd < "$dir/cmd"
+
+        "${cmd[@]}" > "$dir/stdout" 2>/dev/null
+        status="ok"
+        if [ -z "$reference" ]; then
+            reference="$dir/stdout"
+        elif ! cmp -s "$reference" "$dir/stdout"; then
+            status="MISMATCH vs $(basename "$(dirname "$reference")")"
+            FAILED=1
+        fi
+
+        times=()
+        for ((i = 0; i < RUNS; i++)); do
+            start=$(now_ns)
+            "${cmd[@]}" > /dev/null 2>&1
+            end=$(now_ns)
+            times+=($(( (end - start) / 1000 )))
+        done
+        med=$(printf "%s\n" "${times[@]}" | median)
+
+        insns="-"
+        if [ "$HAVE_PERF" -eq 1 ]; then
+            insns="$(instructions "${cmd[@]}")"
+        fi
+
+        printf "%-20s %-8s %12s %14s  %s\n" "$name" "$backend" "$med" "${insns:--}" "$status"
+    done
+done
+
+exit $FAILED
@@ -1,28 +1,17 @@
 // Codegen.cpp
 #include "Codegen.h"
+#include "inline_asm.h"
+#include "optimizer.h" // expressionText, for remarks
 #include <iostream> // For error messages or debug output
 #include <stdexcept> // For std::runtime_error
-#include <random>    // For std::mt19937_64 and std::uniform_int_distribution
-#include <chrono>    // For seeding the random number generator
 #include <string>
 #include <map>
-
-// External declaration for tokenTypeStrings (defined in Token.cpp)
-extern const std::map<TokenType, std::string> tokenTypeStrings;
-
-// --- Static Members and Global Helpers ---
-// For generating unique labels in assembly
-static std::mt19937_64 rng(std::chrono::high_resolution_clock::now().time_since_epoch().count());
-static std::uniform_int_distribution<long long> dist; // Using default range for simplicity
-static long long labelCounter = 0; // Better for sequential labels
-
-std::string generateUniqueLabel(const std::string& prefix) {
-    return prefix + std::to_string(labelCounter++);
-}
+#include <algorithm>
+#include <cstdlib>
 
 // --- CodeGenerator Implementation ---
 
-CodeGenerator::CodeGenerator() : stackOffsetCounter_(0), targetPlatform_(PLATFORM_UNKNOWN) {
+CodeGenerator::CodeGenerator(const CodegenOptions& options) : options_(options), stackOffsetCounter_(0), targetPlatform_(PLATFORM_UNKNOWN) {
     // Detect platform at compiler's compile-time
 #if defined(_WIN32) || defined(_WIN64)
     targetPlatform_ = PLATFORM_WINDOWS_MINGW; // Assume MinGW for simplicity
@@ -41,6 +30,14 @@ std::string CodeGenerator::generate(const Program* program_ast) {
         return "";
     }
 
+    symbolTable_.assign(program_ast->slotCount, {});
+    if (options_.optimizeSize) {
+        planSizeOptimizedFrame(program_ast);
+    }
+    if (options_.useRanges) {
+        ranges_.run(*program_ast);
+    }
+
     // Emit platform-specific boilerplate prologue
     emitMainPrologue();
 
@@ -50,19 +47,89 @@ std::string CodeGenerator::generate(const Program* program_ast) {
     // Emit platform-specific boilerplate epilogue
     emitMainEpilogue();
 
+    if (options_.useRanges) {
+        remarks_.insert(remarks_.end(), ranges_.remarks().begin(), ranges_.remarks().end());
+        std::stable_sort(remarks_.begin(), remarks_.end(), [](const Remark& a, const Remark& b) { return a.offset < b.offset; });
+    }
+
     return ss.str();
 }
 
-std::vector<std::string> CodeGenerator::getErrors() const {
+const std::vector<Diagnostic>& CodeGenerator::getErrors() const {
     return errors_;
 }
 
 void CodeGenerator::error(const std::string& msg) {
-    errors_.push_back(msg);
+    errors_.push_back({ DIAG_CODEGEN, currentOffset_, ILLEGAL, ILLEGAL, msg });
 }
 
 void CodeGenerator::emit(const std::string& instruction) {
     ss << "  " << instruction << "\n";
+    if (options_.keepListing) listing_.push_back({ instruction, currentOffset_, false, inStatement_ });
+    countMemoryTraffic(instruction);
+    trackStack(instruction);
+    raxHolds_ = nullptr; // Any instruction may change RAX; callers that know better set it again
+}
+
+void CodeGenerator::countMemoryTraffic(const std::string& instruction) {
+    if (!inStatement_) return; // Prologue and epilogue
+    StatementTraffic& t = traffic_.back();
+    size_t space = instruction.find(' ');
+    std::string mnemonic = instruction.substr(0, space);
+    if (mnemonic == "push" || mnemonic == "pop") {
+        (mnemonic == "push" ? t.stores : t.loads) += 1;
+        t.bytes += 8;
+        return;
+    }
+    size_t mem = instruction.find("ptr [");
+    if (mem == std::string::npos) return;
+    int size = instruction.find("byte ptr") != std::string::npos ? 1 : 8;
+    size_t comma = instruction.find(',');
+    (comma != std::string::npos && mem > comma ? t.loads : t.stores) += 1; // Memory destination is a store
+    t.bytes += size;
+}
+
+// Follows RSP through the straight-line function body. Only the epilogue
+// moves RSP back to RBP, and -Os helpers after it only tail-jump.
+void CodeGenerator::trackStack(const std::string& instruction) {
+    size_t space = instruction.find(' ');
+    std::string mnemonic = instruction.substr(0, space);
+    std::string operands = space == std::string::npos ? "" : instruction.substr(space + 1);
+    if (mnemonic == "push") {
+        stackDepth_ += 8;
+    }
+    else if (mnemonic == "pop") {
+        stackDepth_ -= 8;
+    }
+    else if (mnemonic == "leave") {
+        stackDepth_ = 0;
+    }
+    else if (instruction == "mov rsp, rbp") {
+        stackDepth_ = 8; // Saved RBP
+    }
+    else if ((mnemonic == "sub" || mnemonic == "add") && operands.rfind("rsp,", 0) == 0) {
+        std::string amount = operands.substr(4);
+        char* end = nullptr;
+        long long bytes = std::strtoll(amount.c_str(), &end, 0);
+        if (end == amount.c_str() || *end != '\0') {
+            if (stack_.unbounded.empty()) stack_.unbounded = "'" + instruction + "' moves rsp by an amount not known at compile time";
+            return;
+        }
+        stackDepth_ += static_cast<int>(mnemonic == "sub" ? bytes : -bytes);
+    }
+    else if (operands.rfind("rsp,", 0) == 0 || operands.rfind("esp,", 0) == 0) {
+        if (stack_.unbounded.empty()) stack_.unbounded = "'" + instruction + "' writes rsp";
+    }
+    else if (mnemonic == "call") {
+        std::string symbol = operands;
+        if (symbol.rfind(".L", 0) == 0) symbol.erase(0, 2);                                  // -Os helper tail-calls it
+        else if (targetPlatform_ == PLATFORM_MACOS && symbol.rfind('_', 0) == 0) symbol.erase(0, 1);
+        int depth = 8 + stackDepth_ + 8; // Return addresses of this function and of the call
+        auto it = std::find_if(stack_.calls.begin(), stack_.calls.end(), [&](const StackCall& c) { return c.symbol == symbol; });
+        if (it == stack_.calls.end()) stack_.calls.push_back({ symbol, depth });
+        else it->depth = std::max(it->depth, depth);
+    }
+    stack_.frameBytes = std::max(stack_.frameBytes, 8 + stackDepth_);
 }
 
 void CodeGenerator::emitComment(const std::string& comment) {
@@ -73,30 +140,122 @@ void CodeGenerator::emitComment(const std::string& comment) {
     // Add else if for other assemblers if you support them.
 }
 
+void CodeGenerator::emitLabel(const std::string& label) {
+    ss << label << ":\n";
+    if (options_.keepListing) listing_.push_back({ label, currentOffset_, true, inStatement_ });
+    raxHolds_ = nullptr; // Join point: RAX depends on the path taken
+}
+
+// For generating unique labels in assembly. Per-generator, so concurrent compiles never share state.
+std::string CodeGenerator::generateUniqueLabel(const std::string& prefix) {
+    return prefix + std::to_string(labelCounter_++);
+}
+
+void CodeGenerator::emitCall(const std::string& symbol) {
+    // Both ABIs require RSP to be 16-byte aligned at the call. RBP is aligned after the
+    // prologue's push, so only the locals and any temporaries pushed since then matter.
+    int padding = (frameBytes_ + pushDepth_) % 16;
+    // Windows x64 additionally needs 32 bytes of shadow space reserved for the callee.
+    if (targetPlatform_ == PLATFORM_WINDOWS_MINGW) {
+        padding += 32;
+    }
+    if (padding) emit("sub rsp, " + std::to_string(padding));
+    if (outlinedCalls_.count(symbol)) {
+        // The helper tail-calls the runtime, which therefore sees this call's alignment.
+        emit("call .L" + symbol);
+    }
+    else {
+        emit("call " + std::string(targetPlatform_ == PLATFORM_MACOS ? "_" : "") + symbol);
+    }
+    if (padding) emit("add rsp, " + std::to_string(padding));
+}
+
+void CodeGenerator::emitLoadImmediate(long long value) {
+    if (!options_.optimizeSize) {
+        emit("mov rax, " + std::to_string(value));
+    }
+    else if (value == 0) {
+        emit("xor eax, eax");                          // 2 bytes
+    }
+    else if (value >= -128 && value <= 127) {
+        emit("push " + std::to_string(value));         // 2 bytes, sign-extended to 64 bits
+        emit("pop rax");                               // 1 byte
+    }
+    else if (value > 0 && value <= 0xFFFFFFFFll) {
+        emit("mov eax, " + std::to_string(value));     // 5 bytes, zero-extends
+    }
+    else {
+        emit("mov rax, " + std::to_string(value));
+    }
+}
+
+void CodeGenerator::emitTestRax() {
+    emit(options_.optimizeSize ? "test rax, rax" : "cmp rax, 0");
+}
+
+// -Os: reserve every local with one `sub rsp` in the prologue instead of one per
+// variable, rounded to 16 so calls from statement level need no padding, and
+// outline runtime calls that appear often enough to pay for a shared helper.
+void CodeGenerator::planSizeOptimizedFrame(const Program* program) {
+    std::vector<bool> locals(program->slotCount);
+    std::map<std::string, int> calls;
+    for (const auto& stmt : program->statements) {
+        if (auto assign = dynamic_cast<const AssignmentStatement*>(stmt.get())) {
+            locals[assign->identifier->slot] = true;
+        }
+        else if (auto print = dynamic_cast<const PrintStatement*>(stmt.get())) {
+            ++calls[print->expression->resolvedType == BOOL ? "print_bool" : "print_int"];
+        }
+        else if (auto block = dynamic_cast<const AsmStatement*>(stmt.get())) {
+            for (const auto& output : block->outputs) {
+                locals[static_cast<const IdentifierExpr*>(output.expression.get())->slot] = true;
+            }
+        }
+    }
+    size_t count = std::count(locals.begin(), locals.end(), true);
+    frameBytes_ = static_cast<int>((count * 8 + 15) / 16 * 16);
+
+    // An inline call site costs `mov rdi, rax` + `call` (8 bytes); an outlined one a
+    // 5-byte call, plus 8 bytes once for the helper. Three sites break even.
+    for (const auto& [symbol, count] : calls) {
+        if (count >= 3) outlinedCalls_.insert(symbol);
+    }
+}
+
+void CodeGenerator::emitOutlinedHelpers() {
+    for (const auto& symbol : outlinedCalls_) {
+        emitLabel(".L" + symbol);
+        emit("mov " + getArgRegister(0) + ", rax");
+        emit("jmp " + std::string(targetPlatform_ == PLATFORM_MACOS ? "_" : "") + symbol);
+    }
+}
+
+// match jump tables follow the code in .text: entries are 32-bit offsets from the
+// table, so dispatch needs no relocations and the function stays position-independent.
+void CodeGenerator::emitJumpTables() {
+    for (const auto& [table, targets] : jumpTables_) {
+        emitLabel(table);
+        for (const auto& target : targets) {
+            ss << "  .long " << target << " - " << table << "\n";
+        }
+    }
+}
+
 // --- Platform-Specific Assembly Boilerplate ---
 void CodeGenerator::emitMainPrologue() {
-    if (targetPlatform_ == PLATFORM_LINUX || targetPlatform_ == PLATFORM_MACOS) {
+    if (targetPlatform_ == PLATFORM_LINUX || targetPlatform_ == PLATFORM_MACOS || targetPlatform_ == PLATFORM_WINDOWS_MINGW) {
+        const std::string& entry = options_.entryName;
         ss << ".intel_syntax noprefix\n"; // Using Intel syntax
-        ss << ".globl main\n";           // Standard entry point for Linux/macOS
+        ss << ".globl " << entry << "\n";  // "main" unless the embedder asked for another entry point
         ss << ".text\n";
-        ss << "main:\n";
+        ss << entry << ":\n";
         emit("push rbp");               // Save base pointer
         emit("mov rbp, rsp");           // Set new base pointer
-        // Note: Linux x64 ABI requires RSP to be 16-byte aligned BEFORE a call.
-        // `call` pushes 8 bytes, so if RSP is currently 16-byte aligned,
-        // after push it becomes 8-byte aligned. The function called must handle alignment.
-        // For simplicity, we rely on C library functions often handling this or adjust later if needed.
-        // Local variables will be allocated via `sub rsp`.
-    }
-    else if (targetPlatform_ == PLATFORM_WINDOWS_MINGW) {
-        ss << ".intel_syntax noprefix\n"; // Using Intel syntax
-        ss << ".globl main\n";           // MinGW usually uses `main`
-        ss << ".text\n";
-        ss << "main:\n";
-        emit("push rbp");               // Save base pointer
-        emit("mov rbp, rsp");           // Set new base pointer
-        // Windows x64 calling convention: reserve 32 bytes of "shadow space" for caller-saved regs
-        emit("sub rsp, 32");
+        if (options_.optimizeSize && frameBytes_) {
+            emit("sub rsp, " + std::to_string(frameBytes_)); // Whole frame at once (see planSizeOptimizedFrame)
+        }
+        // Local variables will be allocated via `sub rsp`; emitCall() keeps calls aligned
+        // and reserves the Windows shadow space per call, below the locals.
     }
     else {
         error("Codegen Init: Cannot emit prologue for unknown platform.");
@@ -104,30 +263,25 @@ void CodeGenerator::emitMainPrologue() {
 }
 
 void CodeGenerator::emitMainEpilogue() {
-    if (targetPlatform_ == PLATFORM_LINUX || targetPlatform_ == PLATFORM_MACOS) {
+    if (targetPlatform_ == PLATFORM_LINUX || targetPlatform_ == PLATFORM_MACOS || targetPlatform_ == PLATFORM_WINDOWS_MINGW) {
         emitComment("Main Epilogue");
-        // Deallocate local variables by restoring RSP to RBP's original value
-        // We allocated space using `sub rsp`, so we add it back.
-        // `stackOffsetCounter_` is negative, so we add its absolute value.
-        if (stackOffsetCounter_ < 0) {
-            emit("add rsp, " + std::to_string(-stackOffsetCounter_));
+        if (options_.optimizeSize) {
+            emit("leave");              // mov rsp, rbp; pop rbp in one byte
+            emit("xor eax, eax");
+            emit("ret");
+            emitOutlinedHelpers();
         }
-        emit("mov rsp, rbp");           // Restore stack pointer to RBP's value
-        emit("pop rbp");                // Restore base pointer
-        emit("mov eax, 0");             // Standard return code 0 for success in EAX/RAX
-        emit("ret");
-    }
-    else if (targetPlatform_ == PLATFORM_WINDOWS_MINGW) {
-        emitComment("Main Epilogue");
-        // Deallocate local variables
-        if (stackOffsetCounter_ < 0) {
-            emit("add rsp, " + std::to_string(-stackOffsetCounter_));
+        else {
+            // Deallocate local variables by restoring RSP to RBP's original value
+            emit("mov rsp, rbp");       // Restore stack pointer to RBP's value
+            emit("pop rbp");            // Restore base pointer
+            emit("mov eax, 0");         // Standard return code 0 for success in EAX/RAX
+            emit("ret");
+        }
+        emitJumpTables();
+        if (targetPlatform_ == PLATFORM_LINUX) {
+            ss << ".section .note.GNU-stack,\"\",@progbits\n"; // No executable stack
         }
-        emit("add rsp, 32");            // Clean up shadow space
-        emit("mov rsp, rbp");           // Restore stack pointer to RBP's value
-        emit("pop rbp");                // Restore base pointer
-        emit("mov eax, 0");             // Return 0 (success)
-        emit("ret");
     }
     else {
         error("Codegen Finalize: Cannot emit epilogue for unknown platform.");
@@ -139,27 +293,19 @@ void CodeGenerator::emitPrintInteger(const std::string& valueReg) {
     // print_int typically expects the integer value in the first argument register.
     // For Linux/macOS, this is RDI. For Windows, it's RCX.
     std::string argReg = getArgRegister(0);
-    emit("mov " + argReg + ", " + getRegisterPart(INT, valueReg)); // Move value to appropriate part of arg register
-
-    // Call the helper function
-    if (targetPlatform_ == PLATFORM_MACOS) { // macOS often prepends '_' to C function names
-        emit("call _print_int");
-    }
-    else {
-        emit("call print_int");
+    if (!outlinedCalls_.count("print_int")) {
+        emit("mov " + argReg + ", " + getRegisterPart(INT, valueReg)); // Move value to appropriate part of arg register
     }
+
+    // Call the helper function (emitCall adds macOS's '_' prefix)
+    emitCall("print_int");
 }
 
 std::string CodeGenerator::getRegisterPart(TokenType type, const std::string& baseReg) const {
     if (baseReg.empty()) return ""; // Should not happen
 
     if (type == BOOL) {
-        if (baseReg.length() > 1 && baseReg[0] == 'r') {
-            return baseReg[0] + std::string("l") + baseReg.substr(1); // e.g., "rax" -> "al"
-        }
-        // Handle cases where baseReg might already be a smaller register (less likely with our setup)
-        if (baseReg.length() == 1) return baseReg; // e.g. "a" -> "a" (assuming it's AL)
-        return ""; // Fallback
+        return getRegName(BOOL, baseReg); // e.g., "rax" -> "al"
     }
 
     // For INT, we use the full register (e.g., RAX)
@@ -168,28 +314,28 @@ std::string CodeGenerator::getRegisterPart(TokenType type, const std::string& ba
 
 void CodeGenerator::emitPrintBoolean(const std::string& valueReg) {
     emitComment("Call print_bool");
-    // print_bool expects a boolean (0 or 1), usually passed as a byte.
-    // We need to get the specific byte register (e.g., 'al' from 'rax').
+    // print_bool expects a boolean (0 or 1) passed as a byte. Booleans are kept
+    // zero-extended in the full register, so moving all 64 bits is enough.
     std::string argReg = getArgRegister(0);
-    emit("mov " + argReg + ", " + getRegisterPart(BOOL, valueReg)); // Move the byte value to arg register
-
-    if (targetPlatform_ == PLATFORM_MACOS) {
-        emit("call _print_bool");
-    }
-    else {
-        emit("call print_bool");
+    if (!outlinedCalls_.count("print_bool")) {
+        emit("mov " + argReg + ", " + valueReg);
     }
+    emitCall("print_bool");
 }
 
 // --- AST Node Dispatchers & Specific Code Generation Functions ---
 
 void CodeGenerator::visitProgram(const Program* node) {
     for (const auto& stmt : node->statements) {
+        traffic_.push_back({ stmt->offset });
+        inStatement_ = true;
         visitStatement(stmt.get()); // Use .get() to get raw pointer from unique_ptr
+        inStatement_ = false;
     }
 }
 
 void CodeGenerator::visitStatement(const Statement* node) {
+    currentOffset_ = node->offset;
     if (const AssignmentStatement* assign = dynamic_cast<const AssignmentStatement*>(node)) {
         visitAssignmentStatement(assign);
     }
@@ -199,6 +345,9 @@ void CodeGenerator::visitStatement(const Statement* node) {
     else if (const PrintStatement* print = dynamic_cast<const PrintStatement*>(node)) {
         visitPrintStatement(print);
     }
+    else if (const AsmStatement* block = dynamic_cast<const AsmStatement*>(node)) {
+        visitAsmStatement(block);
+    }
     else {
         error("Unhandled statement type in codegen dispatcher.");
     }
@@ -213,12 +362,12 @@ void CodeGenerator::visitAssignmentStatement(const AssignmentStatement* node) {
     TokenType valueType = node->value->resolvedType;
 
     // 2. Ensure variable is defined in our codegen symbol table and on the stack.
-    CodegenSymbol* symbol = getSymbol(node->identifier->name);
+    CodegenSymbol* symbol = getSymbol(node->identifier.get());
     if (!symbol) {
         // This is the first time we're seeing this variable in codegen.
         // Define it on the stack. Semantic analysis should have guaranteed it's valid.
-        defineVariable(node->identifier->name, valueType); // This also updates stackOffsetCounter_
-        symbol = getSymbol(node->identifier->name);       // Get the newly defined symbol
+        defineVariable(node->identifier.get(), valueType); // This also updates stackOffsetCounter_
+        symbol = getSymbol(node->identifier.get());       // Get the newly defined symbol
     }
     else {
         // If it's already defined, ensure its type matches (though sema should check this).
@@ -235,6 +384,9 @@ void CodeGenerator::visitAssignmentStatement(const AssignmentStatement* node) {
     // 3. Store the value from RAX/AL into the variable's stack location.
     // Use appropriate register part and memory size.
     emit("mov " + getRegSize(valueType) + " ptr [rbp" + std::to_string(symbol->stackOffset) + "], " + getRegisterPart(valueType, "rax"));
+    if (options_.forwardLoads) {
+        raxHolds_ = node->identifier.get(); // The store leaves the value in RAX
+    }
 }
 
 void CodeGenerator::visitExpressionStatement(const ExpressionStatement* node) {
@@ -259,10 +411,179 @@ void CodeGenerator::visitPrintStatement(const PrintStatement* node) {
         emitPrintBoolean("rax"); // Pass the boolean value (in AL, zero-extended to RAX)
     }
     else {
-        error("Attempting to print an unsupported type (TokenType: " + tokenTypeStrings.at(exprType) + ").");
+        error("Attempting to print an unsupported type (TokenType: " + std::string(tokenTypeName(exprType)) + ").");
     }
 }
 
+// asm_ blocks. Every operand gets its own register, chosen from the
+// caller-saved ones the block does not clobber, so nothing around the block is
+// spilled: variables already live in their stack slots, and RAX (allocated
+// last) keeps the value it held whenever the block leaves it alone. Clobbered
+// callee-saved registers are saved around the block.
+void CodeGenerator::visitAsmStatement(const AsmStatement* node) {
+    emitComment(node->isVolatile ? "asm_ @volatile" : "asm_");
+    std::set<std::string> clobbered;
+    bool clobbersMemory = false;
+    for (const auto& clobber : node->clobbers) {
+        if (clobber == "memory") clobbersMemory = true;
+        else if (clobber != "cc") clobbered.insert(canonicalRegister(clobber));
+    }
+
+    struct Operand {
+        const AsmOperand* source;
+        AsmConstraint constraint;
+        bool output;
+        std::string text = {}; // Register name, memory reference or immediate
+    };
+    std::vector<Operand> operands;
+    for (const auto& output : node->outputs) {
+        operands.push_back({ &output, parseAsmConstraint(output.constraint, true), true });
+        auto variable = static_cast<const IdentifierExpr*>(output.expression.get());
+        if (!getSymbol(variable)) defineVariable(variable, INT);
+    }
+    for (const auto& input : node->inputs) {
+        operands.push_back({ &input, parseAsmConstraint(input.constraint, false), false });
+    }
+    auto variableOf = [](const Operand& op) { return dynamic_cast<const IdentifierExpr*>(op.source->expression.get()); };
+    auto isComputed = [&](const Operand& op) {
+        const Expression* e = op.source->expression.get();
+        return !op.output && op.constraint.kind == 'r' && !dynamic_cast<const IdentifierExpr*>(e) &&
+               !dynamic_cast<const IntegerLiteral*>(e) && !dynamic_cast<const BooleanLiteral*>(e);
+    };
+
+    // --- Register allocation ---
+    std::set<std::string> taken = clobbered;
+    bool anyComputed = false;
+    for (auto& op : operands) {
+        if (!op.constraint.fixedRegister.empty()) taken.insert(op.text = op.constraint.fixedRegister);
+        anyComputed = anyComputed || isComputed(op);
+    }
+    const IdentifierExpr* held = raxHolds_;
+    if (held && !anyComputed && !taken.count("rax")) {
+        for (auto& op : operands) {
+            auto variable = variableOf(op);
+            if (!op.output && op.constraint.kind == 'r' && op.text.empty() && variable && variable->slot == held->slot) {
+                taken.insert(op.text = "rax");
+                remarks_.push_back({ variable->offset, "forward", "passed " + held->name + " to asm_ in rax without reloading it" });
+                break;
+            }
+        }
+    }
+    static const char* const kAllocationOrder[] = { "rcx", "rdx", "rsi", "rdi", "r8", "r9", "r10", "r11", "rax" };
+    for (auto& op : operands) {
+        if (!op.text.empty()) continue;
+        if (op.constraint.kind == 'm') {
+            CodegenSymbol* symbol = getSymbol(variableOf(op));
+            op.text = getRegSize(symbol->type) + " ptr [rbp" + std::to_string(symbol->stackOffset) + "]";
+        }
+        else if (op.constraint.kind == 'i') {
+            op.text = std::to_string(static_cast<const IntegerLiteral*>(op.source->expression.get())->value);
+        }
+        else {
+            for (const char* reg : kAllocationOrder) {
+                if (!taken.count(reg)) {
+                    taken.insert(op.text = reg);
+                    break;
+                }
+            }
+            if (op.text.empty()) {
+                error("asm_ block needs more registers than its clobbers leave free.");
+                return;
+            }
+        }
+    }
+
+    std::vector<std::string> saved;
+    for (const auto& reg : taken) {
+        if (isCalleeSaved(reg)) {
+            saved.push_back(reg);
+            emit("push " + reg);
+            pushDepth_ += 8;
+        }
+    }
+
+    // --- Inputs: computed values through RAX first, then direct loads ---
+    std::vector<const Operand*> computed;
+    for (const auto& op : operands) {
+        if (isComputed(op)) computed.push_back(&op);
+    }
+    for (size_t k = 0; k < computed.size(); ++k) {
+        visitExpression(computed[k]->source->expression.get());
+        if (k + 1 < computed.size()) {
+            emit("push rax");
+            pushDepth_ += 8;
+        }
+        else if (computed[k]->text != "rax") {
+            emit("mov " + computed[k]->text + ", rax");
+        }
+    }
+    for (size_t k = computed.size(); k-- > 1;) {
+        emit("pop " + computed[k - 1]->text);
+        pushDepth_ -= 8;
+    }
+    for (const auto& op : operands) {
+        bool loads = op.output ? op.constraint.readWrite : true;
+        if (!loads || op.constraint.kind != 'r' || isComputed(op)) continue;
+        const Expression* e = op.source->expression.get();
+        if (auto variable = variableOf(op)) {
+            if (op.text == "rax" && held && variable->slot == held->slot) continue; // Forwarded
+            CodegenSymbol* symbol = getSymbol(variable);
+            std::string slot = getRegSize(symbol->type) + " ptr [rbp" + std::to_string(symbol->stackOffset) + "]";
+            emit((symbol->type == BOOL ? "movzx " : "mov ") + op.text + ", " + slot);
+        }
+        else if (auto intLit = dynamic_cast<const IntegerLiteral*>(e)) {
+            emit("mov " + op.text + ", " + std::to_string(intLit->value));
+        }
+        else if (auto boolLit = dynamic_cast<const BooleanLiteral*>(e)) {
+            emit("mov " + op.text + ", " + (boolLit->value ? "1" : "0"));
+        }
+    }
+
+    // --- Template ---
+    std::vector<std::string> texts;
+    for (const auto& op : operands) texts.push_back(op.text);
+    for (const auto& line : node->lines) {
+        std::string text, bad;
+        if (!substituteAsmOperands(line, texts, text, bad)) {
+            error("asm_ template refers to '" + bad + "', which is not an operand.");
+            return;
+        }
+        if (text.find_first_not_of(" \t") != std::string::npos) emit(text);
+    }
+
+    // --- Outputs ---
+    const IdentifierExpr* raxOutput = nullptr;
+    std::set<uint32_t> written;
+    for (const auto& op : operands) {
+        if (!op.output) continue;
+        written.insert(variableOf(op)->slot);
+        if (op.constraint.kind == 'm') continue; // Written in place
+        CodegenSymbol* symbol = getSymbol(variableOf(op));
+        emit("mov qword ptr [rbp" + std::to_string(symbol->stackOffset) + "], " + op.text);
+        if (op.text == "rax") raxOutput = variableOf(op);
+    }
+    for (size_t k = saved.size(); k-- > 0;) {
+        emit("pop " + saved[k]);
+        pushDepth_ -= 8;
+    }
+
+    // Input registers are unchanged by the block, as in GCC, so RAX still holds
+    // the variable passed in it, or the one it held before if the block never used it.
+    if (!options_.forwardLoads) return;
+    const IdentifierExpr* raxValue = raxOutput;
+    if (!raxValue && !clobbered.count("rax") && !clobbersMemory) {
+        for (const auto& op : operands) {
+            if (!op.output && op.text == "rax" && variableOf(op)) raxValue = variableOf(op);
+        }
+        if (!taken.count("rax") && computed.empty()) raxValue = held;
+        if (raxValue && written.count(raxValue->slot)) raxValue = nullptr;
+        if (raxValue) {
+            remarks_.push_back({ node->offset, "forward", "rax still holds " + raxValue->name + " after the asm_ block" });
+        }
+    }
+    raxHolds_ = raxValue;
+}
+
 void CodeGenerator::visitExpression(const Expression* node) {
     if (const IntegerLiteral* int_lit = dynamic_cast<const IntegerLiteral*>(node)) {
         visitIntegerLiteral(int_lit);
@@ -276,6 +597,15 @@ void CodeGenerator::visitExpression(const Expression* node) {
     else if (const BinaryExpression* bin_expr = dynamic_cast<const BinaryExpression*>(node)) {
         visitBinaryExpression(bin_expr);
     }
+    else if (const UnaryExpression* unary = dynamic_cast<const UnaryExpression*>(node)) {
+        visitUnaryExpression(unary);
+    }
+    else if (const ConditionalExpression* cond = dynamic_cast<const ConditionalExpression*>(node)) {
+        visitConditionalExpression(cond);
+    }
+    else if (const MatchExpression* match = dynamic_cast<const MatchExpression*>(node)) {
+        visitMatchExpression(match);
+    }
     else {
         error("Unhandled expression type in codegen dispatcher.");
     }
@@ -283,11 +613,15 @@ void CodeGenerator::visitExpression(const Expression* node) {
 
 void CodeGenerator::visitIntegerLiteral(const IntegerLiteral* node) {
     emitComment("Integer Literal: " + std::to_string(node->value));
-    emit("mov rax, " + std::to_string(node->value)); // Load integer into RAX
+    emitLoadImmediate(node->value); // Load integer into RAX
 }
     
 void CodeGenerator::visitBooleanLiteral(const BooleanLiteral* node) {
-    emitComment("Boolean Literal: " + node->value ? "true" : "false");
+    emitComment(std::string("Boolean Literal: ") + (node->value ? "true" : "false"));
+    if (options_.optimizeSize) {
+        emitLoadImmediate(node->value ? 1 : 0);
+        return;
+    }
     // Load 1 for true, 0 for false into AL, then zero-extend to RAX for consistency.
     emit("mov al, " + std::to_string(node->value ? 1 : 0));
     emit("movzx rax, al"); // Zero-extend AL to RAX
@@ -295,90 +629,491 @@ void CodeGenerator::visitBooleanLiteral(const BooleanLiteral* node) {
 
 void CodeGenerator::visitIdentifierExpr(const IdentifierExpr* node) {
     emitComment("Identifier: " + node->name);
-    CodegenSymbol* symbol = getSymbol(node->name);
+    CodegenSymbol* symbol = getSymbol(node);
     if (!symbol) {
         // This indicates a serious semantic analysis failure if not caught earlier.
         error("Codegen Error: Undefined variable used '" + node->name + "'.");
         return;
     }
 
-    // Load the value from the variable's stack location into RAX/AL based on its type.
-    emit("mov " + getRegSize(symbol->type) + " ptr [rbp" + std::to_string(symbol->stackOffset) + "], " + getRegisterPart(symbol->type, "rax"));
+    if (options_.forwardLoads && raxHolds(node)) {
+        remarks_.push_back({ node->offset, "forward", "reused " + node->name + " from rax" });
+        return;
+    }
+
+    // Load the value from the variable's stack location into RAX, zero-extending booleans.
+    std::string slot = getRegSize(symbol->type) + " ptr [rbp" + std::to_string(symbol->stackOffset) + "]";
+    if (symbol->type == BOOL) {
+        emit(std::string(options_.optimizeSize ? "movzx eax, " : "movzx rax, ") + slot); // 32-bit form drops REX.W
+    }
+    else {
+        emit("mov rax, " + slot);
+    }
+    if (options_.forwardLoads) {
+        raxHolds_ = node;
+    }
 }
 
 void CodeGenerator::visitBinaryExpression(const BinaryExpression* node) {
-    emitComment("Binary Expression: " + tokenTypeStrings.at(node->op));
+    if (node->op == AND || node->op == OR) {
+        visitLogicalExpression(node);
+        return;
+    }
+
+    emitComment("Binary Expression: " + std::string(tokenTypeName(node->op)));
+    if (options_.strengthReduce && emitImmediateOperation(node)) {
+        return;
+    }
 
-    // Evaluate right operand first, its result will be in RAX (or AL zero-extended)
-    visitExpression(node->right.get());
     TokenType rightType = node->right->resolvedType;
+    auto rightVariable = dynamic_cast<const IdentifierExpr*>(node->right.get());
+    CodegenSymbol* rightSymbol = rightVariable ? getSymbol(rightVariable) : nullptr;
+    if (options_.forwardLoads && rightSymbol) {
+        // A variable operand is read straight into RCX after the left side: no temporary on the stack.
+        visitExpression(node->left.get());
+        std::string slot = getRegSize(rightSymbol->type) + " ptr [rbp" + std::to_string(rightSymbol->stackOffset) + "]";
+        emit((rightSymbol->type == BOOL ? "movzx rcx, " : "mov rcx, ") + slot);
+        remarks_.push_back({ rightVariable->offset, "forward", "loaded " + rightVariable->name + " into rcx without a stack temporary" });
+    }
+    else {
+        // Evaluate right operand first, its result will be in RAX (or AL zero-extended)
+        visitExpression(node->right.get());
 
-    // Push the right operand's value onto the stack to preserve it
-    emit("push rax");
-    stackOffsetCounter_ += 8; // Account for the push on the stack
+        // Push the right operand's value onto the stack to preserve it
+        emit("push rax");
+        pushDepth_ += 8; // Account for the push on the stack
 
-    // Evaluate left operand, its result will be in RAX (or AL zero-extended)
-    visitExpression(node->left.get());
-    TokenType leftType = node->left->resolvedType;
+        // Evaluate left operand, its result will be in RAX (or AL zero-extended)
+        visitExpression(node->left.get());
 
-    // Pop the right operand into RBX (or BL for boolean operations)
-    emit("pop rbx");
-    stackOffsetCounter_ -= 8; // Account for the pop
+        // Pop the right operand into RCX (or CL for boolean operations). RCX is caller-saved
+        // in both ABIs, so the generated function never has to preserve it.
+        emit("pop rcx");
+        pushDepth_ -= 8; // Account for the pop
+    }
+    TokenType leftType = node->left->resolvedType;
 
     // Determine the correct register parts for operation based on type
     std::string leftReg = getRegisterPart(leftType, "rax");
-    std::string rightReg = getRegisterPart(rightType, "rbx");
+    std::string rightReg = getRegisterPart(rightType, "rcx");
     TokenType resultType = node->resolvedType; // This is the type of the expression's result
 
     // Perform the operation. The result is expected to be in RAX (or AL zero-extended).
     switch (node->op) {
     case PLUS:
-        emit("add " + getRegisterPart(INT, "rax") + ", " + getRegisterPart(INT, "rbx"));
+        emit("add " + getRegisterPart(INT, "rax") + ", " + getRegisterPart(INT, "rcx"));
         break;
     case MINUS:
-        emit("sub " + getRegisterPart(INT, "rax") + ", " + getRegisterPart(INT, "rbx"));
+        emit("sub " + getRegisterPart(INT, "rax") + ", " + getRegisterPart(INT, "rcx"));
         break;
     case ASTERISK:
         // For signed multiplication, IMUL is used.
-        // `imul rbx` will multiply RAX by RBX, result in RAX.
-        emit("imul " + getRegisterPart(INT, "rbx"));
+        // `imul rcx` will multiply RAX by RCX, result in RAX.
+        emit("imul " + getRegisterPart(INT, "rcx"));
         break;
     case SLASH:
-        // For signed division: CQO extends RAX into RDX:RAX.
-        // Then RDX:RAX is divided by the operand (RBX).
-        // Quotient goes to RAX, remainder to RDX.
-        emit("cqo"); // Sign-extend RAX into RDX:RAX
-        emit("idiv " + getRegisterPart(INT, "rbx")); // Divide RDX:RAX by RBX
+    case PERCENT:
+        emitDivide(node);
+        break;
+    case EQ: case NOT_EQ: case LT: case GT: case LT_EQ: case GT_EQ: {
+        // Booleans are kept zero-extended in RAX, so one 64-bit compare covers every operand type.
+        static const std::map<TokenType, std::string> setcc = {
+            {EQ, "sete"}, {NOT_EQ, "setne"}, {LT, "setl"}, {GT, "setg"}, {LT_EQ, "setle"}, {GT_EQ, "setge"}
+        };
+        emit("cmp rax, rcx");
+        emit(setcc.at(node->op) + " al");
+        emit(options_.optimizeSize ? "movzx eax, al" : "movzx rax, al");
         break;
+    }
     default:
-        error("Unhandled binary operator in code generation: " + tokenTypeStrings.at(node->op));
+        error("Unhandled binary operator in code generation: " + std::string(tokenTypeName(node->op)));
         break;
     }
     // The result of the operation is now in RAX (or AL zero-extended to RAX if applicable).
 }
 
+// With one operand a constant there is nothing to push: the other operand is
+// evaluated into RAX and the constant becomes an immediate. Multiplication,
+// division and remainder by a power of two become shifts; signed division
+// rounds toward zero, so negative dividends are biased by 2^k - 1 first.
+bool CodeGenerator::emitImmediateOperation(const BinaryExpression* node) {
+    static const std::map<TokenType, std::string> setcc = {
+        {EQ, "sete"}, {NOT_EQ, "setne"}, {LT, "setl"}, {GT, "setg"}, {LT_EQ, "setle"}, {GT_EQ, "setge"}
+    };
+    const Expression* operand = node->left.get();
+    auto constant = dynamic_cast<const IntegerLiteral*>(node->right.get());
+    bool commutative = node->op == PLUS || node->op == ASTERISK || node->op == EQ || node->op == NOT_EQ;
+    if (!constant && commutative) {
+        constant = dynamic_cast<const IntegerLiteral*>(node->left.get());
+        operand = node->right.get();
+    }
+    if (!constant) return false;
+
+    long long value = constant->value;
+    int shift = -1; // log2(value) when value is a power of two greater than 1
+    if (value > 1 && (value & (value - 1)) == 0) {
+        shift = 0;
+        while ((1ll << shift) != value) ++shift;
+    }
+    std::string imm = std::to_string(value);
+    std::string reduced;
+
+    switch (node->op) {
+    case PLUS:
+        visitExpression(operand);
+        emit("add rax, " + imm);
+        break;
+    case MINUS:
+        visitExpression(operand);
+        emit("sub rax, " + imm);
+        break;
+    case ASTERISK:
+        visitExpression(operand);
+        if (shift >= 0) {
+            emit("shl rax, " + std::to_string(shift));
+            reduced = "* " + imm + " -> shl " + std::to_string(shift);
+        }
+        else {
+            emit("imul rax, rax, " + imm);
+        }
+        break;
+    case SLASH:
+    case PERCENT:
+        visitExpression(operand);
+        if (shift >= 0 && provenNonNegative(operand)) {
+            // No rounding bias when the dividend cannot be negative.
+            if (node->op == SLASH) {
+                emit("shr rax, " + std::to_string(shift));
+                reduced = "/ " + imm + " -> shr " + std::to_string(shift);
+            }
+            else {
+                emit("and rax, " + std::to_string(value - 1));
+                reduced = "% " + imm + " -> and " + std::to_string(value - 1);
+            }
+            remarks_.push_back({ node->offset, "range", expressionText(operand) + " is non-negative: no rounding bias for " + (node->op == SLASH ? "/ " : "% ") + imm });
+        }
+        else if (shift >= 0) {
+            emit("mov rcx, rax");
+            emit("sar rcx, 63");
+            emit("shr rcx, " + std::to_string(64 - shift)); // 2^k - 1 if negative, else 0
+            if (node->op == SLASH) {
+                emit("add rax, rcx");
+                emit("sar rax, " + std::to_string(shift));
+                reduced = "/ " + imm + " -> sar " + std::to_string(shift);
+            }
+            else {
+                emit("add rcx, rax");
+                emit("and rcx, " + std::to_string(-value));
+                emit("sub rax, rcx");
+                reduced = "% " + imm + " -> and " + std::to_string(-value);
+            }
+        }
+        else {
+            emit("mov rcx, " + imm);
+            emitDivide(node);
+        }
+        break;
+    case EQ: case NOT_EQ: case LT: case GT: case LT_EQ: case GT_EQ:
+        visitExpression(operand);
+        emit("cmp rax, " + imm);
+        emit(setcc.at(node->op) + " al");
+        emit(options_.optimizeSize ? "movzx eax, al" : "movzx rax, al");
+        break;
+    default:
+        return false;
+    }
+    if (!reduced.empty()) {
+        remarks_.push_back({ node->offset, "strength", reduced });
+    }
+    return true;
+}
+
+bool CodeGenerator::provenNonNegative(const Expression* node) const {
+    return options_.useRanges && ranges_.rangeOf(node).nonNegative();
+}
+
+// Signed division is CQO + IDIV. When value ranges prove the dividend
+// non-negative and the divisor positive, unsigned DIV gives the same result
+// without the sign extension, and operands that fit in 32 bits use the
+// 32-bit form, which is several times faster than the 64-bit one on most
+// cores. A divisor that may be zero keeps IDIV so the fault is unchanged.
+void CodeGenerator::emitDivide(const BinaryExpression* node) {
+    Interval dividend = options_.useRanges ? ranges_.rangeOf(node->left.get()) : Interval::full();
+    Interval divisor = options_.useRanges ? ranges_.rangeOf(node->right.get()) : Interval::full();
+    if (!dividend.nonNegative() || divisor.lo <= 0) {
+        emit("cqo");      // Sign-extend RAX into RDX:RAX
+        emit("idiv rcx"); // Quotient in RAX, remainder in RDX
+        if (node->op == PERCENT) emit("mov rax, rdx");
+        return;
+    }
+    bool narrow = dividend.hi <= UINT32_MAX && divisor.hi <= UINT32_MAX;
+    emit("xor edx, edx");
+    emit(narrow ? "div ecx" : "div rcx"); // 32-bit results zero-extend into RAX
+    if (node->op == PERCENT) emit(narrow ? "mov eax, edx" : "mov rax, rdx");
+    remarks_.push_back({ node->offset, "range", expressionText(node->left.get()) + " in " + dividend.str() +
+        ", divisor in " + divisor.str() + ": " + (narrow ? "div ecx" : "div rcx") + " instead of idiv" });
+}
+
+void CodeGenerator::visitLogicalExpression(const BinaryExpression* node) {
+    emitComment("Logical Expression: " + std::string(tokenTypeName(node->op)));
+    std::string shortCircuit = generateUniqueLabel(".Lshort");
+    std::string end = generateUniqueLabel(".Lend");
+
+    // The right operand is only evaluated when the left one does not decide the result.
+    visitExpression(node->left.get());
+    emitTestRax();
+    emit(std::string(node->op == AND ? "je " : "jne ") + shortCircuit);
+    visitExpression(node->right.get());
+    emit("jmp " + end);
+    emitLabel(shortCircuit);
+    emitLoadImmediate(node->op == AND ? 0 : 1);
+    emitLabel(end);
+}
+
+void CodeGenerator::visitUnaryExpression(const UnaryExpression* node) {
+    emitComment("Unary Expression: " + std::string(tokenTypeName(node->op)));
+    visitExpression(node->operand.get());
+
+    switch (node->op) {
+    case MINUS:
+        emit("neg rax");
+        break;
+    case PLUS:
+        break;
+    case BANG:
+        emit(options_.optimizeSize ? "xor eax, 1" : "xor rax, 1"); // Booleans are 0/1 in RAX
+        break;
+    default:
+        error("Unhandled unary operator in code generation: " + std::string(tokenTypeName(node->op)));
+        break;
+    }
+}
+
+void CodeGenerator::visitConditionalExpression(const ConditionalExpression* node) {
+    emitComment("Conditional Expression");
+    std::string elseLabel = generateUniqueLabel(".Lelse");
+    std::string end = generateUniqueLabel(".Lend");
+
+    visitExpression(node->condition.get());
+    emitTestRax();
+    emit("je " + elseLabel);
+    visitExpression(node->thenExpr.get());
+    emit("jmp " + end);
+    emitLabel(elseLabel);
+    visitExpression(node->elseExpr.get());
+    emitLabel(end);
+}
+
+// The subject is computed into RAX and dispatched to the selected arm, which
+// leaves its value in RAX. The `_` arm is laid out first so that falling
+// through the dispatch reaches it; arms no value can reach are not generated.
+void CodeGenerator::visitMatchExpression(const MatchExpression* node) {
+    emitComment("Match Expression");
+    std::vector<MatchCase> cases = matchCases(*node);
+    size_t defaultArm = node->arms.size() - 1;
+
+    // With ranges on, cases outside what the subject can hold are dropped.
+    Interval subject = options_.useRanges ? ranges_.rangeOf(node->subject.get()) : Interval::full();
+    std::vector<MatchCase> reachable;
+    for (MatchCase c : cases) {
+        c.lo = std::max(c.lo, subject.lo);
+        c.hi = std::min(c.hi, subject.hi);
+        if (c.lo <= c.hi) reachable.push_back(c);
+    }
+    cases = std::move(reachable);
+
+    std::vector<std::string> armLabels;
+    std::vector<bool> reached(node->arms.size(), false);
+    for (size_t i = 0; i < node->arms.size(); ++i) {
+        armLabels.push_back(generateUniqueLabel(".Larm"));
+    }
+    for (const auto& c : cases) {
+        reached[c.arm] = true;
+    }
+    std::string end = generateUniqueLabel(".Lend");
+
+    MatchLowering lowering = chooseMatchLowering(cases);
+    std::string message = std::string(matchLoweringName(lowering)) + " over " + std::to_string(cases.size()) + " case(s)";
+    if (!cases.empty()) {
+        message += " in " + Interval{ cases.front().lo, cases.back().hi }.str();
+    }
+    remarks_.push_back({ node->offset, "match", message });
+
+    visitExpression(node->subject.get());
+    switch (lowering) {
+    case MATCH_JUMP_TABLE:
+        emitMatchJumpTable(cases, subject, armLabels, armLabels[defaultArm]);
+        break;
+    case MATCH_BIT_TEST:
+        emitMatchBitTest(cases, subject, armLabels, armLabels[defaultArm]);
+        break;
+    default:
+        emitMatchTree(cases, 0, cases.size(), armLabels, armLabels[defaultArm], true);
+        break;
+    }
+
+    std::vector<size_t> order = { defaultArm };
+    for (size_t i = 0; i < defaultArm; ++i) {
+        if (reached[i]) order.push_back(i);
+    }
+    for (size_t k = 0; k < order.size(); ++k) {
+        emitLabel(armLabels[order[k]]);
+        visitExpression(node->arms[order[k]].value.get());
+        if (k + 1 < order.size()) emit("jmp " + end);
+    }
+    emitLabel(end);
+}
+
+// Binary search on the cases' first values; up to three cases are tested in
+// order. The last piece laid out falls through to the `_` arm.
+void CodeGenerator::emitMatchTree(const std::vector<MatchCase>& cases, size_t begin, size_t end,
+                                  const std::vector<std::string>& armLabels, const std::string& defaultLabel, bool last) {
+    if (end - begin > 3) {
+        size_t mid = begin + (end - begin) / 2;
+        std::string below = generateUniqueLabel(".Lcase");
+        emit("cmp rax, " + std::to_string(cases[mid].lo));
+        emit("jl " + below);
+        emitMatchTree(cases, mid, end, armLabels, defaultLabel, false);
+        emitLabel(below);
+        emitMatchTree(cases, begin, mid, armLabels, defaultLabel, last);
+        return;
+    }
+
+    for (size_t i = begin; i < end; ++i) {
+        const MatchCase& c = cases[i];
+        const std::string& arm = armLabels[c.arm];
+        if (c.lo == c.hi) {
+            emit("cmp rax, " + std::to_string(c.lo));
+            emit("je " + arm);
+        }
+        else if (c.lo == 0) {
+            emit("cmp rax, " + std::to_string(c.hi));
+            emit("jbe " + arm);
+        }
+        else if (c.hi - c.lo <= INT32_MAX && c.lo != INT32_MIN) {
+            // lo <= RAX <= hi as one unsigned compare of RAX - lo
+            emit("lea rcx, [rax " + std::string(c.lo > 0 ? "- " : "+ ") + std::to_string(c.lo > 0 ? c.lo : -c.lo) + "]");
+            emit("cmp rcx, " + std::to_string(c.hi - c.lo));
+            emit("jbe " + arm);
+        }
+        else {
+            std::string next = generateUniqueLabel(".Lcase");
+            emit("cmp rax, " + std::to_string(c.lo));
+            emit("jl " + next);
+            emit("cmp rax, " + std::to_string(c.hi));
+            emit("jle " + arm);
+            emitLabel(next);
+        }
+    }
+    if (!last) emit("jmp " + defaultLabel);
+}
+
+// One 64-bit mask per arm, bit v set when value v selects it; `bt` tests the
+// subject's bit. Cases inside [0, 63] are tested without rebasing.
+void CodeGenerator::emitMatchBitTest(const std::vector<MatchCase>& cases, const Interval& subject,
+                                     const std::vector<std::string>& armLabels, const std::string& defaultLabel) {
+    int64_t min = cases.front().lo;
+    int64_t max = cases.back().hi;
+    int64_t base = min >= 0 && max < 64 ? 0 : min;
+    if (base != 0) emit("sub rax, " + std::to_string(base));
+    if (!subject.within(min, max)) {
+        emit("cmp rax, " + std::to_string(max - base));
+        emit("ja " + defaultLabel); // Unsigned: values below the base wrap around
+    }
+
+    std::map<size_t, uint64_t> masks; // By arm, so arms are tested in source order
+    uint64_t covered = 0;
+    for (const auto& c : cases) {
+        for (int64_t v = c.lo; v <= c.hi; ++v) {
+            masks[c.arm] |= uint64_t(1) << (v - base);
+        }
+    }
+    for (const auto& [arm, mask] : masks) {
+        covered |= mask;
+    }
+    // Every value that passes the bounds check selects some arm: the last test is implied.
+    uint64_t admitted = max - base == 63 ? ~uint64_t(0) : (uint64_t(1) << (max - base + 1)) - 1;
+    if (subject.within(min, max)) {
+        admitted &= ~((uint64_t(1) << (min - base)) - 1);
+    }
+    bool complete = (covered & admitted) == admitted;
+
+    size_t k = 0;
+    for (const auto& [arm, mask] : masks) {
+        if (++k == masks.size() && complete) {
+            emit("jmp " + armLabels[arm]);
+            return;
+        }
+        if (options_.optimizeSize && mask <= 0xFFFFFFFFull) {
+            emit("mov ecx, " + std::to_string(mask)); // Zero-extends; 5 bytes instead of 7 or 10
+        }
+        else {
+            emit("mov rcx, " + std::to_string(static_cast<int64_t>(mask)));
+        }
+        emit("bt rcx, rax");
+        emit("jc " + armLabels[arm]);
+    }
+    // Falling through reaches the `_` arm.
+}
+
+// RAX - min indexes a table of 32-bit offsets from the table to each arm.
+void CodeGenerator::emitMatchJumpTable(const std::vector<MatchCase>& cases, const Interval& subject,
+                                       const std::vector<std::string>& armLabels, const std::string& defaultLabel) {
+    int64_t min = cases.front().lo;
+    int64_t max = cases.back().hi;
+    std::string table = generateUniqueLabel(".Ltable");
+    if (min != 0) emit("sub rax, " + std::to_string(min));
+    if (!subject.within(min, max)) {
+        emit("cmp rax, " + std::to_string(max - min));
+        emit("ja " + defaultLabel);
+    }
+    emit("lea rcx, [rip + " + table + "]");
+    emit("movsxd rax, dword ptr [rcx + rax*4]");
+    emit("add rax, rcx");
+    emit("jmp rax");
+
+    std::vector<std::string> targets(static_cast<size_t>(max - min + 1), defaultLabel);
+    for (const auto& c : cases) {
+        for (int64_t v = c.lo; v <= c.hi; ++v) {
+            targets[static_cast<size_t>(v - min)] = armLabels[c.arm];
+        }
+    }
+    jumpTables_.push_back({ table, std::move(targets) });
+}
+
 // --- Symbol Table Management for CodeGen ---
 
-void CodeGenerator::defineVariable(const std::string& name, TokenType type) {
-    if (symbolTable_.count(name)) {
+void CodeGenerator::defineVariable(const IdentifierExpr* id, TokenType type) {
+    if (id->slot >= symbolTable_.size()) {
+        // Every variable is numbered by semantic analysis before codegen runs.
+        error("Internal Codegen Error: Variable '" + id->name + "' has no slot; was the program analyzed?");
+        return;
+    }
+    if (symbolTable_[id->slot].stackOffset != 0) {
         // This case should ideally be caught by semantic analysis.
-        error("Internal Codegen Error: Variable '" + name + "' redefined in codegen symbol table.");
+        error("Internal Codegen Error: Variable '" + id->name + "' redefined in codegen symbol table.");
         return;
     }
     // Allocate 8 bytes for a variable, regardless of its logical size (byte for bool, qword for int).
     // This simplifies stack offsets, ensuring all variable slots are 8 bytes,
     // which is also typically good for alignment.
     stackOffsetCounter_ -= 8;
-    symbolTable_[name] = { stackOffsetCounter_, type };
-    emit("sub rsp, 8"); // Allocate space on the stack for the new variable
+    symbolTable_[id->slot] = { stackOffsetCounter_, type };
+    if (!options_.optimizeSize) {
+        frameBytes_ += 8;
+        emit("sub rsp, 8"); // Allocate space on the stack for the new variable
+    }
 }
 
-CodegenSymbol* CodeGenerator::getSymbol(const std::string& name) {
-    auto it = symbolTable_.find(name);
-    if (it != symbolTable_.end()) {
-        return &it->second;
+CodegenSymbol* CodeGenerator::getSymbol(const IdentifierExpr* id) {
+    if (id->slot < symbolTable_.size() && symbolTable_[id->slot].stackOffset != 0) {
+        return &symbolTable_[id->slot];
     }
-    return nullptr; // Not found
+    return nullptr; // Not allocated yet
+}
+
+bool CodeGenerator::raxHolds(const IdentifierExpr* id) const {
+    return raxHolds_ && raxHolds_->slot == id->slot;
 }
 
 // --- Assembly Register & Size Utilities ---
@@ -419,9 +1154,9 @@ std::string CodeGenerator::getRegName(TokenType type, const std::string& baseReg
         if (type == INT) return "rax";
         if (type == BOOL) return "al";
     }
-    if (baseReg == "rbx") { // Used for second operand in binary ops
-        if (type == INT) return "rbx";
-        if (type == BOOL) return "bl";
+    if (baseReg == "rcx") { // Used for second operand in binary ops (and first argument on Windows)
+        if (type == INT) return "rcx";
+        if (type == BOOL) return "cl";
     }
     // For function call arguments (RDI/RSI/RDX/RCX/R8/R9 etc.)
     if (targetPlatform_ == PLATFORM_LINUX || targetPlatform_ == PLATFORM_MACOS) {
@@ -447,7 +1182,7 @@ std::string CodeGenerator::getRegName(TokenType type, const std::string& baseReg
         // ... add r8, r9 if needed
     }
 
-    // error("Codegen Error: Unhandled register alias for type " + tokenTypeStrings.at(type) + " with base " + baseReg);
+    // error("Codegen Error: Unhandled register alias for type " + std::string(tokenTypeName(type)) + " with base " + baseReg);
     return baseReg;
 }
 
@@ -4,14 +4,47 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <set>
 #include <sstream>
 
 #include "Token.h"
 #include "ast.h"
+#include "diagnostics.h"
+#include "match_lowering.h"
+#include "range_analysis.h"
 
 struct CodegenSymbol {
-	int stackOffset;
-    TokenType type;
+	int stackOffset = 0; // 0 until the variable's first store allocates its slot
+    TokenType type = ILLEGAL;
+};
+
+// Stack memory traffic of one statement's code: variable slots, expression
+// temporaries and call padding. Runtime calls themselves are not counted.
+struct StatementTraffic {
+    uint32_t offset = 0; // Statement's source offset
+    int loads = 0;
+    int stores = 0;
+    int bytes = 0;       // Bytes read plus bytes written
+};
+
+// Stack use of the generated function, measured from the instructions it emits.
+struct StackCall {
+    std::string symbol; // Runtime function called, without the macOS '_' or the -Os helper's ".L"
+    int depth = 0;      // Deepest site: bytes in use including the return address the call pushes
+};
+
+struct StackUsage {
+    int frameBytes = 0;           // Return address, saved RBP, locals, temporaries and call padding
+    std::vector<StackCall> calls;
+    std::string unbounded;        // Why the depth cannot be bounded (an asm_ block moving RSP by a register), else empty
+};
+
+// One line of the generated function, kept for --analyze-perf.
+struct ListedInstruction {
+    std::string text;         // Instruction, or label name without the colon
+    uint32_t offset = 0;      // Source offset of the statement that emitted it
+    bool label = false;
+    bool inStatement = false; // False in the prologue, the epilogue and -Os helpers
 };
 
 enum TargetPlatform {
@@ -21,19 +54,47 @@ enum TargetPlatform {
     PLATFORM_MACOS,
 };
 
+struct CodegenOptions {
+    std::string entryName = "main"; // Global symbol the program's statements are compiled into
+    bool optimizeSize = false;      // -Os: shortest encodings, one frame reservation, outlined calls
+    bool strengthReduce = false;    // Constant right operands as immediates; shifts for powers of two
+    bool forwardLoads = false;      // Skip reloading a variable RAX already holds; load right operands directly
+    bool useRanges = false;         // Unsigned and 32-bit division where value ranges prove operands non-negative
+    bool keepListing = false;       // Record every instruction and label with its statement (getListing)
+};
+
 class CodeGenerator
 {
 public:
-	CodeGenerator();
+	explicit CodeGenerator(const CodegenOptions& options = {});
 
 	std::string generate(const Program* program_ast);
-	std::vector<std::string> getErrors() const;
+	const std::vector<Diagnostic>& getErrors() const;
+	const std::vector<Remark>& getRemarks() const { return remarks_; }
+	const std::vector<StatementTraffic>& getTraffic() const { return traffic_; }
+	const StackUsage& getStackUsage() const { return stack_; }
+	const std::vector<ListedInstruction>& getListing() const { return listing_; }
 
 private:
-    mutable std::vector<std::string> errors_;
+    CodegenOptions options_;
+    std::vector<Diagnostic> errors_;
+    std::vector<Remark> remarks_;
+    std::vector<StatementTraffic> traffic_;
+    StackUsage stack_;
+    std::vector<ListedInstruction> listing_;
+    int stackDepth_ = 0;     // Bytes below the return address at the current instruction
+    RangeAnalysis ranges_;   // Filled by generate() when options_.useRanges is set
+    const IdentifierExpr* raxHolds_ = nullptr; // A reference to the variable whose current value RAX holds, if any
+    bool inStatement_ = false;
+    uint32_t currentOffset_ = 0; // Offset of the statement being generated, for diagnostics
     std::stringstream ss;
-    std::map<std::string, CodegenSymbol> symbolTable_; // Stores variable names and their stack locations
+    std::vector<CodegenSymbol> symbolTable_; // Stack locations, indexed by IdentifierExpr::slot
     int stackOffsetCounter_; // Tracks the next available stack slot for new variables
+    int pushDepth_ = 0;      // Bytes of expression temporaries currently pushed below the locals
+    int frameBytes_ = 0;     // Bytes reserved below RBP for locals (a multiple of 16 under -Os)
+    std::set<std::string> outlinedCalls_; // Runtime calls routed through a shared local helper (-Os)
+    std::vector<std::pair<std::string, std::vector<std::string>>> jumpTables_; // match tables: label, arm per entry
+    long long labelCounter_ = 0;
     TargetPlatform targetPlatform_;
 
     void error(const std::string& msg);
@@ -41,6 +102,16 @@ private:
     // Helper to add assembly instructions
     void emit(const std::string& instruction);
     void emitComment(const std::string& comment);
+    void emitLabel(const std::string& label);
+    std::string generateUniqueLabel(const std::string& prefix);
+    void countMemoryTraffic(const std::string& instruction);
+    void trackStack(const std::string& instruction);
+    void emitCall(const std::string& symbol); // Aligns RSP (and reserves shadow space on Windows) around the call
+    void emitLoadImmediate(long long value);  // Loads a constant into RAX, using the shortest form under -Os
+    void emitTestRax();                       // Sets flags from RAX for a following je/jne
+    void planSizeOptimizedFrame(const Program* program);
+    void emitOutlinedHelpers();
+    void emitJumpTables();
 
     // --- Platform-Specific Assembly Boilerplate ---
     void emitMainPrologue();
@@ -56,16 +127,31 @@ private:
     void visitAssignmentStatement(const AssignmentStatement* node);
     void visitExpressionStatement(const ExpressionStatement* node);
     void visitPrintStatement(const PrintStatement* node);
+    void visitAsmStatement(const AsmStatement* node);
 
     void visitExpression(const Expression* node); // Dispatcher for generic Expression*
     void visitIntegerLiteral(const IntegerLiteral* node);
     void visitBooleanLiteral(const BooleanLiteral* node);
     void visitIdentifierExpr(const IdentifierExpr* node);
     void visitBinaryExpression(const BinaryExpression* node);
-
-
-    void defineVariable(const std::string& name, TokenType type);
-    CodegenSymbol* getSymbol(const std::string& name);
+    void visitLogicalExpression(const BinaryExpression* node); // Short-circuit && and ||
+    bool emitImmediateOperation(const BinaryExpression* node);  // Strength-reduced forms; false if none applies
+    void emitDivide(const BinaryExpression* node);              // RAX / RCX (or RAX % RCX) into RAX
+    bool provenNonNegative(const Expression* node) const;
+    void visitUnaryExpression(const UnaryExpression* node);
+    void visitConditionalExpression(const ConditionalExpression* node);
+    void visitMatchExpression(const MatchExpression* node);
+    void emitMatchTree(const std::vector<MatchCase>& cases, size_t begin, size_t end,
+                       const std::vector<std::string>& armLabels, const std::string& defaultLabel, bool last);
+    void emitMatchBitTest(const std::vector<MatchCase>& cases, const Interval& subject,
+                          const std::vector<std::string>& armLabels, const std::string& defaultLabel);
+    void emitMatchJumpTable(const std::vector<MatchCase>& cases, const Interval& subject,
+                            const std::vector<std::string>& armLabels, const std::string& defaultLabel);
+
+
+    void defineVariable(const IdentifierExpr* id, TokenType type);
+    CodegenSymbol* getSymbol(const IdentifierExpr* id);
+    bool raxHolds(const IdentifierExpr* id) const;
 
     std::string getRegSize(TokenType type) const; // Added const
     std::string getArgRegister(int argIndex) const;
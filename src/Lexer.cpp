@@ -2,39 +2,8 @@
 #include "Lexer.h"
 #include <cctype>
 
-const std::map<TokenType, std::string> tokenTypeStrings = {
-    {ILLEGAL,            "ILLEGAL"},
-    {END_OF_FILE,        "EOF"},
-    {IDENTIFIER,         "IDENTIFIER"},
-    {INT,                "INT"},
-    {BOOL,               "BOOL"},
-    {FLOAT,              "FLOAT"},
-    {STRING,             "STRING"},
-    {CHAR,               "CHAR"},
-    {ASSIGN,             "ASSIGN"},
-    {COLON,              "COLON"},
-    {OCTAL,              "OCTAL"},
-    {HEX,                "HEX"},
-    {PLUS,               "PLUS"},
-    {MINUS,              "MINUS"},
-    {ASTERISK,           "ASTERISK"},
-    {SLASH,              "SLASH"},
-    {SEMICOLON,          "SEMICOLON"},
-    {LPAREN,             "LPAREN"},
-    {RPAREN,             "RPAREN"},
-    {PRINT,              "PRINT"},
-    {TRUE,               "TRUE"},
-    {FALSE,              "FALSE"},
-    {COMMENT_MULTI_LINE, "COMMENT_MULTI_LINE"},
-    {COMMENT_SINGLE_LINE,"COMMENT_SINGLE_LINE"}
-};
-
 std::string Token::toString() const {
-    auto it = tokenTypeStrings.find(type);
-    const std::string& typeStr = (it != tokenTypeStrings.end())
-        ? it->second
-        : "UNKNOWN_TOKEN_TYPE";
-    return "Token(Type: " + typeStr + ", Literal: \"" + literal + "\")";
+    return std::string("Token(Type: ") + tokenTypeName(type) + ", Literal: \"" + literal + "\")";
 }
 
 Lexer::Lexer(const std::string& input)
@@ -84,6 +53,15 @@ void Lexer::skipIgnorable() {
 Token Lexer::nextToken() {
     skipIgnorable();
 
+    uint32_t start = static_cast<uint32_t>(position_);
+    Token tok = scanToken();
+    tok.offset = start;
+    return tok;
+}
+
+// Scans one token starting at ch_; whitespace and comments are already skipped.
+Token Lexer::scanToken() {
+
     // -- string literal
     if (ch_ == '"') {
         std::string lit = readString();
@@ -107,13 +85,23 @@ Token Lexer::nextToken() {
         return { lookupIdent(lit), lit };
     }
 
+    // annotation  e.g.  @volatile
+    if (ch_ == '@' && (std::isalpha(static_cast<unsigned char>(peek())) || peek() == '_')) {
+        advance();
+        size_t start = position_;
+        while (std::isalnum(static_cast<unsigned char>(ch_)) || ch_ == '_') {
+            advance();
+        }
+        return { ANNOTATION, input_.substr(start, position_ - start) };
+    }
+
     // Numeric literal: hex, ocatal, int, float
     if (std::isdigit(static_cast<unsigned char>(ch_))) {
-        if (ch_ = '0' && peek() == 'x' || peek() == 'X') {
+        if (ch_ == '0' && (peek() == 'x' || peek() == 'X')) {
             size_t start = position_;
             advance();
             advance();
-            while (std::isdigit(static_cast<unsigned char>(ch_))) {
+            while (std::isxdigit(static_cast<unsigned char>(ch_))) {
                 advance();
             }
             std::string lit = input_.substr(start, position_ - start);
@@ -144,6 +132,25 @@ Token Lexer::nextToken() {
         return { INT, lit };
     }
 
+    // two-character operators
+    char next = peek();
+    TokenType twoChar = ILLEGAL;
+    if      (ch_ == '=' && next == '=') twoChar = EQ;
+    else if (ch_ == '!' && next == '=') twoChar = NOT_EQ;
+    else if (ch_ == '<' && next == '=') twoChar = LT_EQ;
+    else if (ch_ == '>' && next == '=') twoChar = GT_EQ;
+    else if (ch_ == '&' && next == '&') twoChar = AND;
+    else if (ch_ == '|' && next == '|') twoChar = OR;
+    else if (ch_ == '-' && next == '>') twoChar = ARROW;
+    else if (ch_ == '=' && next == '>') twoChar = FAT_ARROW;
+    else if (ch_ == '.' && next == '.') twoChar = DOTDOT;
+    if (twoChar != ILLEGAL) {
+        Token tok = { twoChar, std::string{ ch_, next } };
+        advance();
+        advance();
+        return tok;
+    }
+
     // single-character tokens
     Token tok;
     switch (ch_) {
@@ -152,10 +159,18 @@ Token Lexer::nextToken() {
     case '-': tok = { MINUS,     "-" }; break;
     case '*': tok = { ASTERISK,  "*" }; break;
     case '/': tok = { SLASH,     "/" }; break;
+    case '%': tok = { PERCENT,   "%" }; break;
+    case '!': tok = { BANG,      "!" }; break;
+    case '<': tok = { LT,        "<" }; break;
+    case '>': tok = { GT,        ">" }; break;
+    case '?': tok = { QUESTION,  "?" }; break;
+    case ',': tok = { COMMA,     "," }; break;
     case ';': tok = { SEMICOLON, ";" }; break;
     case '(': tok = { LPAREN,    "(" }; break;
     case ')': tok = { RPAREN,    ")" }; break;
     case ':': tok = { COLON,     ":" }; break;
+    case '{': tok = { LBRACE,    "{" }; break;
+    case '}': tok = { RBRACE,    "}" }; break;
     case  0: tok = { END_OF_FILE, "" }; break;
     default:  tok = { ILLEGAL, std::string(1, ch_) }; break;
     }
@@ -167,6 +182,8 @@ TokenType Lexer::lookupIdent(const std::string& lit) const {
     if (lit == "print") return PRINT;
     else if (lit == "true")  return TRUE;
     else if (lit == "false") return FALSE;
+    else if (lit == "asm_")  return ASM;
+    else if (lit == "match") return MATCH;
     else                      return IDENTIFIER;
 }
 
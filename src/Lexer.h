@@ -1,7 +1,7 @@
 #pragma once
 
 #include <string>
-#include "Token.h"    // brings in Token, TokenType, and tokenTypeStrings
+#include "Token.h"    // brings in Token, TokenType, and tokenTypeName
 
 class Lexer {
 public:
@@ -23,6 +23,9 @@ private:
     // Skip whitespace and both kinds of comments
     void skipIgnorable();
 
+    // Scan the token starting at ch_ (offset is filled in by nextToken)
+    Token scanToken();
+
     // Skip until end-of-line or EOF (assumes ch_ == '#')
     void skipSinglelineComment();
 
@@ -1,20 +1,32 @@
+#include <cctype>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 #include <memory>
 #include <map>
 #include <typeinfo>
 
-#include "Lexer.h"
 #include "Token.h"
-#include "Parser.h"
-#include "AST.h"
-#include "semantic_analyzer.h"
-#include "Codegen.h"
-
-extern const std::map<TokenType, std::string> tokenTypeStrings;
+#include "ast.h"
+#include "compiler.h"
+#include "diagnostics.h"
+#include "bytecode.h"
+#include "code_folding.h"
+#include "compile_cache.h"
+#include "elf_writer.h"
+#include "file_watcher.h"
+#include "incremental_build.h"
+#include "jit.h"
+#include "perf_analysis.h"
 
 // Read entire file into a string
 std::string readFileContent(const std::string& filename) {
@@ -44,63 +56,126 @@ void printAST(std::ostream& os, const ASTNode* node, int indent = 0) {
         os << prefix << "  Identifier: "
             << assign->identifier->name
             << " (Resolved: "
-            << tokenTypeStrings.at(assign->identifier->resolvedType)
+            << tokenTypeName(assign->identifier->resolvedType)
             << ")\n";
         os << prefix << "  Value:\n";
         printAST(os, assign->value.get(), indent + 2);
     }
     else if (auto expr_stmt = dynamic_cast<const ExpressionStatement*>(node)) {
         os << prefix << "ExpressionStatement (Resolved: "
-            << tokenTypeStrings.at(expr_stmt->expression->resolvedType)
+            << tokenTypeName(expr_stmt->expression->resolvedType)
             << "):\n";
         printAST(os, expr_stmt->expression.get(), indent + 1);
     }
     else if (auto print_stmt = dynamic_cast<const PrintStatement*>(node)) {
         os << prefix << "PrintStatement (Arg: "
-            << tokenTypeStrings.at(print_stmt->expression->resolvedType)
+            << tokenTypeName(print_stmt->expression->resolvedType)
             << "):\n";
         printAST(os, print_stmt->expression.get(), indent + 1);
     }
+    else if (auto block = dynamic_cast<const AsmStatement*>(node)) {
+        os << prefix << "AsmStatement" << (block->isVolatile ? " (volatile)" : "") << ":\n";
+        for (const auto& line : block->lines) {
+            os << prefix << "  \"" << line << "\"\n";
+        }
+        for (const auto& output : block->outputs) {
+            os << prefix << "  Output \"" << output.constraint << "\":\n";
+            printAST(os, output.expression.get(), indent + 2);
+        }
+        for (const auto& input : block->inputs) {
+            os << prefix << "  Input \"" << input.constraint << "\":\n";
+            printAST(os, input.expression.get(), indent + 2);
+        }
+        for (const auto& clobber : block->clobbers) {
+            os << prefix << "  Clobber \"" << clobber << "\"\n";
+        }
+    }
     else if (auto bin_expr = dynamic_cast<const BinaryExpression*>(node)) {
         os << prefix << "BinaryExpr (Op: "
-            << tokenTypeStrings.at(bin_expr->op)
+            << tokenTypeName(bin_expr->op)
             << ", Resolved: "
-            << tokenTypeStrings.at(bin_expr->resolvedType)
+            << tokenTypeName(bin_expr->resolvedType)
             << "):\n";
         os << prefix << "  Left:\n";
         printAST(os, bin_expr->left.get(), indent + 2);
         os << prefix << "  Right:\n";
         printAST(os, bin_expr->right.get(), indent + 2);
     }
+    else if (auto unary = dynamic_cast<const UnaryExpression*>(node)) {
+        os << prefix << "UnaryExpr (Op: "
+            << tokenTypeName(unary->op)
+            << ", Resolved: "
+            << tokenTypeName(unary->resolvedType)
+            << "):\n";
+        printAST(os, unary->operand.get(), indent + 1);
+    }
+    else if (auto cond = dynamic_cast<const ConditionalExpression*>(node)) {
+        os << prefix << "ConditionalExpr (Resolved: "
+            << tokenTypeName(cond->resolvedType)
+            << "):\n";
+        os << prefix << "  Condition:\n";
+        printAST(os, cond->condition.get(), indent + 2);
+        os << prefix << "  Then:\n";
+        printAST(os, cond->thenExpr.get(), indent + 2);
+        os << prefix << "  Else:\n";
+        printAST(os, cond->elseExpr.get(), indent + 2);
+    }
+    else if (auto match = dynamic_cast<const MatchExpression*>(node)) {
+        os << prefix << "MatchExpr (Resolved: "
+            << tokenTypeName(match->resolvedType)
+            << "):\n";
+        os << prefix << "  Subject:\n";
+        printAST(os, match->subject.get(), indent + 2);
+        for (const auto& arm : match->arms) {
+            os << prefix << "  Arm";
+            if (arm.ranges.empty()) os << " _";
+            for (size_t r = 0; r < arm.ranges.size(); ++r) {
+                os << (r ? ", " : " ") << arm.ranges[r].first;
+                if (arm.ranges[r].second != arm.ranges[r].first) os << ".." << arm.ranges[r].second;
+            }
+            os << ":\n";
+            printAST(os, arm.value.get(), indent + 2);
+        }
+    }
+    else if (auto call = dynamic_cast<const CallExpression*>(node)) {
+        os << prefix << "CallExpr: " << call->callee << "\n";
+        for (const auto& arg : call->arguments) {
+            printAST(os, arg.get(), indent + 1);
+        }
+    }
+    else if (auto member = dynamic_cast<const MemberAccessExpression*>(node)) {
+        os << prefix << "MemberAccessExpr: ->" << member->member << "\n";
+        printAST(os, member->object.get(), indent + 1);
+    }
     else if (auto int_lit = dynamic_cast<const IntegerLiteral*>(node)) {
         os << prefix << "IntegerLiteral: " << int_lit->value
             << " (Resolved: "
-            << tokenTypeStrings.at(int_lit->resolvedType)
+            << tokenTypeName(int_lit->resolvedType)
             << ")\n";
     }
     else if (auto bool_lit = dynamic_cast<const BooleanLiteral*>(node)) {
         os << prefix << "BooleanLiteral: "
             << (bool_lit->value ? "true" : "false")
             << " (Resolved: "
-            << tokenTypeStrings.at(bool_lit->resolvedType)
+            << tokenTypeName(bool_lit->resolvedType)
             << ")\n";
     }
     else if (auto str_lit = dynamic_cast<const StringLiteral*>(node)) {
         os << prefix << "StringLiteral: \"" << str_lit->value
             << "\" (Resolved: "
-            << tokenTypeStrings.at(str_lit->resolvedType)
+            << tokenTypeName(str_lit->resolvedType)
             << ")\n";
     }
     else if (auto char_lit = dynamic_cast<const CharLiteral*>(node)) {
         os << prefix << "CharLiteral: '" << char_lit->value
             << "' (Resolved: "
-            << tokenTypeStrings.at(char_lit->resolvedType)
+            << tokenTypeName(char_lit->resolvedType)
             << ")\n";
     }
     else if (auto id_expr = dynamic_cast<const IdentifierExpr*>(node)) {
         os << prefix << "IdentifierExpr: " << id_expr->name
             << " (Resolved: "
-            << tokenTypeStrings.at(id_expr->resolvedType)
+            << tokenTypeName(id_expr->resolvedType)
             << ")\n";
     }
     else {
@@ -109,48 +184,544 @@ void printAST(std::ostream& os, const ASTNode* node, int indent = 0) {
     }
 }
 
-int main(int argc, char* argv[]) {
-    if (argc < 2 || argc > 3) {
-        std::cerr << "Usage: " << argv[0]
-            << " [input_file] [output_asm_file (optional)]\n";
+// Runtime helpers for --run; same behaviour as print_int.c.
+static void hostPrintInt(long n) {
+    std::printf("%ld\n", n);
+}
+
+static void hostPrintBool(bool b) {
+    std::printf("%d\n", b ? 1 : 0);
+}
+
+// Compiles in memory and runs the program in-process; prints only the program's output.
+static int runJit(const std::string& input_filename, const std::string& source) {
+    JitEngine jit;
+    jit.defineSymbol("print_int", reinterpret_cast<const void*>(&hostPrintInt));
+    jit.defineSymbol("print_bool", reinterpret_cast<const void*>(&hostPrintBool));
+
+    bool loaded = jit.load(input_filename, source);
+    SourceIndex sourceIndex(source);
+    for (const auto& d : jit.getErrors()) {
+        std::cerr << formatDiagnostic(d, sourceIndex, input_filename) << "\n";
+    }
+    if (!loaded) return 1;
+
+    EpochReclaimer::Participant* self = jit.epochs().registerThread();
+    int status = jit.run(input_filename, self);
+    jit.epochs().unregisterThread(self);
+    std::fflush(stdout);
+    return status;
+}
+
+// --run=interp: bytecode interpreter only, no native code.
+static int runInterpreter(const std::string& input_filename, const std::string& source) {
+    CompileOptions options;
+    options.output = OUTPUT_AST;
+    CompileResult result = compileSource(source, options);
+    SourceIndex sourceIndex(source);
+    for (const auto& d : result.diagnostics) {
+        std::cerr << formatDiagnostic(d, sourceIndex, input_filename) << "\n";
+    }
+    if (!result.ok) return 1;
+
+    BytecodeCompiler compiler;
+    Chunk chunk;
+    if (!compiler.compile(result.ast.get(), chunk)) {
+        for (const auto& d : compiler.getErrors()) {
+            std::cerr << formatDiagnostic(d, sourceIndex, input_filename) << "\n";
+        }
+        return 1;
+    }
+    RuntimeHooks hooks;
+    hooks.printInt = hostPrintInt;
+    hooks.printBool = hostPrintBool;
+    InterpretResult status = interpret(chunk, hooks);
+    if (status != INTERPRET_OK) {
+        std::cerr << input_filename << ": runtime error: "
+                  << (status == INTERPRET_DIVISION_BY_ZERO ? "division by zero" : "division overflow") << "\n";
+        return 1;
+    }
+    std::fflush(stdout);
+    return 0;
+}
+
+static void reportBuild(const BuildUnitResult& r) {
+    static const char* kStatus[] = { "built", "up to date", "failed", "removed" };
+    std::cout << "[watch] " << r.source.string() << ": " << kStatus[r.status];
+    if (r.status == BUILD_BUILT) std::cout << " -> " << r.artifact.string();
+    std::printf(" (%.2f ms)\n", r.milliseconds);
+    for (const auto& msg : r.messages) std::cerr << "  - " << msg << "\n";
+    std::cout.flush();
+}
+
+// --watch: stays resident and rebuilds each .glx unit under `dir` when it changes.
+static int watchDirectory(const std::string& dir, const CompileOptions& options) {
+    FileWatcher watcher(dir, ".glx");
+    if (!watcher.ok()) {
+        std::cerr << "Error: " << watcher.error() << "\n";
+        return 1;
+    }
+    IncrementalBuilder builder(options);
+    for (const auto& file : watcher.scan()) {
+        reportBuild(builder.build(file));
+    }
+    std::cout << "[watch] watching " << dir << " (Ctrl-C to stop)" << std::endl;
+    for (;;) {
+        for (const auto& file : watcher.wait(std::chrono::milliseconds(1000))) {
+            reportBuild(builder.build(file));
+        }
+    }
+}
+
+// --size-report: bytes per function and total .text, default mode against -Os.
+static int sizeReport(const std::string& input_filename, const std::string& source, const CompileOptions& base) {
+    CompileResult modes[2];
+    for (int i = 0; i < 2; ++i) {
+        CompileOptions options = base;
+        options.output = OUTPUT_MACHINE_CODE;
+        options.optimizeSize = i == 1;
+        modes[i] = compileSource(source, options);
+        if (!modes[i].ok) {
+            SourceIndex sourceIndex(source);
+            for (const auto& d : modes[i].diagnostics) {
+                std::cerr << formatDiagnostic(d, sourceIndex, input_filename) << "\n";
+            }
+            return 1;
+        }
+    }
+
+    // A function extends from its symbol to the next one (or the end of .text).
+    auto functionSize = [](const MachineCode& code, size_t index) {
+        size_t end = index + 1 < code.symbols.size() ? code.symbols[index + 1].offset : code.bytes.size();
+        return end - code.symbols[index].offset;
+    };
+    auto row = [](const std::string& name, size_t before, size_t after) {
+        double delta = before ? 100.0 * (static_cast<double>(after) - static_cast<double>(before)) / static_cast<double>(before) : 0.0;
+        std::printf("%-24s %10zu %10zu %+8.1f%%\n", name.c_str(), before, after, delta);
+    };
+    std::printf("%-24s %10s %10s %9s\n", "function", "default", "-Os", "delta");
+    const MachineCode& sized = modes[1].machineCode;
+    for (size_t i = 0; i < modes[0].machineCode.symbols.size(); ++i) {
+        const CodeSymbol& symbol = modes[0].machineCode.symbols[i];
+        for (size_t j = 0; j < sized.symbols.size(); ++j) {
+            if (sized.symbols[j].name == symbol.name) {
+                row(symbol.name, functionSize(modes[0].machineCode, i), functionSize(sized, j));
+            }
+        }
+    }
+    row(".text total", modes[0].machineCode.bytes.size(), sized.bytes.size());
+    return 0;
+}
+
+// --mem-report: stack memory traffic per statement with load forwarding off and
+// on (the other passes as selected). Only statements whose traffic differs, or
+// that still touch memory, are listed.
+static int memoryReport(const std::string& input_filename, const std::string& source, const CompileOptions& base) {
+    CompileResult modes[2];
+    for (int i = 0; i < 2; ++i) {
+        CompileOptions options = base;
+        options.output = OUTPUT_ASSEMBLY;
+        options.passes = i == 0 ? base.passes & ~PASS_FORWARD : base.passes | PASS_FORWARD;
+        modes[i] = compileSource(source, options);
+        if (!modes[i].ok) {
+            SourceIndex sourceIndex(source);
+            for (const auto& d : modes[i].diagnostics) {
+                std::cerr << formatDiagnostic(d, sourceIndex, input_filename) << "\n";
+            }
+            return 1;
+        }
+    }
+
+    // Both compiles ran the same AST passes, so their statements line up.
+    SourceIndex sourceIndex(source);
+    std::printf("%-8s %22s %22s\n", "line", "unforwarded (ld/st B)", "forwarded (ld/st B)");
+    StatementTraffic total[2];
+    for (size_t i = 0; i < modes[0].traffic.size() && i < modes[1].traffic.size(); ++i) {
+        const StatementTraffic& a = modes[0].traffic[i];
+        const StatementTraffic& b = modes[1].traffic[i];
+        for (int m = 0; m < 2; ++m) {
+            const StatementTraffic& t = m == 0 ? a : b;
+            total[m].loads += t.loads;
+            total[m].stores += t.stores;
+            total[m].bytes += t.bytes;
+        }
+        if (a.bytes == 0 && b.bytes == 0) continue;
+        std::printf("%-8u %9d/%-3d %6d B %9d/%-3d %6d B\n", sourceIndex.locate(a.offset).line,
+            a.loads, a.stores, a.bytes, b.loads, b.stores, b.bytes);
+    }
+    std::printf("%-8s %9d/%-3d %6d B %9d/%-3d %6d B\n", "total",
+        total[0].loads, total[0].stores, total[0].bytes, total[1].loads, total[1].stores, total[1].bytes);
+    return 0;
+}
+
+// --stack-usage: frame size and worst-case stack depth of the compiled function,
+// like GCC's -fstack-usage plus the call graph. Calls into the print runtime are
+// charged --helper-stack=N bytes.
+static int stackUsageReport(const std::string& input_filename, const std::string& source, const CompileOptions& base) {
+    CompileOptions options = base;
+    options.output = OUTPUT_ASSEMBLY;
+    CompileResult result = compileSource(source, options);
+    SourceIndex sourceIndex(source);
+    for (const auto& d : result.diagnostics) {
+        std::cerr << formatDiagnostic(d, sourceIndex, input_filename) << "\n";
+    }
+    if (result.stack.frameBytes == 0) return 1; // Stopped before code generation
+
+    const StackUsage& usage = result.stack;
+    std::printf("%s: %s\n", input_filename.c_str(), options.entryName.c_str());
+    std::printf("  %-24s %6d B\n", "frame", usage.frameBytes);
+    for (const auto& call : usage.calls) {
+        bool known = call.symbol == "print_int" || call.symbol == "print_bool";
+        std::printf("  %-24s %6d B + %s\n", ("call " + call.symbol).c_str(), call.depth,
+            known ? (std::to_string(options.helperStackBytes) + " B assumed").c_str() : "unknown");
+    }
+    int64_t worst = worstCaseStack(usage, options);
+    if (worst < 0) {
+        std::printf("  %-24s unbounded%s%s\n", "worst case", usage.unbounded.empty() ? "" : ": ", usage.unbounded.c_str());
+    }
+    else {
+        std::printf("  %-24s %6lld B\n", "worst case", static_cast<long long>(worst));
+    }
+    if (result.ast && result.ast->maxStack >= 0) {
+        std::printf("  %-24s %s\n", ("@max_stack(" + std::to_string(result.ast->maxStack) + ")").c_str(), worst < 0 ? "cannot be checked" : worst <= result.ast->maxStack ? "ok" : "exceeded");
+    }
+    return result.ok ? 0 : 1;
+}
+
+// --analyze-perf: static cycle estimates for each basic block of the generated
+// code on one microarchitecture (see perf_analysis.h). Instructions are listed
+// with the source line that emitted them ('-' for the prologue and epilogue)
+// and '*' on the block's critical chain; a per-line summary follows.
+static int perfReport(const std::string& input_filename, const std::string& source, const CompileOptions& base, Microarch arch) {
+    CompileOptions options = base;
+    options.output = OUTPUT_ASSEMBLY;
+    options.keepListing = true;
+    CompileResult result = compileSource(source, options);
+    SourceIndex sourceIndex(source);
+    if (!result.ok) {
+        for (const auto& d : result.diagnostics) {
+            std::cerr << formatDiagnostic(d, sourceIndex, input_filename) << "\n";
+        }
         return 1;
     }
 
-    std::string input_filename = argv[1];
-    std::string output_asm = (argc == 3 ? argv[2] : "output.s");
+    struct LineCost {
+        size_t instructions = 0;
+        int uops = 0;
+        double critical = 0.0; // Cycles of critical chains spent in the line's instructions
+    };
+    std::map<uint32_t, LineCost> lines; // Line 0: prologue and epilogue
+    auto lineOf = [&](const ListedInstruction& listed) { return listed.inStatement ? sourceIndex.locate(listed.offset).line : 0u; };
+
+    PerfReport report = analyzePerformance(result.listing, arch);
+    std::printf("%s: %s on %s\n", input_filename.c_str(), options.entryName.c_str(), microarchName(arch));
+    for (size_t b = 0; b < report.blocks.size(); ++b) {
+        const PerfBlock& block = report.blocks[b];
+        std::printf("\nblock %zu%s%s: %zu instructions, %d uops\n", b, block.label.empty() ? "" : " ", block.label.c_str(),
+            block.instructions.size(), block.uops);
+        std::printf("  latency %.1f cycles, throughput %.2f cycles/iteration, bound by %s\n",
+            block.latency, block.throughput, block.bottleneck.c_str());
+        std::printf("  pressure");
+        for (size_t p = 0; p < report.ports.size(); ++p) {
+            if (block.portPressure[p] > 0.0) std::printf("  %s %.2f", report.ports[p].c_str(), block.portPressure[p]);
+        }
+        std::printf("\n  %5s %4s %6s\n", "line", "lat", "ready");
+        double chain = 0.0;
+        for (const auto& inst : block.instructions) {
+            const ListedInstruction& listed = result.listing[inst.listing];
+            uint32_t line = lineOf(listed);
+            LineCost& cost = lines[line];
+            ++cost.instructions;
+            cost.uops += inst.uops;
+            if (inst.critical) {
+                cost.critical += inst.ready - chain;
+                chain = inst.ready;
+            }
+            std::printf("  %5s %4d %6.1f %c %s%s\n", line ? std::to_string(line).c_str() : "-", inst.latency, inst.ready,
+                inst.critical ? '*' : ' ', listed.text.c_str(), inst.modeled ? "" : "   (not modeled)");
+        }
+    }
+
+    std::printf("\n%-8s %12s %8s %16s\n", "line", "instructions", "uops", "critical cycles");
+    LineCost total;
+    for (const auto& [line, cost] : lines) {
+        std::printf("%-8s %12zu %8d %16.1f\n", line ? std::to_string(line).c_str() : "-", cost.instructions, cost.uops, cost.critical);
+        total.instructions += cost.instructions;
+        total.uops += cost.uops;
+        total.critical += cost.critical;
+    }
+    std::printf("%-8s %12zu %8d %16.1f\n", "total", total.instructions, total.uops, total.critical);
+    return 0;
+}
+
+// Symbol a bundled file is compiled into: its stem, made a valid identifier.
+static std::string bundleSymbol(const std::string& filename) {
+    std::string name = std::filesystem::path(filename).stem().string();
+    for (char& c : name) {
+        if (!std::isalnum(static_cast<unsigned char>(c))) c = '_';
+    }
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) name.insert(0, "_");
+    return name;
+}
+
+// --bundle: compiles every file into one function of a single ELF object.
+// Files are compiled on all cores through a shared CompileCache, so files that
+// differ only in variable names are generated once, and identical bodies that
+// remain are folded.
+static int bundleFiles(const std::vector<std::string>& inputs, const std::string& output_file, const CompileOptions& base, FoldMode mode) {
+    std::vector<std::string> symbols;
+    std::map<std::string, std::string> owners;
+    for (const auto& input : inputs) {
+        symbols.push_back(bundleSymbol(input));
+        if (!owners.emplace(symbols.back(), input).second) {
+            std::cerr << "Error: " << input << " and " << owners[symbols.back()] << " both define '" << symbols.back() << "'\n";
+            return 1;
+        }
+    }
+
+    CompileCache cache;
+    std::vector<std::string> sources(inputs.size());
+    std::vector<CompileResult> results(inputs.size());
+    std::atomic<size_t> next{ 0 };
+    auto worker = [&] {
+        for (size_t i; (i = next.fetch_add(1)) < inputs.size();) {
+            sources[i] = readFileContent(inputs[i]);
+            CompileOptions options = base;
+            options.output = OUTPUT_AST;
+            results[i] = compileSource(sources[i], options);
+            if (!results[i].ok) continue;
+            options.output = OUTPUT_MACHINE_CODE;
+            options.entryName = symbols[i];
+            cache.compile(results[i], options);
+        }
+    };
+    std::vector<std::thread> threads;
+    size_t threadCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), inputs.size());
+    for (size_t t = 1; t < threadCount; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& t : threads) t.join();
+
+    std::vector<FunctionCode> functions;
+    bool ok = true;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        SourceIndex sourceIndex(sources[i]);
+        for (const auto& d : results[i].diagnostics) {
+            std::cerr << formatDiagnostic(d, sourceIndex, inputs[i]) << "\n";
+        }
+        ok = ok && results[i].ok;
+        functions.push_back({ symbols[i], std::move(results[i].machineCode) });
+    }
+    if (!ok) return 1;
+
+    for (const auto& entry : cache.stats()) {
+        std::printf("  compiled %-20s %4zu bytes %8.3f ms, used by %zu file(s)\n",
+            entry.firstUser.c_str(), entry.bytes, entry.milliseconds, entry.uses);
+    }
+
+    FoldReport report;
+    MachineCode code = linkFunctions(functions, mode, &report);
+    std::vector<uint8_t> object = writeElfObject(code);
+    std::ofstream out_file(output_file, std::ios::binary);
+    if (!out_file.is_open()) {
+        std::cerr << "Error: Could not open " << output_file << " for writing.\n";
+        return 1;
+    }
+    out_file.write(reinterpret_cast<const char*>(object.data()), static_cast<std::streamsize>(object.size()));
+
+    for (const auto& f : report.folded) {
+        std::cout << "  folded " << f.name << " -> " << f.target << (f.thunk ? " (thunk)" : " (alias)") << "\n";
+    }
+    double saved = report.bytesBefore ? 100.0 * static_cast<double>(report.bytesBefore - report.bytesAfter) / static_cast<double>(report.bytesBefore) : 0.0;
+    std::printf("%s: %zu functions, %zu folded, .text %zu -> %zu bytes (%.1f%% smaller)\n",
+        output_file.c_str(), report.functions, report.folded.size(), report.bytesBefore, report.bytesAfter, saved);
+    return 0;
+}
+
+static const char* stageHeading(const Diagnostic& d) {
+    if (d.kind <= DIAG_NOT_CALLABLE) return "Parser Errors:";
+    if (d.kind == DIAG_CODEGEN) return "Codegen Errors:";
+    return "Semantic Errors:";
+}
+
+static void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0
+        << " [input_file] [output_file (optional)] [--emit=asm|obj|c] [-O0] [-Os] [--passes=list] [--opt-report] [--range-report] [--multiversion] [-o output_file] [--run[=jit|interp]]\n"
+        << "       " << argv0 << " --watch dir [--emit=asm|obj|c] [-Os]\n"
+        << "       " << argv0 << " --size-report input_file\n"
+        << "       " << argv0 << " --mem-report [--passes=list] input_file\n"
+        << "       " << argv0 << " --stack-usage [-Os] [--helper-stack=bytes] input_file\n"
+        << "       " << argv0 << " --analyze-perf[=skylake|zen3|zen4] [-Os] [--passes=list] input_file\n"
+        << "       " << argv0 << " --bundle [-o output.o] [--icf=none|safe|all] [-Os] input_file...\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string input_filename;
+    std::string output_file;
+    std::string watch_dir;
+    CompileOptions options;
+    enum { RUN_NONE, RUN_JIT, RUN_INTERPRETER } run = RUN_NONE;
+    bool size_report = false;
+    bool opt_report = false;
+    bool range_report = false;
+    bool mem_report = false;
+    bool stack_usage = false;
+    bool analyze_perf = false;
+    Microarch perf_arch = MICROARCH_SKYLAKE;
+    bool bundle = false;
+    std::vector<std::string> bundle_inputs;
+    FoldMode fold = FOLD_SAFE;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--emit=asm") {
+            options.output = OUTPUT_ASSEMBLY;
+        }
+        else if (arg == "--emit=obj") {
+            options.output = OUTPUT_OBJECT;
+        }
+        else if (arg == "--emit=c") {
+            options.output = OUTPUT_C;
+        }
+        else if (arg == "-Os") {
+            options.optimizeSize = true;
+        }
+        else if (arg == "-O0") {
+            options.passes = 0;
+        }
+        else if (arg.rfind("--passes=", 0) == 0) {
+            if (!parsePassList(arg.substr(9), options.passes)) {
+                std::cerr << "Error: unknown pass in " << arg << " (known: fold, propagate, dse, strength, forward, range, all, none)\n";
+                return 1;
+            }
+        }
+        else if (arg == "--mem-report") {
+            mem_report = true;
+        }
+        else if (arg == "--stack-usage") {
+            stack_usage = true;
+        }
+        else if (arg == "--analyze-perf") {
+            analyze_perf = true;
+        }
+        else if (arg.rfind("--analyze-perf=", 0) == 0) {
+            analyze_perf = true;
+            if (!parseMicroarch(arg.substr(15), perf_arch)) {
+                std::cerr << "Error: unknown microarchitecture in " << arg << " (known: skylake, zen3, zen4)\n";
+                return 1;
+            }
+        }
+        else if (arg.rfind("--helper-stack=", 0) == 0) {
+            options.helperStackBytes = std::atoi(arg.c_str() + 15);
+        }
+        else if (arg == "--opt-report") {
+            opt_report = true;
+        }
+        else if (arg == "--range-report") {
+            range_report = true;
+        }
+        else if (arg == "--multiversion") {
+            options.multiversion = true;
+        }
+        else if (arg == "--size-report") {
+            size_report = true;
+        }
+        else if (arg == "--bundle") {
+            bundle = true;
+        }
+        else if (arg == "--icf=none" || arg == "--icf=safe" || arg == "--icf=all") {
+            fold = arg == "--icf=none" ? FOLD_NONE : arg == "--icf=all" ? FOLD_ALL : FOLD_SAFE;
+        }
+        else if (bundle && !arg.empty() && arg[0] != '-') {
+            bundle_inputs.push_back(arg);
+        }
+        else if (arg == "--run" || arg == "--run=jit") {
+            run = RUN_JIT;
+        }
+        else if (arg == "--run=interp") {
+            run = RUN_INTERPRETER;
+        }
+        else if (arg == "--watch" && i + 1 < argc) {
+            watch_dir = argv[++i];
+        }
+        else if (arg == "-o" && i + 1 < argc) {
+            output_file = argv[++i];
+        }
+        else if (!arg.empty() && arg[0] != '-' && input_filename.empty()) {
+            input_filename = arg;
+        }
+        else if (!arg.empty() && arg[0] != '-' && output_file.empty()) {
+            output_file = arg;
+        }
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.multiversion && options.output != OUTPUT_C) {
+        // The native backend only emits baseline x86-64 integer code; there is nothing to specialize.
+        std::cerr << "Error: --multiversion requires --emit=c\n";
+        return 1;
+    }
+    if (!watch_dir.empty()) {
+        return watchDirectory(watch_dir, options);
+    }
+    if (bundle) {
+        if (bundle_inputs.empty()) {
+            usage(argv[0]);
+            return 1;
+        }
+        return bundleFiles(bundle_inputs, output_file.empty() ? "bundle.o" : output_file, options, fold);
+    }
+    if (input_filename.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (output_file.empty()) {
+        output_file = options.output == OUTPUT_OBJECT ? "output.o" : options.output == OUTPUT_C ? "output.c" : "output.s";
+    }
 
     // Read source
     std::string source = readFileContent(input_filename);
     if (source.empty()) return 1;
+    if (size_report) return sizeReport(input_filename, source, options);
+    if (mem_report) return memoryReport(input_filename, source, options);
+    if (stack_usage) return stackUsageReport(input_filename, source, options);
+    if (analyze_perf) return perfReport(input_filename, source, options, perf_arch);
+    if (run == RUN_JIT) return runJit(input_filename, source);
+    if (run == RUN_INTERPRETER) return runInterpreter(input_filename, source);
 
     std::cout << "Processing " << input_filename << " ...\n\n";
     std::cout << source << "\n---\n\n";
 
-    // Lexing & Parsing
-    Lexer lexer(source);
-    Parser parser(lexer);
-    auto program_ast = parser.parseProgram();
+    CompileResult result = compileSource(source, options);
 
-    if (!parser.getErrors().empty()) {
-        std::cerr << "Parser Errors:\n";
-        for (auto& e : parser.getErrors()) {
-            std::cerr << "  - " << e << "\n";
+    // Line/column information is only computed if a diagnostic is printed.
+    SourceIndex sourceIndex(source);
+    const char* heading = nullptr;
+    for (const auto& d : result.diagnostics) {
+        if (stageHeading(d) != heading) {
+            heading = stageHeading(d);
+            std::cerr << heading << "\n";
         }
-        return 1;
+        std::cerr << "  - " << formatDiagnostic(d, sourceIndex, input_filename) << "\n";
     }
-    std::cout << "Parsing successful.\n\n";
-
-    // Semantic Analysis
-    SemanticAnalyzer sema;
-    sema.analyze(*program_ast);
-    if (!sema.getErrors().empty()) {
-        std::cerr << "Semantic Errors:\n";
-        for (auto& e : sema.getErrors()) {
-            std::cerr << "  - " << e << "\n";
+    if (!result.ok) return 1;
+    std::cout << "Parsing and semantic analysis successful.\n\n";
+    if (opt_report) {
+        for (const auto& r : result.remarks) {
+            std::cout << formatRemark(r, sourceIndex, input_filename) << "\n";
         }
-        return 1;
+        std::cout << result.remarks.size() << " optimization remark(s)\n\n";
+    }
+    if (range_report) {
+        // Variable ranges at each assignment, then the code they changed.
+        size_t count = 0;
+        for (const auto& r : result.remarks) {
+            if (r.pass != "range") continue;
+            std::cout << formatRemark(r, sourceIndex, input_filename) << "\n";
+            ++count;
+        }
+        std::cout << count << " range remark(s)\n\n";
     }
-    std::cout << "Semantic analysis successful.\n\n";
 
     // Write AST to file
     {
@@ -159,29 +730,27 @@ int main(int argc, char* argv[]) {
             std::cerr << "Error: Could not open ast.txt for writing.\n";
             return 1;
         }
-        printAST(ast_file, program_ast.get());
+        printAST(ast_file, result.ast.get());
     }
     std::cout << "AST written to ast.txt\n\n";
 
-    // Code Generation
-    CodeGenerator codegen;
-    std::string asm_out = codegen.generate(program_ast.get());
-    if (!codegen.getErrors().empty()) {
-        std::cerr << "Codegen Errors:\n";
-        for (auto& e : codegen.getErrors()) {
-            std::cerr << "  - " << e << "\n";
-        }
-        return 1;
-    }
     std::cout << "Code generation successful. Writing to "
-        << output_asm << "\n";
+        << output_file << "\n";
 
-    std::ofstream out_file(output_asm);
+    std::ofstream out_file(output_file, std::ios::binary);
     if (!out_file.is_open()) {
-        std::cerr << "Error: Could not open " << output_asm
+        std::cerr << "Error: Could not open " << output_file
             << " for writing.\n";
         return 1;
     }
-    out_file << asm_out;
+    if (options.output == OUTPUT_OBJECT) {
+        out_file.write(reinterpret_cast<const char*>(result.object.data()), static_cast<std::streamsize>(result.object.size()));
+    }
+    else if (options.output == OUTPUT_C) {
+        out_file << result.cSource;
+    }
+    else {
+        out_file << result.assembly;
+    }
     return 0;
-}
\ No newline at end of file
+}
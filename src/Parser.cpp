@@ -1,53 +1,23 @@
 #include "Parser.h"
 #include <iostream>
 #include <stdexcept>
-#include <map>
 #include <string>
 #include <cstdlib>
 #include <vector>
 
-// --- Global Precedence Map ---
-const std::map<TokenType, Precedence> precedences = {
-    {ASSIGN,    ASSIGN_PRECEDENCE},
-    {PLUS,      SUM},
-    {MINUS,     SUM},
-    {ASTERISK,  PRODUCT},
-    {SLASH,     PRODUCT}
-};
-
 Parser::Parser(Lexer& l) : lexer_(l) {
     // Initialize tokens. Important to get at least two tokens to start lookahead.
     // Ensure lexer is initialized and first token is ready.
     nextToken(); // Sets currentToken_ to the first token.
     nextToken(); // Sets peekToken_ to the second token.
-
-    setupParseFunctions(); // Register parsing functions.
 }
 
-std::vector<std::string> Parser::getErrors() const {
+const std::vector<Diagnostic>& Parser::getErrors() const {
     return errors_;
 }
 
-constexpr const char* tokenTypeToString(TokenType type) {
-    switch (type) {
-    case ASSIGN: return "ASSIGN";
-    case PLUS: return "PLUS";
-    case MINUS: return "MINUS";
-    case ASTERISK: return "ASTERISK";
-    case SLASH: return "SLASH";
-    case INT: return "INT";
-    case IDENTIFIER: return "IDENTIFIER";
-        // add more cases...
-    default: return "UNKNOWN";
-    }
-}
-
 void Parser::peekError(TokenType type) {
-    std::ostringstream msg;
-    msg << "Parser error: Expected next token to be " << tokenTypeToString(type)
-        << ", got " << tokenTypeToString(peekToken_.type)
-        << " instead. (Literal: '" << peekToken_.literal << "')";
-    errors_.emplace_back(msg.str());
+    errors_.push_back({ DIAG_EXPECTED_TOKEN, peekToken_.offset, type, peekToken_.type, peekToken_.literal });
 }
 // Helper to check if a token type is a comment.
 bool Parser::isCommentToken(TokenType type) const {
@@ -62,7 +32,7 @@ bool Parser::isCommentToken(TokenType type) const {
 // can find the next *actual* token.
 void Parser::nextToken() {
     // Move the current token to the previously peeked token.
-    currentToken_ = peekToken_;
+    currentToken_ = std::move(peekToken_);
     peekToken_ = lexer_.nextToken();
 
     while (isCommentToken(peekToken_.type)) {
@@ -70,6 +40,16 @@ void Parser::nextToken() {
     }
 }
 
+// Error recovery: skip the rest of a malformed statement, up to and including its ';'.
+void Parser::synchronize() {
+    while (!currentTokenIs(END_OF_FILE) && !currentTokenIs(SEMICOLON)) {
+        nextToken();
+    }
+    if (currentTokenIs(SEMICOLON)) {
+        nextToken();
+    }
+}
+
 inline bool Parser::currentTokenIs(TokenType type) const {
     return currentToken_.type == type;
 }
@@ -95,9 +75,24 @@ std::unique_ptr<Program> Parser::parseProgram() {
 
     // Loop until the current token is END_OF_FILE.
     while (currentToken_.type != END_OF_FILE) {
+        if (currentTokenIs(ANNOTATION)) {
+            if (parseProgramAnnotation(*program)) nextToken();
+            else synchronize();
+            continue;
+        }
+
         // Get the next AST node (could be a Statement or a CommentNode).
         std::unique_ptr<ASTNode> node = parseTopLevelNode();
 
+        // Statements end on their last token; step past it. A failed statement skips
+        // to the next ';' instead, so every iteration makes progress.
+        if (!node) {
+            synchronize();
+        }
+        else {
+            nextToken();
+        }
+
         if (node) {
             // If the node is a Statement, add it to the program's statements.
             if (auto stmt_ptr = dynamic_cast<Statement*>(node.get())) {
@@ -127,7 +122,7 @@ std::unique_ptr<ASTNode> Parser::parseTopLevelNode() {
     if (isCommentToken(currentToken_.type)) {
         // Create a CommentNode AST node from the current token.
         Token commentT = currentToken_; // Copy the token.
-        return std::make_unique<CommentNode>(std::move(commentT));
+        return makeNode<CommentNode>(commentT.offset, std::move(commentT));
     }
     else {
         // If it's not a comment, try to parse it as a regular statement.
@@ -144,6 +139,9 @@ std::unique_ptr<Statement> Parser::parseStatement() {
     if (currentTokenIs(PRINT)) {
         return parsePrintStatement();
     }
+    else if (currentTokenIs(ASM)) {
+        return parseAsmStatement();
+    }
     else if (currentTokenIs(IDENTIFIER) && peekTokenIs(ASSIGN)) {
         return parseAssignmentStatement();
     }
@@ -154,14 +152,14 @@ std::unique_ptr<Statement> Parser::parseStatement() {
 
 std::unique_ptr<Expression> Parser::parseBooleanLiteral() {
     bool val = (currentToken_.type == TRUE);
-    auto expr = std::make_unique<BooleanLiteral>(val);
+    auto expr = makeNode<BooleanLiteral>(currentToken_.offset, val);
     expr->resolvedType = BOOL;
-    nextToken();
     return expr;
 }
 
 std::unique_ptr<AssignmentStatement> Parser::parseAssignmentStatement() {
-    auto identifier_expr = std::make_unique<IdentifierExpr>(currentToken_.literal);
+    uint32_t offset = currentToken_.offset;
+    auto identifier_expr = makeNode<IdentifierExpr>(offset, currentToken_.literal);
 
     if (!expectPeek(ASSIGN)) {
         return nullptr;
@@ -180,10 +178,114 @@ std::unique_ptr<AssignmentStatement> Parser::parseAssignmentStatement() {
         nextToken(); // Consume the semicolon.
     }
 
-    return std::make_unique<AssignmentStatement>(std::move(identifier_expr), std::move(value_expr));
+    return makeNode<AssignmentStatement>(offset, std::move(identifier_expr), std::move(value_expr));
+}
+
+// @max_stack(N) [;]  A file compiles to one function, so the annotation applies to the program.
+bool Parser::parseProgramAnnotation(Program& program) {
+    if (currentToken_.literal != "max_stack") {
+        errors_.push_back({ DIAG_UNKNOWN_ANNOTATION, currentToken_.offset, ILLEGAL, ILLEGAL, currentToken_.literal });
+        return false;
+    }
+    uint32_t offset = currentToken_.offset;
+    if (!expectPeek(LPAREN) || !expectPeek(INT)) {
+        return false;
+    }
+    int64_t limit = std::strtoll(currentToken_.literal.c_str(), nullptr, 10);
+    if (!expectPeek(RPAREN)) {
+        return false;
+    }
+    if (peekTokenIs(SEMICOLON)) {
+        nextToken();
+    }
+    program.maxStack = limit;
+    program.maxStackOffset = offset;
+    return true;
+}
+
+// asm_ [@volatile] { "line"... [: outputs [: inputs [: clobbers]]] } [;]
+std::unique_ptr<AsmStatement> Parser::parseAsmStatement() {
+    auto node = makeNode<AsmStatement>(currentToken_.offset);
+    while (peekTokenIs(ANNOTATION)) {
+        nextToken();
+        if (currentToken_.literal != "volatile") {
+            errors_.push_back({ DIAG_UNKNOWN_ANNOTATION, currentToken_.offset, ILLEGAL, ILLEGAL, currentToken_.literal });
+            return nullptr;
+        }
+        node->isVolatile = true;
+    }
+    if (!expectPeek(LBRACE)) {
+        return nullptr;
+    }
+    while (peekTokenIs(STRING)) {
+        nextToken();
+        node->lines.push_back(currentToken_.literal);
+    }
+
+    // Each section is optional; an empty one is just its ':'.
+    for (int section = 0; section < 3 && peekTokenIs(COLON); ++section) {
+        nextToken();
+        if (section < 2) {
+            if (!parseAsmOperands(section == 0 ? node->outputs : node->inputs, section == 0)) {
+                return nullptr;
+            }
+            continue;
+        }
+        while (peekTokenIs(STRING)) {
+            nextToken();
+            node->clobbers.push_back(currentToken_.literal);
+            if (!peekTokenIs(COMMA)) break;
+            nextToken();
+        }
+    }
+    if (!expectPeek(RBRACE)) {
+        return nullptr;
+    }
+    if (peekTokenIs(SEMICOLON)) {
+        nextToken();
+    }
+    return node;
+}
+
+// "constraint"(expr), ...  Outputs must name a variable.
+bool Parser::parseAsmOperands(std::vector<AsmOperand>& operands, bool outputs) {
+    if (!peekTokenIs(STRING)) {
+        return true; // Empty section
+    }
+    do {
+        if (!operands.empty()) {
+            nextToken(); // Consume ','
+        }
+        if (!expectPeek(STRING)) {
+            return false;
+        }
+        AsmOperand operand{ currentToken_.literal, nullptr };
+        if (!expectPeek(LPAREN)) {
+            return false;
+        }
+        if (outputs) {
+            if (!expectPeek(IDENTIFIER)) {
+                return false;
+            }
+            operand.expression = parseIdentifier();
+        }
+        else {
+            nextToken();
+            operand.expression = parseExpression(LOWEST);
+            if (!operand.expression) {
+                return false;
+            }
+        }
+        if (!expectPeek(RPAREN)) {
+            return false;
+        }
+        operands.push_back(std::move(operand));
+    } while (peekTokenIs(COMMA));
+    return true;
 }
 
 std::unique_ptr<ExpressionStatement> Parser::parseExpressionStatement() {
+    uint32_t offset = currentToken_.offset;
     auto expr = parseExpression(LOWEST);
     if (!expr) {
         return nullptr;
@@ -193,50 +295,32 @@ std::unique_ptr<ExpressionStatement> Parser::parseExpressionStatement() {
         nextToken(); // Consume the semicolon.
     }
 
-    return std::make_unique<ExpressionStatement>(std::move(expr));
+    return makeNode<ExpressionStatement>(offset, std::move(expr));
 }
 
 Precedence Parser::peekPrecedence() const {
-    auto it = precedences.find(peekToken_.type);
-    if (it != precedences.end()) {
-        return it->second;
-    }
-    return LOWEST;
+    return precedences[peekToken_.type];
 }
 
 Precedence Parser::currentPrecedence() const {
-    auto it = precedences.find(currentToken_.type);
-    if (it != precedences.end()) {
-        return it->second;
-    }
-    return LOWEST;
+    return precedences[currentToken_.type];
 }
 
 std::unique_ptr<Expression> Parser::parseExpression(Precedence prec) {
-    PrefixParseFn prefix_fn = nullptr;
-    auto prefix_it = prefixParseFns.find(currentToken_.type);
-    if (prefix_it != prefixParseFns.end()) {
-        prefix_fn = prefix_it->second;
-    }
-
+    PrefixParseFn prefix_fn = prefixParseFns[currentToken_.type];
     if (prefix_fn == nullptr) {
-        errors_.push_back("No prefix parse function for " + tokenTypeStrings.at(currentToken_.type) +
-            " (" + currentToken_.literal + ") found.");
+        errors_.push_back({ DIAG_NO_PREFIX_PARSE, currentToken_.offset, currentToken_.type, ILLEGAL, currentToken_.literal });
         return nullptr;
     }
 
     std::unique_ptr<Expression> left_expr = (this->*prefix_fn)();
     if (!left_expr) return nullptr;
 
-    // Loop for infix operators. `peekTokenIs(SEMICOLON) == false` ensures we stop at statement end.
-    // `prec < peekPrecedence()` ensures we respect operator precedence.
-    while (!peekTokenIs(SEMICOLON) && prec < peekPrecedence()) {
-        InfixParseFn infix_fn = nullptr;
-        auto infix_it = infixParseFns.find(peekToken_.type);
-        if (infix_it != infixParseFns.end()) {
-            infix_fn = infix_it->second;
-        }
-
+    // Loop for infix operators. Tokens that are not infix operators (including ';')
+    // have LOWEST precedence, so `prec < peekPrecedence()` both respects operator
+    // precedence and stops at the end of the expression.
+    while (prec < peekPrecedence()) {
+        InfixParseFn infix_fn = infixParseFns[peekToken_.type];
         if (infix_fn == nullptr) {
             // If the next token isn't an infix operator, stop parsing this expression.
             return left_expr;
@@ -255,6 +339,7 @@ std::unique_ptr<Expression> Parser::parseExpression(Precedence prec) {
 
 std::unique_ptr<PrintStatement> Parser::parsePrintStatement() {
     // Current token is PRINT. Consume it. `nextToken` skips comments after PRINT.
+    uint32_t offset = currentToken_.offset;
     nextToken();
 
     std::unique_ptr<Expression> expr = parseExpression(LOWEST);
@@ -262,12 +347,12 @@ std::unique_ptr<PrintStatement> Parser::parsePrintStatement() {
         return nullptr;
     }
 
-    // Expect a semicolon. `expectPeek` handles consuming SEMICOLON and skipping comments before it.
+    // Consume an optional terminating semicolon.
     if (peekTokenIs(SEMICOLON)) {
         nextToken();
     }
 
-    return std::make_unique<PrintStatement>(std::move(expr));
+    return makeNode<PrintStatement>(offset, std::move(expr));
 }
 
 std::unique_ptr<Expression> Parser::parseIntegerLiteral() {
@@ -279,29 +364,26 @@ std::unique_ptr<Expression> Parser::parseIntegerLiteral() {
     char* endPtr = nullptr;
     long val = std::strtol(lit.c_str(), &endPtr, base);
 
-    auto expr = std::make_unique<IntegerLiteral>(static_cast<int>(val));
-    expr->resolvedType = currentToken_.type;
-    nextToken();
+    auto expr = makeNode<IntegerLiteral>(currentToken_.offset, static_cast<int>(val));
+    expr->resolvedType = INT;
     return expr;
 }
 
 std::unique_ptr<Expression> Parser::parseStringLiteral() {
-    auto expr = std::make_unique<StringLiteral>(currentToken_.literal);
+    auto expr = makeNode<StringLiteral>(currentToken_.offset, currentToken_.literal);
     expr->resolvedType = STRING;
-    nextToken();
     return expr;
 }
 
 std::unique_ptr<Expression> Parser::parseCharLiteral() {
     char c = currentToken_.literal.empty() ? '\0' : currentToken_.literal[0];
-    auto expr = std::make_unique<CharLiteral>(c);
+    auto expr = makeNode<CharLiteral>(currentToken_.offset, c);
     expr->resolvedType = CHAR;
-    nextToken();
     return expr;
 }
 
 std::unique_ptr<Expression> Parser::parseIdentifier() {
-    return std::make_unique<IdentifierExpr>(currentToken_.literal);
+    return makeNode<IdentifierExpr>(currentToken_.offset, currentToken_.literal);
 }
 
 std::unique_ptr<Expression> Parser::parseGroupedExpression() {
@@ -320,8 +402,24 @@ std::unique_ptr<Expression> Parser::parseGroupedExpression() {
     return expr;
 }
 
+std::unique_ptr<Expression> Parser::parsePrefixExpression() {
+    TokenType op_type = currentToken_.type;
+    uint32_t offset = currentToken_.offset;
+
+    // Consume the operator; the operand binds tighter than any binary operator.
+    nextToken();
+
+    std::unique_ptr<Expression> operand = parseExpression(PREFIX);
+    if (!operand) {
+        return nullptr;
+    }
+
+    return makeNode<UnaryExpression>(offset, op_type, std::move(operand));
+}
+
 std::unique_ptr<Expression> Parser::parseInfixExpression(std::unique_ptr<Expression> left_expr) {
     TokenType op_type = currentToken_.type;
+    uint32_t offset = currentToken_.offset;
     Precedence prec = currentPrecedence();
 
     // Consume the operator. `nextToken` skips comments after the operator.
@@ -332,29 +430,187 @@ std::unique_ptr<Expression> Parser::parseInfixExpression(std::unique_ptr<Express
         return nullptr;
     }
 
-    return std::make_unique<BinaryExpression>(std::move(left_expr), op_type, std::move(right_expr));
+    return makeNode<BinaryExpression>(offset, std::move(left_expr), op_type, std::move(right_expr));
+}
+
+std::unique_ptr<Expression> Parser::parseCallExpression(std::unique_ptr<Expression> callee) {
+    // Current token is LPAREN. Only named functions can be called.
+    auto* name = dynamic_cast<IdentifierExpr*>(callee.get());
+    if (!name) {
+        errors_.push_back({ DIAG_NOT_CALLABLE, currentToken_.offset });
+        return nullptr;
+    }
+
+    std::vector<std::unique_ptr<Expression>> arguments;
+    if (peekTokenIs(RPAREN)) {
+        nextToken();
+        return makeNode<CallExpression>(name->offset, std::move(name->name), std::move(arguments));
+    }
+
+    while (true) {
+        nextToken(); // Step onto the first token of the argument (past '(' or ',').
+        std::unique_ptr<Expression> arg = parseExpression(LOWEST);
+        if (!arg) {
+            return nullptr;
+        }
+        arguments.push_back(std::move(arg));
+
+        if (!peekTokenIs(COMMA)) {
+            break;
+        }
+        nextToken();
+    }
+
+    if (!expectPeek(RPAREN)) {
+        return nullptr;
+    }
+    return makeNode<CallExpression>(name->offset, std::move(name->name), std::move(arguments));
+}
+
+std::unique_ptr<Expression> Parser::parseMemberAccessExpression(std::unique_ptr<Expression> object) {
+    // Current token is ARROW; the member name must follow.
+    uint32_t offset = currentToken_.offset;
+    if (!expectPeek(IDENTIFIER)) {
+        return nullptr;
+    }
+    return makeNode<MemberAccessExpression>(offset, std::move(object), currentToken_.literal);
+}
+
+std::unique_ptr<Expression> Parser::parseConditionalExpression(std::unique_ptr<Expression> condition) {
+    // Current token is QUESTION.
+    uint32_t offset = currentToken_.offset;
+    nextToken();
+    std::unique_ptr<Expression> then_expr = parseExpression(LOWEST);
+    if (!then_expr) {
+        return nullptr;
+    }
+
+    if (!expectPeek(COLON)) {
+        return nullptr;
+    }
+    nextToken();
+
+    // Parsing the else branch at LOWEST makes `?:` right-associative.
+    std::unique_ptr<Expression> else_expr = parseExpression(LOWEST);
+    if (!else_expr) {
+        return nullptr;
+    }
+
+    return makeNode<ConditionalExpression>(offset, std::move(condition), std::move(then_expr), std::move(else_expr));
 }
 
-void Parser::registerPrefix(TokenType token_type, PrefixParseFn fn) {
-    prefixParseFns[token_type] = fn;
+// match subject { pattern [, pattern]... => value, ..., _ => value }
+// A pattern is an integer or an inclusive range lo..hi; `_` matches anything.
+std::unique_ptr<Expression> Parser::parseMatchExpression() {
+    // Current token is MATCH.
+    uint32_t offset = currentToken_.offset;
+    nextToken();
+    std::unique_ptr<Expression> subject = parseExpression(LOWEST);
+    if (!subject) {
+        return nullptr;
+    }
+    if (!expectPeek(LBRACE)) {
+        return nullptr;
+    }
+
+    std::vector<MatchArm> arms;
+    while (!peekTokenIs(RBRACE)) {
+        nextToken();
+        MatchArm arm;
+        arm.offset = currentToken_.offset;
+        if (!(currentTokenIs(IDENTIFIER) && currentToken_.literal == "_")) {
+            while (true) {
+                int lo = 0;
+                int hi = 0;
+                if (!parseMatchValue(lo)) {
+                    return nullptr;
+                }
+                hi = lo;
+                if (peekTokenIs(DOTDOT)) {
+                    nextToken();
+                    nextToken();
+                    if (!parseMatchValue(hi)) {
+                        return nullptr;
+                    }
+                }
+                arm.ranges.push_back({ lo, hi });
+                if (!peekTokenIs(COMMA)) {
+                    break;
+                }
+                nextToken();
+                nextToken();
+            }
+        }
+        if (!expectPeek(FAT_ARROW)) {
+            return nullptr;
+        }
+        nextToken();
+        arm.value = parseExpression(LOWEST);
+        if (!arm.value) {
+            return nullptr;
+        }
+        arms.push_back(std::move(arm));
+
+        // Arms are separated by ','; one after the last arm is allowed.
+        if (!peekTokenIs(COMMA)) {
+            break;
+        }
+        nextToken();
+    }
+    if (!expectPeek(RBRACE)) {
+        return nullptr;
+    }
+    return makeNode<MatchExpression>(offset, std::move(subject), std::move(arms));
 }
 
-void Parser::registerInfix(TokenType token_type, InfixParseFn fn) {
-    infixParseFns[token_type] = fn;
+// An integer literal, optionally negated; currentToken_ ends on the literal.
+bool Parser::parseMatchValue(int& value) {
+    bool negative = currentTokenIs(MINUS);
+    if (negative) {
+        nextToken();
+    }
+    if (!currentTokenIs(INT) && !currentTokenIs(HEX) && !currentTokenIs(OCTAL)) {
+        errors_.push_back({ DIAG_EXPECTED_TOKEN, currentToken_.offset, INT, currentToken_.type, currentToken_.literal });
+        return false;
+    }
+    value = static_cast<IntegerLiteral*>(parseIntegerLiteral().get())->value;
+    if (negative) {
+        value = static_cast<int>(-static_cast<int64_t>(value));
+    }
+    return true;
 }
 
-void Parser::setupParseFunctions() {
-    registerPrefix(INT, &Parser::parseIntegerLiteral);
-    registerPrefix(IDENTIFIER, &Parser::parseIdentifier);
-    registerPrefix(LPAREN, &Parser::parseGroupedExpression);
-    registerPrefix(TRUE, &Parser::parseBooleanLiteral);
-    registerPrefix(FALSE, &Parser::parseBooleanLiteral);
-    registerPrefix(STRING, &Parser::parseStringLiteral);
-    registerPrefix(CHAR, &Parser::parseCharLiteral);
+// --- Dispatch tables ---
+
+constexpr std::array<Parser::PrefixParseFn, TOKEN_TYPE_COUNT> Parser::makePrefixTable() {
+    std::array<PrefixParseFn, TOKEN_TYPE_COUNT> table{};
+    table[INT]        = &Parser::parseIntegerLiteral;
+    table[HEX]        = &Parser::parseIntegerLiteral;
+    table[OCTAL]      = &Parser::parseIntegerLiteral;
+    table[IDENTIFIER] = &Parser::parseIdentifier;
+    table[LPAREN]     = &Parser::parseGroupedExpression;
+    table[TRUE]       = &Parser::parseBooleanLiteral;
+    table[FALSE]      = &Parser::parseBooleanLiteral;
+    table[STRING]     = &Parser::parseStringLiteral;
+    table[CHAR]       = &Parser::parseCharLiteral;
+    table[MINUS]      = &Parser::parsePrefixExpression;
+    table[PLUS]       = &Parser::parsePrefixExpression;
+    table[BANG]       = &Parser::parsePrefixExpression;
+    table[ASTERISK]   = &Parser::parsePrefixExpression;
+    table[MATCH]      = &Parser::parseMatchExpression;
+    return table;
+}
+
+constexpr std::array<Parser::InfixParseFn, TOKEN_TYPE_COUNT> Parser::makeInfixTable() {
+    std::array<InfixParseFn, TOKEN_TYPE_COUNT> table{};
+    for (TokenType op : { OR, AND, EQ, NOT_EQ, LT, GT, LT_EQ, GT_EQ, PLUS, MINUS, ASTERISK, SLASH, PERCENT }) {
+        table[op] = &Parser::parseInfixExpression;
+    }
+    table[LPAREN]   = &Parser::parseCallExpression;
+    table[ARROW]    = &Parser::parseMemberAccessExpression;
+    table[QUESTION] = &Parser::parseConditionalExpression;
+    return table;
+}
 
-    registerInfix(PLUS, &Parser::parseInfixExpression);
-    registerInfix(MINUS, &Parser::parseInfixExpression);
-    registerInfix(ASTERISK, &Parser::parseInfixExpression);
-    registerInfix(SLASH, &Parser::parseInfixExpression);
-    registerInfix(ASSIGN, &Parser::parseInfixExpression);
-}
\ No newline at end of file
+constexpr std::array<Parser::PrefixParseFn, TOKEN_TYPE_COUNT> Parser::prefixParseFns = Parser::makePrefixTable();
+constexpr std::array<Parser::InfixParseFn, TOKEN_TYPE_COUNT> Parser::infixParseFns = Parser::makeInfixTable();
@@ -3,23 +3,51 @@
 #include <vector>
 #include <string>
 #include <memory> 
-#include <unordered_map>
+#include <array>
 #include <sstream>
 
 #include "Lexer.h"
 #include "Token.h"
 #include "ast.h"
+#include "diagnostics.h"
 
 // Define operator precedences (higher value means higher precedence)
 enum Precedence {
     LOWEST = 1,
-    SUM = 2, // + -
-    PRODUCT = 3, // * /
-    ASSIGN_PRECEDENCE = 4 // For handling assignment operator
+    CONDITIONAL,  // ?:
+    LOGICAL_OR,   // ||
+    LOGICAL_AND,  // &&
+    EQUALS,       // == !=
+    LESSGREATER,  // < > <= >=
+    SUM,          // + -
+    PRODUCT,      // * / %
+    PREFIX,       // -x !x *x
+    CALL          // f(x) a->b
 };
 
-// Map to store operator precedences
-extern const std::unordered_map<TokenType, Precedence> precedences;
+// Infix precedence of every token kind, indexed by TokenType. Tokens that are not
+// infix operators map to LOWEST, which also terminates the Pratt loop.
+inline constexpr std::array<Precedence, TOKEN_TYPE_COUNT> precedences = [] {
+    std::array<Precedence, TOKEN_TYPE_COUNT> table{};
+    table.fill(LOWEST);
+    table[QUESTION] = CONDITIONAL;
+    table[OR]       = LOGICAL_OR;
+    table[AND]      = LOGICAL_AND;
+    table[EQ]       = EQUALS;
+    table[NOT_EQ]   = EQUALS;
+    table[LT]       = LESSGREATER;
+    table[GT]       = LESSGREATER;
+    table[LT_EQ]    = LESSGREATER;
+    table[GT_EQ]    = LESSGREATER;
+    table[PLUS]     = SUM;
+    table[MINUS]    = SUM;
+    table[ASTERISK] = PRODUCT;
+    table[SLASH]    = PRODUCT;
+    table[PERCENT]  = PRODUCT;
+    table[LPAREN]   = CALL;
+    table[ARROW]    = CALL;
+    return table;
+}();
 
 class Parser {
 public:
@@ -27,13 +55,13 @@ public:
 
     std::unique_ptr<Program> parseProgram();
     std::unique_ptr<ASTNode> parseTopLevelNode();
-    std::vector<std::string> getErrors() const;
+    const std::vector<Diagnostic>& getErrors() const;
 
 private:
     Lexer& lexer_;
     Token currentToken_;
     Token peekToken_; // Lookahead token
-    std::vector<std::string> errors_;
+    std::vector<Diagnostic> errors_;
 
     // --- Utility Methods for Token Stream ---
     void nextToken(); // Advances currentToken and fills peekToken
@@ -42,16 +70,30 @@ private:
     bool expectPeek(TokenType type); // Checks peekToken, advances, and logs error if mismatch
 
     bool isCommentToken(TokenType type) const;
+    void synchronize(); // Skips to the next statement after a parse error
 
     // --- Error Handling ---
     void peekError(TokenType type);
 
+    // Creates an AST node located at `offset`.
+    template <typename T, typename... Args>
+    static std::unique_ptr<T> makeNode(uint32_t offset, Args&&... args) {
+        auto node = std::make_unique<T>(std::forward<Args>(args)...);
+        node->offset = offset;
+        return node;
+    }
+
     // --- Main Parsing Methods ---
     std::unique_ptr<Statement> parseStatement();
     std::unique_ptr<AssignmentStatement> parseAssignmentStatement();
     std::unique_ptr<ExpressionStatement> parseExpressionStatement();
+    std::unique_ptr<AsmStatement> parseAsmStatement();
+    bool parseProgramAnnotation(Program& program);
+    bool parseAsmOperands(std::vector<AsmOperand>& operands, bool outputs);
 
     // --- Expression Parsing (using Operator Precedence Climbing / Pratt Parsing) ---
+    // Every parse function is entered with currentToken_ on the first token of its
+    // construct and returns with currentToken_ on the last one.
     std::unique_ptr<Expression> parseExpression(Precedence prec);
     std::unique_ptr<Expression> parseIntegerLiteral();
     std::unique_ptr<Expression> parseIdentifier();
@@ -60,8 +102,13 @@ private:
     std::unique_ptr<Expression> parseCharLiteral();
     std::unique_ptr<PrintStatement> parsePrintStatement();
     std::unique_ptr<Expression> parseBooleanLiteral();
-    std::unique_ptr<Expression> parsePrefixExpression(); // Handles INT, IDENTIFIER, LPAREN prefix
+    std::unique_ptr<Expression> parsePrefixExpression(); // Handles unary - + ! *
     std::unique_ptr<Expression> parseInfixExpression(std::unique_ptr<Expression> left_expr); // Handles binary ops
+    std::unique_ptr<Expression> parseCallExpression(std::unique_ptr<Expression> callee);
+    std::unique_ptr<Expression> parseMemberAccessExpression(std::unique_ptr<Expression> object);
+    std::unique_ptr<Expression> parseConditionalExpression(std::unique_ptr<Expression> condition);
+    std::unique_ptr<Expression> parseMatchExpression();
+    bool parseMatchValue(int& value);
 
     Precedence peekPrecedence() const;
     Precedence currentPrecedence() const;
@@ -69,11 +116,11 @@ private:
     using PrefixParseFn = std::unique_ptr<Expression>(Parser::*)();
     using InfixParseFn = std::unique_ptr<Expression>(Parser::*)(std::unique_ptr<Expression>);
 
-    std::unordered_map<TokenType, PrefixParseFn> prefixParseFns;
-    std::unordered_map<TokenType, InfixParseFn> infixParseFns;
-
-    void registerPrefix(TokenType token_type, PrefixParseFn fn);
-    void registerInfix(TokenType token_type, InfixParseFn fn);
+    // Dispatch tables indexed by TokenType; nullptr where a token cannot start
+    // (prefix) or continue (infix) an expression.
+    static const std::array<PrefixParseFn, TOKEN_TYPE_COUNT> prefixParseFns;
+    static const std::array<InfixParseFn, TOKEN_TYPE_COUNT> infixParseFns;
 
-    void setupParseFunctions(); 
+    static constexpr std::array<PrefixParseFn, TOKEN_TYPE_COUNT> makePrefixTable();
+    static constexpr std::array<InfixParseFn, TOKEN_TYPE_COUNT> makeInfixTable();
 };
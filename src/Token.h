@@ -1,7 +1,8 @@
 ﻿#pragma once
 
 #include <string>
-#include <map>
+#include <cstdint>
+#include <iterator>
 
 enum TokenType {
     ILLEGAL,
@@ -25,19 +26,57 @@ enum TokenType {
     COLON,
     LPAREN,
     RPAREN,
+    COMMA,
+    PERCENT,
+    BANG,
+    EQ,
+    NOT_EQ,
+    LT,
+    GT,
+    LT_EQ,
+    GT_EQ,
+    AND,
+    OR,
+    ARROW,
+    QUESTION,
+    LBRACE,
+    RBRACE,
+    ANNOTATION, // @name; the literal is the name
+    FAT_ARROW,
+    DOTDOT,
 
     PRINT,
     TRUE,
     FALSE,
+    ASM,
+    MATCH,
 
     COMMENT_MULTI_LINE,
-    COMMENT_SINGLE_LINE
+    COMMENT_SINGLE_LINE,
+
+    TOKEN_TYPE_COUNT // Number of token kinds; sizes tables indexed by TokenType
+};
+
+// Printable name of every token kind, in TokenType order.
+inline constexpr const char* tokenTypeNames[] = {
+    "ILLEGAL", "EOF", "IDENTIFIER",
+    "INT", "FLOAT", "STRING", "OCTAL", "HEX", "CHAR", "BOOL",
+    "ASSIGN", "PLUS", "MINUS", "ASTERISK", "SLASH", "SEMICOLON", "COLON", "LPAREN", "RPAREN",
+    "COMMA", "PERCENT", "BANG", "EQ", "NOT_EQ", "LT", "GT", "LT_EQ", "GT_EQ", "AND", "OR", "ARROW", "QUESTION",
+    "LBRACE", "RBRACE", "ANNOTATION", "FAT_ARROW", "DOTDOT",
+    "PRINT", "TRUE", "FALSE", "ASM", "MATCH",
+    "COMMENT_MULTI_LINE", "COMMENT_SINGLE_LINE",
 };
-extern const std::map<TokenType, std::string> tokenTypeStrings;
+static_assert(std::size(tokenTypeNames) == TOKEN_TYPE_COUNT, "tokenTypeNames is out of sync with TokenType");
+
+constexpr const char* tokenTypeName(TokenType type) {
+    return (type >= 0 && type < TOKEN_TYPE_COUNT) ? tokenTypeNames[type] : "UNKNOWN_TOKEN_TYPE";
+}
 
 struct Token {
 	TokenType type;
 	std::string literal;
+	uint32_t offset = 0; // Byte offset of the first character in the source
 
 	std::string toString() const;
 };
\ No newline at end of file
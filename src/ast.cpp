@@ -9,8 +9,14 @@ void BooleanLiteral::accept(ASTVisitor& visitor) { visitor.visit(*this); }
 void ExpressionStatement::accept(ASTVisitor& visitor) { visitor.visit(*this); }
 void AssignmentStatement::accept(ASTVisitor& visitor) { visitor.visit(*this); }
 void PrintStatement::accept(ASTVisitor& visitor) { visitor.visit(*this); }
+void AsmStatement::accept(ASTVisitor& visitor) { visitor.visit(*this); }
 void CommentNode::accept(ASTVisitor& visitor) { visitor.visit(*this); }
 void CharLiteral::accept(ASTVisitor& visitor) {
 	visitor.visit(*this);
 }
-void StringLiteral::accept(ASTVisitor& visitor) { visitor.visit(*this); }
\ No newline at end of file
+void StringLiteral::accept(ASTVisitor& visitor) { visitor.visit(*this); }
+void UnaryExpression::accept(ASTVisitor& visitor) { visitor.visit(*this); }
+void ConditionalExpression::accept(ASTVisitor& visitor) { visitor.visit(*this); }
+void MatchExpression::accept(ASTVisitor& visitor) { visitor.visit(*this); }
+void CallExpression::accept(ASTVisitor& visitor) { visitor.visit(*this); }
+void MemberAccessExpression::accept(ASTVisitor& visitor) { visitor.visit(*this); }
\ No newline at end of file
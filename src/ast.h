@@ -1,8 +1,10 @@
 ﻿#pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
+#include <utility>
 #include "Token.h"
 
 class ASTVisitor;
@@ -12,6 +14,8 @@ class ASTNode {
 public:
     virtual ~ASTNode() = default;
 
+    uint32_t offset = 0; // Source offset of the token the node is reported at
+
     virtual void accept(ASTVisitor& visitor) = 0;
 };
 
@@ -52,12 +56,15 @@ public:
     void accept(ASTVisitor& visitor) override;
 };
 
+// Slot of an identifier the semantic analyzer has not resolved.
+constexpr uint32_t kNoSlot = UINT32_MAX;
+
 // Identifier expression  e.g.  foo
 class IdentifierExpr : public Expression {
 public:
     explicit IdentifierExpr(std::string n) : name(std::move(n)) {}
     std::string name;
-    TokenType resolvedType = ILLEGAL;
+    uint32_t slot = kNoSlot; // Dense index of the variable, numbered by the semantic analyzer in definition order
     void accept(ASTVisitor& visitor) override;
 };
 
@@ -86,6 +93,77 @@ public:
     void accept(ASTVisitor& visitor) override;
 };
 
+// Prefix operator  e.g.  -a   !done   *ptr
+class UnaryExpression : public Expression {
+public:
+    UnaryExpression(TokenType o, std::unique_ptr<Expression> r)
+        : op(o), operand(std::move(r)) {
+    }
+
+    TokenType                   op;
+    std::unique_ptr<Expression> operand;
+    void accept(ASTVisitor& visitor) override;
+};
+
+// Ternary  e.g.  a < b ? a : b
+class ConditionalExpression : public Expression {
+public:
+    ConditionalExpression(std::unique_ptr<Expression> c,
+        std::unique_ptr<Expression> t,
+        std::unique_ptr<Expression> e)
+        : condition(std::move(c)), thenExpr(std::move(t)), elseExpr(std::move(e)) {
+    }
+
+    std::unique_ptr<Expression> condition;
+    std::unique_ptr<Expression> thenExpr;
+    std::unique_ptr<Expression> elseExpr;
+    void accept(ASTVisitor& visitor) override;
+};
+
+// One arm of a match  e.g.  1, 4..7 => x + 1   or   _ => 0
+struct MatchArm {
+    std::vector<std::pair<int, int>> ranges; // Inclusive value ranges; empty for the `_` arm
+    std::unique_ptr<Expression>      value;
+    uint32_t                         offset = 0;
+};
+
+// Multi-way selection on an integer  e.g.  match op { 0 => a, 1..3 => b, _ => c }
+// The first arm containing the subject's value is taken; `_` comes last.
+class MatchExpression : public Expression {
+public:
+    MatchExpression(std::unique_ptr<Expression> s, std::vector<MatchArm> a)
+        : subject(std::move(s)), arms(std::move(a)) {
+    }
+
+    std::unique_ptr<Expression> subject;
+    std::vector<MatchArm>       arms;
+    void accept(ASTVisitor& visitor) override;
+};
+
+// Function call  e.g.  max(a, b)
+class CallExpression : public Expression {
+public:
+    CallExpression(std::string c, std::vector<std::unique_ptr<Expression>> args)
+        : callee(std::move(c)), arguments(std::move(args)) {
+    }
+
+    std::string                              callee;
+    std::vector<std::unique_ptr<Expression>> arguments;
+    void accept(ASTVisitor& visitor) override;
+};
+
+// Member access  e.g.  player->health
+class MemberAccessExpression : public Expression {
+public:
+    MemberAccessExpression(std::unique_ptr<Expression> o, std::string m)
+        : object(std::move(o)), member(std::move(m)) {
+    }
+
+    std::unique_ptr<Expression> object;
+    std::string                 member;
+    void accept(ASTVisitor& visitor) override;
+};
+
 // ─────────────────── Statements ──────────────────
 class Statement : public ASTNode {};
 
@@ -121,6 +199,24 @@ public:
     void accept(ASTVisitor& visitor) override;
 };
 
+// One operand of an asm_ block  e.g.  "=r"(x)   "r"(a + 1)
+struct AsmOperand {
+    std::string                 constraint;
+    std::unique_ptr<Expression> expression; // An IdentifierExpr for outputs
+};
+
+// Inline assembly  e.g.  asm_ @volatile { "imul %0, %1" : "+r"(x) : "r"(y) : "rdx" };
+// Operands are numbered outputs first, then inputs, as in GCC.
+class AsmStatement : public Statement {
+public:
+    std::vector<std::string> lines;    // Template, one instruction per string
+    std::vector<AsmOperand>  outputs;
+    std::vector<AsmOperand>  inputs;
+    std::vector<std::string> clobbers; // Register names, "cc" or "memory"
+    bool                     isVolatile = false; // Kept even when no output is read
+    void accept(ASTVisitor& visitor) override;
+};
+
 // ─────────────────── Program root ────────────────
 class Program : public ASTNode {
 public:
@@ -128,5 +224,8 @@ public:
         statements.emplace_back(std::move(stmt));
     }
     std::vector<std::unique_ptr<Statement>> statements;
+    int64_t  maxStack = -1;     // @max_stack(N): worst-case stack bytes allowed, -1 if not annotated
+    uint32_t maxStackOffset = 0;
+    uint32_t slotCount = 0;     // Variables the semantic analyzer numbered; every IdentifierExpr::slot is below it
     void accept(ASTVisitor& visitor) override;
 };
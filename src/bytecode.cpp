@@ -0,0 +1,248 @@
+// bytecode.cpp
+#include "bytecode.h"
+#include "match_lowering.h"
+
+#include <algorithm>
+
+// --- Compiler ---
+
+bool BytecodeCompiler::compile(const Program* program, Chunk& out) {
+    out = Chunk{};
+    chunk_ = &out;
+    defined_.assign(program->slotCount, false);
+    errors_.clear();
+    depth_ = 0;
+
+    for (const auto& stmt : program->statements) {
+        compileStatement(stmt.get());
+    }
+    emit(OP_HALT);
+    out.slotCount = program->slotCount;
+    chunk_ = nullptr;
+    return errors_.empty();
+}
+
+void BytecodeCompiler::error(const std::string& msg) {
+    errors_.push_back({ DIAG_CODEGEN, currentOffset_, ILLEGAL, ILLEGAL, msg });
+}
+
+size_t BytecodeCompiler::emit(OpCode op, int64_t operand) {
+    // Track the operand stack depth so the interpreter can size its stack up front.
+    switch (op) {
+    case OP_CONST: case OP_LOAD:
+        ++depth_;
+        break;
+    case OP_STORE: case OP_POP: case OP_JUMP_IF_FALSE: case OP_MATCH: case OP_PRINT_INT: case OP_PRINT_BOOL:
+    case OP_ADD: case OP_SUB: case OP_MUL: case OP_DIV: case OP_MOD:
+    case OP_EQ: case OP_NOT_EQ: case OP_LT: case OP_GT: case OP_LT_EQ: case OP_GT_EQ:
+        --depth_;
+        break;
+    default:
+        break;
+    }
+    chunk_->maxStack = std::max(chunk_->maxStack, depth_);
+    chunk_->code.push_back({ op, operand });
+    return chunk_->code.size() - 1;
+}
+
+void BytecodeCompiler::compileStatement(const Statement* node) {
+    currentOffset_ = node->offset;
+    if (auto assign = dynamic_cast<const AssignmentStatement*>(node)) {
+        compileExpression(assign->value.get());
+        const IdentifierExpr* target = assign->identifier.get();
+        if (target->slot >= defined_.size()) {
+            // Every variable is numbered by semantic analysis before bytecode is compiled.
+            error("Internal Codegen Error: Variable '" + target->name + "' has no slot; was the program analyzed?");
+            return;
+        }
+        defined_[target->slot] = true;
+        emit(OP_STORE, static_cast<int64_t>(target->slot));
+    }
+    else if (auto exprStmt = dynamic_cast<const ExpressionStatement*>(node)) {
+        compileExpression(exprStmt->expression.get());
+        emit(OP_POP);
+    }
+    else if (auto print = dynamic_cast<const PrintStatement*>(node)) {
+        compileExpression(print->expression.get());
+        TokenType type = print->expression->resolvedType;
+        if (type == INT) {
+            emit(OP_PRINT_INT);
+        }
+        else if (type == BOOL) {
+            emit(OP_PRINT_BOOL);
+        }
+        else {
+            error("Attempting to print an unsupported type (TokenType: " + std::string(tokenTypeName(type)) + ").");
+        }
+    }
+    else if (auto block = dynamic_cast<const AsmStatement*>(node)) {
+        error("asm_ blocks only run as native code; compile with --emit=asm or --emit=obj.");
+        for (const auto& output : block->outputs) {
+            uint32_t slot = static_cast<const IdentifierExpr*>(output.expression.get())->slot;
+            if (slot < defined_.size()) defined_[slot] = true; // No follow-on errors
+        }
+    }
+    else {
+        error("Unhandled statement type in bytecode compiler.");
+    }
+}
+
+void BytecodeCompiler::compileExpression(const Expression* node) {
+    if (auto intLit = dynamic_cast<const IntegerLiteral*>(node)) {
+        emit(OP_CONST, intLit->value);
+    }
+    else if (auto boolLit = dynamic_cast<const BooleanLiteral*>(node)) {
+        emit(OP_CONST, boolLit->value ? 1 : 0);
+    }
+    else if (auto id = dynamic_cast<const IdentifierExpr*>(node)) {
+        if (id->slot >= defined_.size() || !defined_[id->slot]) {
+            error("Codegen Error: Undefined variable used '" + id->name + "'.");
+            emit(OP_CONST, 0);
+            return;
+        }
+        emit(OP_LOAD, static_cast<int64_t>(id->slot));
+    }
+    else if (auto bin = dynamic_cast<const BinaryExpression*>(node)) {
+        if (bin->op == AND || bin->op == OR) {
+            // Short-circuit: the right operand only runs when the left one does not decide.
+            compileExpression(bin->left.get());
+            if (bin->op == OR) emit(OP_NOT);
+            size_t shortCircuit = emit(OP_JUMP_IF_FALSE);
+            compileExpression(bin->right.get());
+            size_t end = emit(OP_JUMP);
+            patch(shortCircuit);
+            --depth_; // Only one of the two pushes happens at run time
+            emit(OP_CONST, bin->op == AND ? 0 : 1);
+            patch(end);
+            return;
+        }
+        compileExpression(bin->left.get());
+        compileExpression(bin->right.get());
+        switch (bin->op) {
+        case PLUS: emit(OP_ADD); break;
+        case MINUS: emit(OP_SUB); break;
+        case ASTERISK: emit(OP_MUL); break;
+        case SLASH: emit(OP_DIV); break;
+        case PERCENT: emit(OP_MOD); break;
+        case EQ: emit(OP_EQ); break;
+        case NOT_EQ: emit(OP_NOT_EQ); break;
+        case LT: emit(OP_LT); break;
+        case GT: emit(OP_GT); break;
+        case LT_EQ: emit(OP_LT_EQ); break;
+        case GT_EQ: emit(OP_GT_EQ); break;
+        default:
+            error("Unhandled binary operator in bytecode compiler: " + std::string(tokenTypeName(bin->op)));
+            break;
+        }
+    }
+    else if (auto unary = dynamic_cast<const UnaryExpression*>(node)) {
+        compileExpression(unary->operand.get());
+        if (unary->op == MINUS) {
+            emit(OP_NEG);
+        }
+        else if (unary->op == BANG) {
+            emit(OP_NOT);
+        }
+        else if (unary->op != PLUS) {
+            error("Unhandled unary operator in bytecode compiler: " + std::string(tokenTypeName(unary->op)));
+        }
+    }
+    else if (auto cond = dynamic_cast<const ConditionalExpression*>(node)) {
+        compileExpression(cond->condition.get());
+        size_t elseJump = emit(OP_JUMP_IF_FALSE);
+        compileExpression(cond->thenExpr.get());
+        size_t end = emit(OP_JUMP);
+        patch(elseJump);
+        --depth_;
+        compileExpression(cond->elseExpr.get());
+        patch(end);
+    }
+    else if (auto match = dynamic_cast<const MatchExpression*>(node)) {
+        compileExpression(match->subject.get());
+        size_t table = chunk_->matchTables.size();
+        chunk_->matchTables.emplace_back();
+        emit(OP_MATCH, static_cast<int64_t>(table));
+
+        std::vector<size_t> starts;
+        std::vector<size_t> ends;
+        for (size_t i = 0; i < match->arms.size(); ++i) {
+            if (i > 0) --depth_; // Only one arm's push happens at run time
+            starts.push_back(chunk_->code.size());
+            compileExpression(match->arms[i].value.get());
+            if (i + 1 < match->arms.size()) ends.push_back(emit(OP_JUMP));
+        }
+        for (size_t at : ends) {
+            patch(at);
+        }
+
+        MatchTable& dispatch = chunk_->matchTables[table]; // Arms may have added tables of their own
+        for (const auto& c : matchCases(*match)) {
+            dispatch.lows.push_back(c.lo);
+            dispatch.highs.push_back(c.hi);
+            dispatch.targets.push_back(starts[c.arm]);
+        }
+        dispatch.defaultTarget = starts.empty() ? chunk_->code.size() : starts.back();
+    }
+    else {
+        error("Unhandled expression type in bytecode compiler.");
+        emit(OP_CONST, 0);
+    }
+}
+
+// --- Interpreter ---
+
+InterpretResult interpret(const Chunk& chunk, const RuntimeHooks& hooks) {
+    std::vector<int64_t> slots(chunk.slotCount, 0);
+    std::vector<int64_t> stack(chunk.maxStack + 1);
+    int64_t* sp = stack.data(); // one past the top
+    const Instruction* code = chunk.code.data();
+    size_t pc = 0;
+
+    for (;;) {
+        const Instruction& in = code[pc++];
+        switch (in.op) {
+        case OP_CONST: *sp++ = in.operand; break;
+        case OP_LOAD: *sp++ = slots[static_cast<size_t>(in.operand)]; break;
+        case OP_STORE: slots[static_cast<size_t>(in.operand)] = *--sp; break;
+        case OP_POP: --sp; break;
+        // Wrapping arithmetic, like the native add/sub/imul
+        case OP_ADD: --sp; sp[-1] = static_cast<int64_t>(static_cast<uint64_t>(sp[-1]) + static_cast<uint64_t>(sp[0])); break;
+        case OP_SUB: --sp; sp[-1] = static_cast<int64_t>(static_cast<uint64_t>(sp[-1]) - static_cast<uint64_t>(sp[0])); break;
+        case OP_MUL: --sp; sp[-1] = static_cast<int64_t>(static_cast<uint64_t>(sp[-1]) * static_cast<uint64_t>(sp[0])); break;
+        case OP_DIV:
+            --sp;
+            if (sp[0] == 0) return INTERPRET_DIVISION_BY_ZERO;
+            if (sp[0] == -1 && sp[-1] == INT64_MIN) return INTERPRET_DIVISION_OVERFLOW; // idiv raises #DE here too
+            sp[-1] /= sp[0];
+            break;
+        case OP_MOD:
+            --sp;
+            if (sp[0] == 0) return INTERPRET_DIVISION_BY_ZERO;
+            if (sp[0] == -1 && sp[-1] == INT64_MIN) return INTERPRET_DIVISION_OVERFLOW;
+            sp[-1] %= sp[0];
+            break;
+        case OP_EQ: --sp; sp[-1] = sp[-1] == sp[0]; break;
+        case OP_NOT_EQ: --sp; sp[-1] = sp[-1] != sp[0]; break;
+        case OP_LT: --sp; sp[-1] = sp[-1] < sp[0]; break;
+        case OP_GT: --sp; sp[-1] = sp[-1] > sp[0]; break;
+        case OP_LT_EQ: --sp; sp[-1] = sp[-1] <= sp[0]; break;
+        case OP_GT_EQ: --sp; sp[-1] = sp[-1] >= sp[0]; break;
+        case OP_NEG: sp[-1] = static_cast<int64_t>(0 - static_cast<uint64_t>(sp[-1])); break;
+        case OP_NOT: sp[-1] ^= 1; break;
+        case OP_JUMP: pc = static_cast<size_t>(in.operand); break;
+        case OP_JUMP_IF_FALSE:
+            if (*--sp == 0) pc = static_cast<size_t>(in.operand);
+            break;
+        case OP_MATCH: {
+            const MatchTable& table = chunk.matchTables[static_cast<size_t>(in.operand)];
+            int64_t value = *--sp;
+            size_t run = static_cast<size_t>(std::upper_bound(table.lows.begin(), table.lows.end(), value) - table.lows.begin());
+            pc = run > 0 && value <= table.highs[run - 1] ? table.targets[run - 1] : table.defaultTarget;
+            break;
+        }
+        case OP_PRINT_INT: hooks.printInt(static_cast<long>(*--sp)); break;
+        case OP_PRINT_BOOL: hooks.printBool(*--sp != 0); break;
+        case OP_HALT: return INTERPRET_OK;
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ast.h"
+#include "diagnostics.h"
+
+// Stack-machine bytecode for the interpreter tier. Values are 64-bit integers;
+// booleans are 0/1, matching what the native backend keeps in RAX.
+enum OpCode : uint8_t {
+    OP_CONST,          // push operand
+    OP_LOAD,           // push slots[operand]
+    OP_STORE,          // slots[operand] = pop
+    OP_POP,
+    OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_MOD,
+    OP_EQ, OP_NOT_EQ, OP_LT, OP_GT, OP_LT_EQ, OP_GT_EQ,
+    OP_NEG,
+    OP_NOT,
+    OP_JUMP,           // pc = operand
+    OP_JUMP_IF_FALSE,  // if !pop: pc = operand
+    OP_MATCH,          // pc = matchTables[operand]'s target for pop
+    OP_PRINT_INT,
+    OP_PRINT_BOOL,
+    OP_HALT,
+};
+
+struct Instruction {
+    OpCode op;
+    int64_t operand = 0;
+};
+
+// Dispatch of one `match`: disjoint value runs in ascending order and the pc each selects.
+struct MatchTable {
+    std::vector<int64_t> lows;
+    std::vector<int64_t> highs;
+    std::vector<size_t>  targets;
+    size_t               defaultTarget = 0;
+};
+
+struct Chunk {
+    std::vector<Instruction> code;
+    std::vector<MatchTable> matchTables;
+    size_t slotCount = 0;
+    size_t maxStack = 0;
+};
+
+// Lowers a semantically analyzed program to bytecode.
+class BytecodeCompiler {
+public:
+    bool compile(const Program* program, Chunk& out);
+    const std::vector<Diagnostic>& getErrors() const { return errors_; }
+
+private:
+    Chunk* chunk_ = nullptr;
+    std::vector<bool> defined_; // By variable slot: assigned by an earlier statement
+    std::vector<Diagnostic> errors_;
+    size_t depth_ = 0;
+    uint32_t currentOffset_ = 0;
+
+    void error(const std::string& msg);
+    size_t emit(OpCode op, int64_t operand = 0);
+    void patch(size_t at) { chunk_->code[at].operand = static_cast<int64_t>(chunk_->code.size()); }
+
+    void compileStatement(const Statement* node);
+    void compileExpression(const Expression* node);
+};
+
+// Host functions shared by the interpreter and native code.
+struct RuntimeHooks {
+    void (*printInt)(long) = nullptr;
+    void (*printBool)(bool) = nullptr;
+};
+
+enum InterpretResult {
+    INTERPRET_OK,
+    INTERPRET_DIVISION_BY_ZERO,
+    INTERPRET_DIVISION_OVERFLOW, // INT64_MIN / -1 or INT64_MIN % -1, which trap natively
+};
+
+// Executes a chunk. Reentrant: all state lives on the caller's stack.
+InterpretResult interpret(const Chunk& chunk, const RuntimeHooks& hooks);
@@ -0,0 +1,218 @@
+// c_emitter.cpp
+#include "c_emitter.h"
+
+void CEmitter::error(const std::string& msg) {
+    errors_.push_back({ DIAG_CODEGEN, currentOffset_, ILLEGAL, ILLEGAL, msg });
+}
+
+const char* CEmitter::cType(TokenType type) {
+    return type == BOOL ? "bool" : "int64_t";
+}
+
+std::string CEmitter::variableName(const IdentifierExpr* id) const {
+    // The slot prefix keeps every variable out of the names C and the generated
+    // file use (keywords, gfxl_ helpers, the entry point) and apart from each other.
+    return "v" + std::to_string(id->slot) + "_" + id->name;
+}
+
+std::string CEmitter::generate(const Program* program) {
+    if (!program) {
+        error("Code generation received a null AST program.");
+        return "";
+    }
+    declared_.assign(program->slotCount, false);
+
+    out_ << "/* Generated by GLFX --emit=c */\n";
+    out_ << "#include <stdbool.h>\n";
+    out_ << "#include <stdint.h>\n";
+    out_ << "#include <stdlib.h>\n\n";
+    out_ << "void print_int(long n);\n";
+    out_ << "void print_bool(bool b);\n\n";
+    // Signed overflow is undefined in C but wraps in the native backend; do it in unsigned.
+    out_ << "static inline int64_t gfxl_add(int64_t a, int64_t b) { return (int64_t)((uint64_t)a + (uint64_t)b); }\n";
+    out_ << "static inline int64_t gfxl_sub(int64_t a, int64_t b) { return (int64_t)((uint64_t)a - (uint64_t)b); }\n";
+    out_ << "static inline int64_t gfxl_mul(int64_t a, int64_t b) { return (int64_t)((uint64_t)a * (uint64_t)b); }\n";
+    out_ << "static inline int64_t gfxl_neg(int64_t a) { return (int64_t)(0 - (uint64_t)a); }\n";
+    // idiv raises #DE on a zero divisor and on INT64_MIN / -1; both are undefined in C, so stop the same way.
+    out_ << "static inline int64_t gfxl_div(int64_t a, int64_t b) { if (b == 0 || (a == INT64_MIN && b == -1)) abort(); return a / b; }\n";
+    out_ << "static inline int64_t gfxl_mod(int64_t a, int64_t b) { if (b == 0 || (a == INT64_MIN && b == -1)) abort(); return a % b; }\n\n";
+
+    std::ostringstream header;
+    header.swap(out_);
+    for (const auto& stmt : program->statements) {
+        emitStatement(stmt.get());
+    }
+    out_ << "    return 0;\n";
+    std::string body = out_.str();
+    out_.swap(header);
+
+    if (multiversion_) {
+        emitDispatch(body);
+    }
+    else {
+        out_ << "int " << entryName_ << "(void) {\n" << body << "}\n";
+    }
+    return out_.str();
+}
+
+void CEmitter::emitDispatch(const std::string& body) {
+    // Highest level first, matching the order the dispatcher tries them in.
+    struct Variant { const char* isa; const char* target; const char* cpuCheck; };
+    static const Variant kVariants[] = {
+        { "avx512", "avx512f,avx512bw,avx512vl,avx2,fma,bmi2", "__builtin_cpu_supports(\"avx512f\") && __builtin_cpu_supports(\"avx512bw\") && __builtin_cpu_supports(\"avx512vl\")" },
+        { "avx2", "avx2,fma,bmi2", "__builtin_cpu_supports(\"avx2\") && __builtin_cpu_supports(\"fma\") && __builtin_cpu_supports(\"bmi2\")" },
+    };
+    const std::string& e = entryName_;
+
+    out_ << "#if defined(__GNUC__) && defined(__x86_64__)\n";
+    out_ << "#define GFXL_MULTIVERSION 1\n";
+    out_ << "#include <string.h>\n";
+    out_ << "#endif\n\n";
+    out_ << "static int " << e << "_sse2(void) {\n" << body << "}\n\n";
+    out_ << "#ifdef GFXL_MULTIVERSION\n";
+    for (const auto& v : kVariants) {
+        out_ << "__attribute__((target(\"" << v.target << "\"))) static int " << e << "_" << v.isa << "(void) {\n" << body << "}\n\n";
+    }
+    out_ << "#endif\n\n";
+
+    out_ << "static int (*gfxl_" << e << "_impl)(void) = " << e << "_sse2;\n\n";
+    out_ << "#ifdef GFXL_MULTIVERSION\n";
+    out_ << "__attribute__((constructor)) static void gfxl_" << e << "_dispatch(void) {\n";
+    out_ << "    const char* cap = getenv(\"GFXL_ISA\");\n";
+    out_ << "    int allowed = !cap;\n";
+    out_ << "    __builtin_cpu_init();\n";
+    for (const auto& v : kVariants) {
+        out_ << "    allowed = allowed || strcmp(cap, \"" << v.isa << "\") == 0;\n";
+        out_ << "    if (allowed && " << v.cpuCheck << ") { gfxl_" << e << "_impl = " << e << "_" << v.isa << "; return; }\n";
+    }
+    out_ << "}\n";
+    out_ << "#endif\n\n";
+    out_ << "int " << e << "(void) {\n";
+    out_ << "    return gfxl_" << e << "_impl();\n";
+    out_ << "}\n";
+}
+
+void CEmitter::emitLine(const std::string& code) {
+    // Match subjects used in the statement are declared just ahead of it.
+    for (const auto& temp : pendingTemps_) {
+        out_ << "    int64_t " << temp << ";\n";
+    }
+    pendingTemps_.clear();
+    out_ << "    " << code << ";\n";
+}
+
+void CEmitter::emitStatement(const Statement* node) {
+    currentOffset_ = node->offset;
+    if (auto assign = dynamic_cast<const AssignmentStatement*>(node)) {
+        const IdentifierExpr* target = assign->identifier.get();
+        std::string value = expression(assign->value.get());
+        if (target->slot >= declared_.size()) {
+            // Every variable is numbered by semantic analysis before C is emitted.
+            error("Internal Codegen Error: Variable '" + target->name + "' has no slot; was the program analyzed?");
+        }
+        else if (!declared_[target->slot]) {
+            declared_[target->slot] = true;
+            emitLine(std::string(cType(assign->value->resolvedType)) + " " + variableName(target) + " = " + value);
+        }
+        else {
+            emitLine(variableName(target) + " = " + value);
+        }
+    }
+    else if (auto exprStmt = dynamic_cast<const ExpressionStatement*>(node)) {
+        emitLine("(void)(" + expression(exprStmt->expression.get()) + ")");
+    }
+    else if (auto print = dynamic_cast<const PrintStatement*>(node)) {
+        TokenType type = print->expression->resolvedType;
+        if (type == INT) {
+            emitLine("print_int((long)" + expression(print->expression.get()) + ")");
+        }
+        else if (type == BOOL) {
+            emitLine("print_bool(" + expression(print->expression.get()) + ")");
+        }
+        else {
+            error("Attempting to print an unsupported type (TokenType: " + std::string(tokenTypeName(type)) + ").");
+        }
+    }
+    else if (auto block = dynamic_cast<const AsmStatement*>(node)) {
+        error("asm_ blocks are Intel-syntax x86-64 assembly and cannot be emitted as portable C; use --emit=asm or --emit=obj.");
+        for (const auto& output : block->outputs) {
+            uint32_t slot = static_cast<const IdentifierExpr*>(output.expression.get())->slot;
+            if (slot < declared_.size()) declared_[slot] = true; // No follow-on errors
+        }
+    }
+    else {
+        error("Unhandled statement type in C emitter.");
+    }
+}
+
+std::string CEmitter::expression(const Expression* node) {
+    if (auto intLit = dynamic_cast<const IntegerLiteral*>(node)) {
+        return "INT64_C(" + std::to_string(intLit->value) + ")";
+    }
+    if (auto boolLit = dynamic_cast<const BooleanLiteral*>(node)) {
+        return boolLit->value ? "true" : "false";
+    }
+    if (auto id = dynamic_cast<const IdentifierExpr*>(node)) {
+        if (id->slot >= declared_.size() || !declared_[id->slot]) {
+            error("Codegen Error: Undefined variable used '" + id->name + "'.");
+        }
+        return variableName(id);
+    }
+    if (auto bin = dynamic_cast<const BinaryExpression*>(node)) {
+        std::string l = expression(bin->left.get());
+        std::string r = expression(bin->right.get());
+        switch (bin->op) {
+        case PLUS: return "gfxl_add(" + l + ", " + r + ")";
+        case MINUS: return "gfxl_sub(" + l + ", " + r + ")";
+        case ASTERISK: return "gfxl_mul(" + l + ", " + r + ")";
+        case SLASH: return "gfxl_div(" + l + ", " + r + ")";
+        case PERCENT: return "gfxl_mod(" + l + ", " + r + ")";
+        case EQ: return "(" + l + " == " + r + ")";
+        case NOT_EQ: return "(" + l + " != " + r + ")";
+        case LT: return "(" + l + " < " + r + ")";
+        case GT: return "(" + l + " > " + r + ")";
+        case LT_EQ: return "(" + l + " <= " + r + ")";
+        case GT_EQ: return "(" + l + " >= " + r + ")";
+        case AND: return "(" + l + " && " + r + ")";
+        case OR: return "(" + l + " || " + r + ")";
+        default:
+            error("Unhandled binary operator in C emitter: " + std::string(tokenTypeName(bin->op)));
+            return "0";
+        }
+    }
+    if (auto unary = dynamic_cast<const UnaryExpression*>(node)) {
+        std::string operand = expression(unary->operand.get());
+        switch (unary->op) {
+        case MINUS: return "gfxl_neg(" + operand + ")";
+        case PLUS: return operand;
+        case BANG: return "(!" + operand + ")";
+        default:
+            error("Unhandled unary operator in C emitter: " + std::string(tokenTypeName(unary->op)));
+            return "0";
+        }
+    }
+    if (auto cond = dynamic_cast<const ConditionalExpression*>(node)) {
+        return "(" + expression(cond->condition.get()) + " ? " + expression(cond->thenExpr.get()) + " : " + expression(cond->elseExpr.get()) + ")";
+    }
+    if (auto match = dynamic_cast<const MatchExpression*>(node)) {
+        // The subject is evaluated once into a temporary, in place so that ?:, && and ||
+        // still decide whether it runs; the arms are a chain of conditionals in arm order,
+        // which C compilers turn back into a switch.
+        std::string subject = "gfxl_m" + std::to_string(matchTemps_++);
+        pendingTemps_.push_back(subject);
+        std::string result = expression(match->arms.back().value.get());
+        for (size_t i = match->arms.size() - 1; i-- > 0;) {
+            const MatchArm& arm = match->arms[i];
+            std::string test;
+            for (const auto& [lo, hi] : arm.ranges) {
+                if (!test.empty()) test += " || ";
+                test += lo == hi ? "(" + subject + " == INT64_C(" + std::to_string(lo) + "))"
+                                 : "(" + subject + " >= INT64_C(" + std::to_string(lo) + ") && " + subject + " <= INT64_C(" + std::to_string(hi) + "))";
+            }
+            result = "((" + test + ") ? " + expression(arm.value.get()) + " : " + result + ")";
+        }
+        return "(" + subject + " = " + expression(match->subject.get()) + ", " + result + ")";
+    }
+    error("Unhandled expression type in C emitter.");
+    return "0";
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ast.h"
+#include "diagnostics.h"
+
+// Lowers an analyzed program to portable C11 for --emit=c. The output keeps
+// the native backend's semantics (64-bit wrapping integers, 0/1 booleans) and
+// links against the same print_int/print_bool runtime.
+//
+// With `multiversion` the program body is emitted once per x86-64 level
+// (baseline SSE2, AVX2, AVX-512) with GCC/Clang target attributes. A
+// constructor picks the best level the CPU supports once, at load time, and
+// stores it in the entry's dispatch pointer, so calls never check again.
+// GFXL_ISA=sse2|avx2|avx512 in the environment caps the level that is chosen.
+class CEmitter {
+public:
+    explicit CEmitter(std::string entryName = "main", bool multiversion = false)
+        : entryName_(std::move(entryName)), multiversion_(multiversion) {}
+
+    std::string generate(const Program* program);
+    const std::vector<Diagnostic>& getErrors() const { return errors_; }
+
+private:
+    std::string entryName_;
+    bool multiversion_;
+    std::ostringstream out_;
+    std::vector<bool> declared_; // By variable slot
+    std::vector<Diagnostic> errors_;
+    uint32_t currentOffset_ = 0;
+    uint32_t matchTemps_ = 0;
+    std::vector<std::string> pendingTemps_; // Match subject temporaries the next line declares
+
+    void error(const std::string& msg);
+    void emitDispatch(const std::string& body);
+    void emitLine(const std::string& code);
+    void emitStatement(const Statement* node);
+    std::string expression(const Expression* node);
+    std::string variableName(const IdentifierExpr* id) const;
+    static const char* cType(TokenType type);
+};
@@ -0,0 +1,108 @@
+// code_folding.cpp
+#include "code_folding.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+static constexpr size_t kFunctionAlignment = 16;
+static constexpr uint8_t kInt3 = 0xCC;
+
+static void fnv1a(uint64_t& hash, const void* data, size_t size) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= p[i];
+        hash *= 0x100000001b3ull;
+    }
+}
+
+// Relocations are part of the identity: two `call` sites with equal bytes but
+// different targets are different code.
+static uint64_t bodyHash(const MachineCode& code) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    fnv1a(hash, code.bytes.data(), code.bytes.size());
+    for (const auto& r : code.relocations) {
+        fnv1a(hash, &r.offset, sizeof(r.offset));
+        fnv1a(hash, &r.addend, sizeof(r.addend));
+        fnv1a(hash, r.symbol.data(), r.symbol.size() + 1);
+    }
+    return hash;
+}
+
+static bool sameBody(const MachineCode& a, const MachineCode& b) {
+    if (a.bytes != b.bytes || a.relocations.size() != b.relocations.size()) return false;
+    for (size_t i = 0; i < a.relocations.size(); ++i) {
+        const Relocation& x = a.relocations[i];
+        const Relocation& y = b.relocations[i];
+        if (x.offset != y.offset || x.addend != y.addend || x.symbol != y.symbol) return false;
+    }
+    return true;
+}
+
+static size_t alignUp(size_t n) {
+    return (n + kFunctionAlignment - 1) / kFunctionAlignment * kFunctionAlignment;
+}
+
+MachineCode linkFunctions(const std::vector<FunctionCode>& functions, FoldMode mode, FoldReport* report) {
+    MachineCode out;
+    std::unordered_map<uint64_t, std::vector<size_t>> bodies; // Hash -> indices of kept functions
+    std::vector<size_t> offsets(functions.size());
+    std::vector<size_t> keptAs(functions.size());             // Index of the function whose body is used
+    size_t bytesBefore = 0;
+
+    // --- Bodies ---
+    for (size_t i = 0; i < functions.size(); ++i) {
+        const MachineCode& code = functions[i].code;
+        bytesBefore = alignUp(bytesBefore) + code.bytes.size();
+        keptAs[i] = i;
+        if (mode != FOLD_NONE) {
+            auto& candidates = bodies[bodyHash(code)];
+            for (size_t kept : candidates) {
+                if (sameBody(functions[kept].code, code)) {
+                    keptAs[i] = kept;
+                    break;
+                }
+            }
+            if (keptAs[i] != i) continue;
+            candidates.push_back(i);
+        }
+
+        out.bytes.resize(alignUp(out.bytes.size()), kInt3);
+        offsets[i] = out.bytes.size();
+        out.bytes.insert(out.bytes.end(), code.bytes.begin(), code.bytes.end());
+        for (const auto& r : code.relocations) {
+            out.relocations.push_back({ static_cast<uint32_t>(offsets[i] + r.offset), r.symbol, r.addend });
+        }
+        for (const auto& sym : code.symbols) {
+            out.symbols.push_back({ sym.name, static_cast<uint32_t>(offsets[i] + sym.offset), sym.global });
+        }
+    }
+
+    // --- Folded functions: aliases, or thunks that keep addresses distinct ---
+    FoldReport local;
+    for (size_t i = 0; i < functions.size(); ++i) {
+        size_t kept = keptAs[i];
+        if (kept == i) continue;
+        local.folded.push_back({ functions[i].name, functions[kept].name, mode == FOLD_SAFE });
+        if (mode == FOLD_ALL) {
+            out.symbols.push_back({ functions[i].name, static_cast<uint32_t>(offsets[kept]), true });
+            continue;
+        }
+        uint32_t thunk = static_cast<uint32_t>(out.bytes.size());
+        int32_t rel = static_cast<int32_t>(static_cast<int64_t>(offsets[kept]) - (thunk + 5));
+        out.bytes.push_back(0xE9); // jmp rel32
+        for (int b = 0; b < 4; ++b) out.bytes.push_back(static_cast<uint8_t>(static_cast<uint32_t>(rel) >> (8 * b)));
+        out.symbols.push_back({ functions[i].name, thunk, true });
+    }
+
+    std::stable_sort(out.symbols.begin(), out.symbols.end(), [](const CodeSymbol& a, const CodeSymbol& b) {
+        return a.offset < b.offset;
+    });
+    if (report) {
+        local.functions = functions.size();
+        local.bytesBefore = bytesBefore;
+        local.bytesAfter = out.bytes.size();
+        *report = std::move(local);
+    }
+    return out;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "x86_assembler.h"
+
+// One compiled unit destined for a bundle: its code defines the global symbol
+// `name` at offset 0 and references only external symbols.
+struct FunctionCode {
+    std::string name;
+    MachineCode code;
+};
+
+enum FoldMode {
+    FOLD_NONE,
+    FOLD_SAFE, // Duplicates become 5-byte jmp thunks, so every symbol keeps a distinct address
+    FOLD_ALL,  // Duplicates become aliases of the kept body; their addresses compare equal
+};
+
+struct FoldedFunction {
+    std::string name;
+    std::string target; // Function whose body it now shares
+    bool thunk;
+};
+
+struct FoldReport {
+    size_t functions = 0;
+    size_t bytesBefore = 0; // .text laid out without folding
+    size_t bytesAfter = 0;
+    std::vector<FoldedFunction> folded;
+};
+
+// Lays the functions out in one .text, each body 16-byte aligned and padded
+// with int3, and folds bodies whose bytes and relocations are identical. The
+// first function with a given body keeps it. Bodies are compared by hash first
+// and then exactly, so a collision never merges different code.
+MachineCode linkFunctions(const std::vector<FunctionCode>& functions, FoldMode mode, FoldReport* report = nullptr);
@@ -0,0 +1,201 @@
+// compile_cache.cpp
+#include "compile_cache.h"
+
+#include <chrono>
+#include <utility>
+
+#include "elf_writer.h"
+
+static const char* const kCacheSymbol = "gfxl_cached_entry";
+
+namespace {
+
+class KeyBuilder {
+public:
+    std::string key;
+    bool ok = true;
+
+    void statement(const Statement* node) {
+        if (auto assign = dynamic_cast<const AssignmentStatement*>(node)) {
+            key += 'A';
+            variable(assign->identifier.get());
+            expression(assign->value.get());
+        }
+        else if (auto exprStmt = dynamic_cast<const ExpressionStatement*>(node)) {
+            key += 'E';
+            expression(exprStmt->expression.get());
+        }
+        else if (auto print = dynamic_cast<const PrintStatement*>(node)) {
+            key += 'P';
+            expression(print->expression.get());
+        }
+        else {
+            ok = false;
+        }
+        key += ';';
+    }
+
+private:
+    // Slots number variables in definition order, so programs differing only in
+    // names share a key.
+    void variable(const IdentifierExpr* id) {
+        key += 'v' + std::to_string(id->slot);
+    }
+
+    void expression(const Expression* node) {
+        key += std::to_string(node->resolvedType);
+        if (auto intLit = dynamic_cast<const IntegerLiteral*>(node)) {
+            key += 'i' + std::to_string(intLit->value);
+        }
+        else if (auto boolLit = dynamic_cast<const BooleanLiteral*>(node)) {
+            key += boolLit->value ? 't' : 'f';
+        }
+        else if (auto id = dynamic_cast<const IdentifierExpr*>(node)) {
+            variable(id);
+        }
+        else if (auto bin = dynamic_cast<const BinaryExpression*>(node)) {
+            key += 'b' + std::to_string(bin->op) + '(';
+            expression(bin->left.get());
+            key += ',';
+            expression(bin->right.get());
+            key += ')';
+        }
+        else if (auto unary = dynamic_cast<const UnaryExpression*>(node)) {
+            key += 'u' + std::to_string(unary->op) + '(';
+            expression(unary->operand.get());
+            key += ')';
+        }
+        else if (auto cond = dynamic_cast<const ConditionalExpression*>(node)) {
+            key += "c(";
+            expression(cond->condition.get());
+            key += ',';
+            expression(cond->thenExpr.get());
+            key += ',';
+            expression(cond->elseExpr.get());
+            key += ')';
+        }
+        else if (auto match = dynamic_cast<const MatchExpression*>(node)) {
+            key += "m(";
+            expression(match->subject.get());
+            for (const auto& arm : match->arms) {
+                key += '|';
+                for (const auto& [lo, hi] : arm.ranges) {
+                    key += std::to_string(lo) + ':' + std::to_string(hi) + ';';
+                }
+                expression(arm.value.get());
+            }
+            key += ')';
+        }
+        else {
+            ok = false;
+        }
+    }
+};
+
+void renameSymbol(MachineCode& code, const std::string& from, const std::string& to) {
+    for (auto& sym : code.symbols) {
+        if (sym.name == from) sym.name = to;
+    }
+}
+
+// Every option that changes the generated code or its diagnostics. output and
+// entryName are left out: both outputs share the machine code, and the entry
+// symbol is renamed per user.
+std::string optionsKey(const CompileOptions& options) {
+    return "P" + std::to_string(options.passes) + (options.optimizeSize ? "s" : "")
+         + "H" + std::to_string(options.helperStackBytes) + ":";
+}
+
+} // namespace
+
+std::string structuralKey(const Program& program) {
+    KeyBuilder builder;
+    for (const auto& stmt : program.statements) {
+        builder.statement(stmt.get());
+    }
+    return builder.ok ? builder.key : std::string();
+}
+
+void CompileCache::compile(CompileResult& result, const CompileOptions& options) {
+    std::string key = options.output == OUTPUT_MACHINE_CODE || options.output == OUTPUT_OBJECT
+        ? structuralKey(*result.ast) : std::string();
+    if (key.empty()) {
+        compileAnalyzed(result, options);
+        return;
+    }
+    key.insert(0, optionsKey(options));
+
+    std::shared_ptr<Entry> entry;
+    std::promise<void> filled;
+    bool owner = false;
+    std::vector<Diagnostic> failure; // The owner's own codegen errors
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& slot = entries_[key];
+        if (!slot) {
+            slot = std::make_shared<Entry>();
+            slot->ready = filled.get_future().share();
+            slot->stats.firstUser = options.entryName;
+            owner = true;
+        }
+        entry = slot;
+        ++entry->stats.uses;
+    }
+
+    if (owner) {
+        auto start = std::chrono::steady_clock::now();
+        CompileResult generated;
+        generated.ast = std::move(result.ast);
+        CompileOptions cached = options;
+        cached.output = OUTPUT_MACHINE_CODE;
+        cached.entryName = kCacheSymbol;
+        // Each user checks @max_stack itself below, with its own name and offsets.
+        int64_t maxStack = std::exchange(generated.ast->maxStack, -1);
+        compileAnalyzed(generated, cached);
+        generated.ast->maxStack = maxStack;
+        result.ast = std::move(generated.ast);
+
+        entry->ok = generated.ok;
+        failure = std::move(generated.diagnostics);
+        entry->code = std::move(generated.machineCode);
+        entry->stack = generated.stack;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            entry->stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            entry->stats.bytes = entry->code.bytes.size();
+        }
+        filled.set_value();
+    }
+    entry->ready.wait();
+
+    // Diagnostics name the entry symbol and point into one file's source, so none are shared.
+    result.ok = false;
+    if (!entry->ok) {
+        if (owner) {
+            result.diagnostics.insert(result.diagnostics.end(), failure.begin(), failure.end());
+        }
+        else {
+            compileAnalyzed(result, options); // Rare; reports the failure against this program's source
+        }
+        return;
+    }
+    result.stack = entry->stack;
+    size_t reported = result.diagnostics.size();
+    checkMaxStack(result, options);
+    if (result.diagnostics.size() > reported) return;
+    result.ok = true;
+    result.machineCode = entry->code;
+    renameSymbol(result.machineCode, kCacheSymbol, options.entryName);
+    if (options.output == OUTPUT_OBJECT) {
+        result.object = writeElfObject(result.machineCode);
+    }
+}
+
+std::vector<CompileCache::EntryStats> CompileCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<EntryStats> out;
+    for (const auto& [key, entry] : entries_) {
+        out.push_back(entry->stats);
+    }
+    return out;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "compiler.h"
+
+// Memoizes native code generation by program structure. Two analyzed programs
+// that differ only in variable names (and entry symbol) generate the same
+// machine code, so the backend runs once per structure and later requests get
+// a copy with their own entry symbol. Safe to share between threads: a
+// structure requested concurrently is compiled by the first caller while the
+// others wait for its result.
+class CompileCache {
+public:
+    struct EntryStats {
+        std::string firstUser;  // Entry symbol of the compile that populated the entry
+        size_t uses = 0;
+        double milliseconds = 0.0;
+        size_t bytes = 0;       // .text size
+    };
+
+    // Like compileAnalyzed(). Only OUTPUT_MACHINE_CODE and OUTPUT_OBJECT are
+    // cached; other outputs compile directly.
+    void compile(CompileResult& result, const CompileOptions& options);
+
+    std::vector<EntryStats> stats() const;
+
+private:
+    struct Entry {
+        std::shared_future<void> ready;
+        bool ok = false;
+        MachineCode code;                      // Entry symbol is kCacheSymbol
+        StackUsage stack;                      // For each user's own @max_stack check
+        EntryStats stats;
+    };
+
+    mutable std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<Entry>> entries_; // Structural key -> entry
+};
+
+// Canonical encoding of an analyzed program with variables numbered in order
+// of first use; empty if the program contains nodes the backend cannot compile.
+std::string structuralKey(const Program& program);
@@ -0,0 +1,120 @@
+// compiler.cpp
+#include "compiler.h"
+
+#include <algorithm>
+
+#include "Lexer.h"
+#include "Parser.h"
+#include "c_emitter.h"
+#include "elf_writer.h"
+#include "semantic_analyzer.h"
+
+static bool hasErrors(const std::vector<Diagnostic>& diagnostics) {
+    for (const auto& d : diagnostics) {
+        if (d.severity() == SEVERITY_ERROR) return true;
+    }
+    return false;
+}
+
+CompileResult compileSource(std::string_view source, const CompileOptions& options) {
+    CompileResult result;
+
+    // Lexing & Parsing
+    Lexer lexer{ std::string(source) };
+    Parser parser(lexer);
+    result.ast = parser.parseProgram();
+    result.diagnostics = parser.getErrors();
+    if (hasErrors(result.diagnostics)) return result;
+
+    // Semantic Analysis
+    SemanticAnalyzer sema;
+    sema.analyze(*result.ast);
+    result.diagnostics.insert(result.diagnostics.end(), sema.getErrors().begin(), sema.getErrors().end());
+    if (hasErrors(result.diagnostics)) return result;
+
+    compileAnalyzed(result, options);
+    return result;
+}
+
+int64_t worstCaseStack(const StackUsage& usage, const CompileOptions& options) {
+    if (!usage.unbounded.empty()) return -1;
+    int64_t worst = usage.frameBytes;
+    for (const auto& call : usage.calls) {
+        if (call.symbol != "print_int" && call.symbol != "print_bool") return -1;
+        worst = std::max<int64_t>(worst, call.depth + options.helperStackBytes);
+    }
+    return worst;
+}
+
+void checkMaxStack(CompileResult& result, const CompileOptions& options) {
+    if (result.ast->maxStack < 0) return;
+    int64_t worst = worstCaseStack(result.stack, options);
+    std::string limit = "@max_stack(" + std::to_string(result.ast->maxStack) + ")";
+    if (worst < 0) {
+        std::string why = result.stack.unbounded.empty() ? "it calls a function of unknown stack use" : result.stack.unbounded;
+        result.diagnostics.push_back({ DIAG_CODEGEN, result.ast->maxStackOffset, ILLEGAL, ILLEGAL,
+            "Stack usage of '" + options.entryName + "' is unbounded (" + why + "), so " + limit + " cannot be checked." });
+    }
+    else if (worst > result.ast->maxStack) {
+        result.diagnostics.push_back({ DIAG_CODEGEN, result.ast->maxStackOffset, ILLEGAL, ILLEGAL,
+            "Worst-case stack usage of '" + options.entryName + "' is " + std::to_string(worst) + " bytes, exceeding " + limit + "." });
+    }
+}
+
+void compileAnalyzed(CompileResult& result, const CompileOptions& options) {
+    result.ok = false;
+    if (options.output == OUTPUT_AST) {
+        result.ok = true;
+        return;
+    }
+
+    if (options.passes & ~PASS_STRENGTH) {
+        Optimizer optimizer(options.passes);
+        optimizer.run(*result.ast);
+        result.remarks.insert(result.remarks.end(), optimizer.remarks().begin(), optimizer.remarks().end());
+    }
+
+    if (options.output == OUTPUT_C) {
+        CEmitter emitter(options.entryName, options.multiversion);
+        result.cSource = emitter.generate(result.ast.get());
+        result.diagnostics.insert(result.diagnostics.end(), emitter.getErrors().begin(), emitter.getErrors().end());
+        result.ok = !hasErrors(result.diagnostics);
+        return;
+    }
+
+    // Code Generation
+    CodegenOptions codegenOptions;
+    codegenOptions.entryName = options.entryName;
+    codegenOptions.optimizeSize = options.optimizeSize;
+    codegenOptions.strengthReduce = (options.passes & PASS_STRENGTH) != 0;
+    codegenOptions.forwardLoads = (options.passes & PASS_FORWARD) != 0;
+    codegenOptions.useRanges = (options.passes & PASS_RANGE) != 0;
+    codegenOptions.keepListing = options.keepListing;
+    CodeGenerator codegen(codegenOptions);
+    result.assembly = codegen.generate(result.ast.get());
+    result.diagnostics.insert(result.diagnostics.end(), codegen.getErrors().begin(), codegen.getErrors().end());
+    result.remarks.insert(result.remarks.end(), codegen.getRemarks().begin(), codegen.getRemarks().end());
+    result.traffic = codegen.getTraffic();
+    result.stack = codegen.getStackUsage();
+    result.listing = codegen.getListing();
+    checkMaxStack(result, options);
+    if (hasErrors(result.diagnostics)) return;
+
+    if (options.output == OUTPUT_ASSEMBLY) {
+        result.ok = true;
+        return;
+    }
+
+    // Assembly
+    X86Assembler assembler;
+    if (!assembler.assemble(result.assembly, result.machineCode)) {
+        for (const auto& msg : assembler.getErrors()) {
+            result.diagnostics.push_back({ DIAG_CODEGEN, 0, ILLEGAL, ILLEGAL, msg });
+        }
+        return;
+    }
+    if (options.output == OUTPUT_OBJECT) {
+        result.object = writeElfObject(result.machineCode);
+    }
+    result.ok = true;
+}
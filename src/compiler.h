@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ast.h"
+#include "Codegen.h"
+#include "diagnostics.h"
+#include "optimizer.h"
+#include "x86_assembler.h"
+
+enum OutputKind {
+    OUTPUT_AST,           // Checked AST only; stops before code generation
+    OUTPUT_ASSEMBLY,      // Intel-syntax GNU as text
+    OUTPUT_MACHINE_CODE,  // Raw .text bytes plus relocations and symbols
+    OUTPUT_OBJECT,        // ELF64 relocatable object
+    OUTPUT_C,             // Portable C11 source
+};
+
+struct CompileOptions {
+    OutputKind output = OUTPUT_ASSEMBLY;
+    std::string entryName = "main";
+    bool optimizeSize = false; // -Os
+    bool multiversion = false; // --multiversion (C output only)
+    unsigned passes = PASS_ALL; // OptPass bits; -O0 clears them
+    int helperStackBytes = 1024; // Assumed stack use of the print_int/print_bool runtime, for @max_stack
+    bool keepListing = false;    // Fill CompileResult::listing, for --analyze-perf
+};
+
+struct CompileResult {
+    bool ok = false;
+    std::unique_ptr<Program> ast;
+    std::vector<Diagnostic> diagnostics; // Parser, semantic and codegen diagnostics, in that order
+    std::vector<Remark> remarks;         // What the optimizer did, for --opt-report
+    std::vector<StatementTraffic> traffic; // Stack traffic per statement of the native code
+    StackUsage stack;                    // Frame and call sites of the native code
+    std::vector<ListedInstruction> listing; // Instructions with their statements, if options.keepListing
+    std::string assembly;
+    std::string cSource;                 // Filled for OUTPUT_C
+    MachineCode machineCode;             // Filled for OUTPUT_MACHINE_CODE and OUTPUT_OBJECT
+    std::vector<uint8_t> object;         // Filled for OUTPUT_OBJECT
+};
+
+// Runs the whole pipeline over an in-memory buffer. Every stage is a fresh
+// object owned by this call, so concurrent compiles never share mutable state.
+// Stops after the first stage that reports an error.
+CompileResult compileSource(std::string_view source, const CompileOptions& options);
+
+// Worst-case stack bytes the compiled function needs below its caller's stack
+// pointer: its frame, or the deepest call site plus what the callee uses
+// (options.helperStackBytes for the print runtime). -1 if it cannot be
+// bounded: an asm_ block moves RSP by a register or calls an unknown function.
+int64_t worstCaseStack(const StackUsage& usage, const CompileOptions& options);
+
+// Adds the @max_stack diagnostic of result.ast, if its limit is exceeded or
+// cannot be checked, from result.stack and naming options.entryName.
+void checkMaxStack(CompileResult& result, const CompileOptions& options);
+
+// Backend half of compileSource(): generates options.output from the analyzed
+// program in result.ast (as returned for OUTPUT_AST) and sets result.ok.
+void compileAnalyzed(CompileResult& result, const CompileOptions& options);
@@ -0,0 +1,148 @@
+// diagnostics.cpp
+#include "diagnostics.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GFXL_HAVE_SSE2 1
+#endif
+
+DiagnosticSeverity Diagnostic::severity() const {
+    return kind == DIAG_UNRESOLVED_ASSIGNMENT ? SEVERITY_WARNING : SEVERITY_ERROR;
+}
+
+std::string Diagnostic::message() const {
+    std::string A = tokenTypeName(a);
+    std::string B = tokenTypeName(b);
+
+    switch (kind) {
+    case DIAG_EXPECTED_TOKEN:
+        return "Parser error: Expected next token to be " + A + ", got " + B + " instead. (Literal: '" + subject + "')";
+    case DIAG_NO_PREFIX_PARSE:
+        return "No prefix parse function for " + A + " (" + subject + ") found.";
+    case DIAG_UNKNOWN_ANNOTATION:
+        return "Parser error: Unknown annotation '@" + subject + "'.";
+    case DIAG_NOT_CALLABLE:
+        return "Parser error: Only identifiers can be called.";
+    case DIAG_UNDEFINED_VARIABLE:
+        return "Semantic Error: Undefined variable '" + subject + "'.";
+    case DIAG_UNDEFINED_FUNCTION:
+        return "Semantic Error: Undefined function '" + subject + "'.";
+    case DIAG_UNRESOLVED_DEFINITION:
+        return "Semantic Error: Attempting to define variable '" + subject + "' with an unresolved type.";
+    case DIAG_UNRESOLVED_ASSIGNMENT:
+        return "Semantic Warning: Assignment value for '" + subject + "' has an unresolved type. Variable type remains " + A + ".";
+    case DIAG_ASSIGNMENT_MISMATCH:
+        return "Semantic Error: Type mismatch in assignment to '" + subject + "'. Expected " + A + ", but got " + B + ".";
+    case DIAG_PRINT_UNRESOLVED:
+        return "Semantic Error: PRINT statement argument has an unresolved or invalid type.";
+    case DIAG_ARITHMETIC_OPERANDS:
+        return "Semantic Error: Arithmetic operator '" + A + "' expects integer operands.";
+    case DIAG_RELATIONAL_OPERANDS:
+        return "Semantic Error: Relational operator '" + A + "' expects integer operands.";
+    case DIAG_EQUALITY_OPERANDS:
+        return "Semantic Error: Equality operator '" + subject + "' compares " + A + " with " + B + ".";
+    case DIAG_LOGICAL_OPERANDS:
+        return "Semantic Error: Logical operator '" + A + "' expects boolean operands.";
+    case DIAG_UNSUPPORTED_BINARY:
+        return "Semantic Error: Unsupported binary operator '" + A + "'.";
+    case DIAG_UNARY_INT_OPERAND:
+        return "Semantic Error: Unary '" + A + "' expects an integer operand.";
+    case DIAG_UNARY_BOOL_OPERAND:
+        return "Semantic Error: '!' expects a boolean operand.";
+    case DIAG_DEREF_NON_POINTER:
+        return "Semantic Error: Dereference requires a pointer operand, got " + A + ".";
+    case DIAG_UNSUPPORTED_UNARY:
+        return "Semantic Error: Unsupported unary operator '" + A + "'.";
+    case DIAG_CONDITION_NOT_BOOL:
+        return "Semantic Error: Condition of '?:' must be BOOL, got " + A + ".";
+    case DIAG_BRANCH_MISMATCH:
+        return "Semantic Error: Branches of '?:' have different types (" + A + " and " + B + ").";
+    case DIAG_MEMBER_ACCESS:
+        return "Semantic Error: Member access '->" + subject + "' requires a struct operand, got " + A + ".";
+    case DIAG_DIVISION_BY_ZERO:
+        return "Semantic Error: Division by zero detected.";
+    case DIAG_ASM_CONSTRAINT:
+        return "Semantic Error: Invalid asm_ constraint \"" + subject + "\" for this operand.";
+    case DIAG_ASM_OPERAND_TYPE:
+        return "Semantic Error: asm_ operand has type " + A + "; inputs must be INT or BOOL and outputs INT variables.";
+    case DIAG_ASM_CLOBBER:
+        return "Semantic Error: asm_ cannot clobber \"" + subject + "\": clobbers are general-purpose registers other than rsp, rbp and the operands' fixed registers, \"cc\" or \"memory\".";
+    case DIAG_ASM_OPERAND:
+        return "Semantic Error: asm_ template refers to '" + subject + "', which is not an operand.";
+    case DIAG_MATCH_SUBJECT:
+        return "Semantic Error: match subject must be INT, got " + A + ".";
+    case DIAG_MATCH_ARM_TYPE:
+        return "Semantic Error: match arms have different types (" + A + " and " + B + ").";
+    case DIAG_MATCH_DEFAULT:
+        return "Semantic Error: match needs exactly one '_' arm, and it must be the last.";
+    case DIAG_MATCH_RANGE:
+        return "Semantic Error: match range " + subject + " is empty.";
+    case DIAG_CODEGEN:
+        return subject;
+    }
+    return "Unknown diagnostic.";
+}
+
+// --- Source index ---
+
+void SourceIndex::build() const {
+    built_ = true;
+    lineStarts_.clear();
+    lineStarts_.push_back(0);
+
+    const char* data = source_.data();
+    size_t size = source_.size();
+    size_t i = 0;
+
+#ifdef GFXL_HAVE_SSE2
+    // 16 bytes per step: compare against '\n' and walk the set bits of the mask.
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+        while (mask) {
+            lineStarts_.push_back(static_cast<uint32_t>(i + std::countr_zero(mask) + 1));
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    while (i < size) {
+        const void* hit = std::memchr(data + i, '\n', size - i);
+        if (!hit) break;
+        i = static_cast<size_t>(static_cast<const char*>(hit) - data) + 1;
+        lineStarts_.push_back(static_cast<uint32_t>(i));
+    }
+}
+
+SourceLocation SourceIndex::locate(uint32_t offset) const {
+    if (!built_) build();
+
+    auto it = std::upper_bound(lineStarts_.begin(), lineStarts_.end(), offset);
+    size_t line = static_cast<size_t>(it - lineStarts_.begin()); // 1-based: it points one past the line
+    SourceLocation loc;
+    loc.line = static_cast<uint32_t>(line);
+    loc.column = offset - lineStarts_[line - 1] + 1;
+    return loc;
+}
+
+std::string formatDiagnostic(const Diagnostic& diag, const SourceIndex& index, std::string_view filename) {
+    SourceLocation loc = index.locate(diag.offset);
+    std::string out(filename);
+    out += ":" + std::to_string(loc.line) + ":" + std::to_string(loc.column) + ": ";
+    out += diag.severity() == SEVERITY_WARNING ? "warning: " : "error: ";
+    out += diag.message();
+    return out;
+}
+
+std::string formatRemark(const Remark& remark, const SourceIndex& index, std::string_view filename) {
+    SourceLocation loc = index.locate(remark.offset);
+    std::string out(filename);
+    out += ":" + std::to_string(loc.line) + ":" + std::to_string(loc.column) + ": note: [" + remark.pass + "] ";
+    out += remark.message;
+    return out;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Token.h"
+
+// What went wrong. The message text for each kind lives in diagnostics.cpp and is
+// only produced when a diagnostic is actually printed.
+enum DiagnosticKind {
+    // Parser
+    DIAG_EXPECTED_TOKEN,          // a: expected, b: got, subject: literal
+    DIAG_NO_PREFIX_PARSE,         // a: token, subject: literal
+    DIAG_UNKNOWN_ANNOTATION,      // subject: name
+    DIAG_NOT_CALLABLE,
+
+    // Semantic analysis
+    DIAG_UNDEFINED_VARIABLE,      // subject: name
+    DIAG_UNDEFINED_FUNCTION,      // subject: name
+    DIAG_UNRESOLVED_DEFINITION,   // subject: name
+    DIAG_UNRESOLVED_ASSIGNMENT,   // subject: name, a: variable type
+    DIAG_ASSIGNMENT_MISMATCH,     // subject: name, a: expected, b: got
+    DIAG_PRINT_UNRESOLVED,
+    DIAG_ARITHMETIC_OPERANDS,     // a: operator
+    DIAG_RELATIONAL_OPERANDS,     // a: operator
+    DIAG_EQUALITY_OPERANDS,       // a: left type, b: right type, subject: operator
+    DIAG_LOGICAL_OPERANDS,        // a: operator
+    DIAG_UNSUPPORTED_BINARY,      // a: operator
+    DIAG_UNARY_INT_OPERAND,       // a: operator
+    DIAG_UNARY_BOOL_OPERAND,
+    DIAG_DEREF_NON_POINTER,       // a: operand type
+    DIAG_UNSUPPORTED_UNARY,       // a: operator
+    DIAG_CONDITION_NOT_BOOL,      // a: condition type
+    DIAG_BRANCH_MISMATCH,         // a: then type, b: else type
+    DIAG_MEMBER_ACCESS,           // subject: member, a: object type
+    DIAG_DIVISION_BY_ZERO,
+    DIAG_ASM_CONSTRAINT,          // subject: constraint
+    DIAG_ASM_OPERAND_TYPE,        // a: operand type
+    DIAG_ASM_CLOBBER,             // subject: clobber
+    DIAG_ASM_OPERAND,             // subject: operand reference, e.g. "%3"
+    DIAG_MATCH_SUBJECT,           // a: subject type
+    DIAG_MATCH_ARM_TYPE,          // a: first arm's type, b: this arm's type
+    DIAG_MATCH_DEFAULT,
+    DIAG_MATCH_RANGE,             // subject: the range, e.g. "5..2"
+
+    // Code generation (subject holds the full message)
+    DIAG_CODEGEN,
+};
+
+enum DiagnosticSeverity {
+    SEVERITY_ERROR,
+    SEVERITY_WARNING,
+};
+
+// A structured diagnostic: a kind, a source offset and the few values the message
+// refers to. Cheap to record; the text is formatted on demand.
+struct Diagnostic {
+    DiagnosticKind kind;
+    uint32_t offset = 0;
+    TokenType a = ILLEGAL;
+    TokenType b = ILLEGAL;
+    std::string subject = {};
+
+    DiagnosticSeverity severity() const;
+    std::string message() const;
+};
+
+struct SourceLocation {
+    uint32_t line = 1;   // 1-based
+    uint32_t column = 1; // 1-based, in bytes
+};
+
+// Maps byte offsets to line/column. The newline index is built on the first
+// lookup, so compiles that never report anything never scan the source twice.
+class SourceIndex {
+public:
+    explicit SourceIndex(std::string_view source) : source_(source) {}
+
+    SourceLocation locate(uint32_t offset) const;
+
+private:
+    std::string_view source_;
+    mutable std::vector<uint32_t> lineStarts_;
+    mutable bool built_ = false;
+
+    void build() const;
+};
+
+// "file:line:col: error: message"
+std::string formatDiagnostic(const Diagnostic& diag, const SourceIndex& index, std::string_view filename);
+
+// What an optimization or analysis did at a source location, for the
+// --*-report flags. Not an error or warning; never affects success.
+struct Remark {
+    uint32_t offset = 0;
+    std::string pass;    // Short pass name, e.g. "fold"
+    std::string message;
+};
+
+// "file:line:col: note: [pass] message"
+std::string formatRemark(const Remark& remark, const SourceIndex& index, std::string_view filename);
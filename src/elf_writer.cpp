@@ -0,0 +1,206 @@
+// elf_writer.cpp
+#include "elf_writer.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+
+namespace {
+
+// --- ELF constants (from the System V gABI / x86-64 psABI) ---
+
+constexpr uint16_t ET_REL = 1;
+constexpr uint16_t EM_X86_64 = 62;
+constexpr uint32_t SHT_PROGBITS = 1;
+constexpr uint32_t SHT_SYMTAB = 2;
+constexpr uint32_t SHT_STRTAB = 3;
+constexpr uint32_t SHT_RELA = 4;
+constexpr uint64_t SHF_ALLOC = 0x2;
+constexpr uint64_t SHF_EXECINSTR = 0x4;
+constexpr uint64_t SHF_INFO_LINK = 0x40;
+constexpr uint8_t STB_LOCAL = 0;
+constexpr uint8_t STB_GLOBAL = 1;
+constexpr uint8_t STT_NOTYPE = 0;
+constexpr uint8_t STT_FUNC = 2;
+constexpr uint8_t STT_SECTION = 3;
+constexpr uint32_t R_X86_64_PLT32 = 4;
+
+constexpr size_t kEhdrSize = 64;
+constexpr size_t kShdrSize = 64;
+constexpr size_t kSymSize = 24;
+constexpr size_t kRelaSize = 24;
+
+// Section indices in the order they are written
+enum SectionIndex { SEC_NULL, SEC_TEXT, SEC_RELA_TEXT, SEC_SYMTAB, SEC_STRTAB, SEC_SHSTRTAB, SEC_NOTE_STACK, SEC_COUNT };
+
+class ByteWriter {
+public:
+    std::vector<uint8_t> data;
+
+    void u8(uint8_t v) { data.push_back(v); }
+    void u16(uint16_t v) { put(v, 2); }
+    void u32(uint32_t v) { put(v, 4); }
+    void u64(uint64_t v) { put(v, 8); }
+    void bytes(const std::vector<uint8_t>& v) { data.insert(data.end(), v.begin(), v.end()); }
+    void align(size_t a) { while (data.size() % a) data.push_back(0); }
+
+private:
+    void put(uint64_t v, int n) {
+        for (int i = 0; i < n; ++i) data.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+};
+
+class StringTable {
+public:
+    std::string data = std::string(1, '\0');
+
+    uint32_t add(const std::string& s) {
+        uint32_t offset = static_cast<uint32_t>(data.size());
+        data += s;
+        data += '\0';
+        return offset;
+    }
+};
+
+struct SectionHeader {
+    uint32_t name = 0;
+    uint32_t type = 0;
+    uint64_t flags = 0;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    uint32_t link = 0;
+    uint32_t info = 0;
+    uint64_t addralign = 1;
+    uint64_t entsize = 0;
+};
+
+} // namespace
+
+std::vector<uint8_t> writeElfObject(const MachineCode& code) {
+    // --- Symbols: null, .text section, locals, then globals and undefined externals ---
+    StringTable strtab;
+    ByteWriter symtab;
+    uint32_t symbolCount = 0;
+    auto addSymbol = [&](uint32_t name, uint8_t bind, uint8_t type, uint16_t shndx, uint64_t value) {
+        symtab.u32(name);
+        symtab.u8(static_cast<uint8_t>((bind << 4) | type));
+        symtab.u8(0);      // st_other: default visibility
+        symtab.u16(shndx);
+        symtab.u64(value);
+        symtab.u64(0);     // st_size
+        ++symbolCount;
+    };
+
+    addSymbol(0, STB_LOCAL, STT_NOTYPE, 0, 0);
+    addSymbol(0, STB_LOCAL, STT_SECTION, SEC_TEXT, 0);
+    for (const auto& sym : code.symbols) {
+        if (!sym.global) addSymbol(strtab.add(sym.name), STB_LOCAL, STT_NOTYPE, SEC_TEXT, sym.offset);
+    }
+    uint32_t firstGlobal = symbolCount;
+
+    std::map<std::string, uint32_t> symbolIndex;
+    for (const auto& sym : code.symbols) {
+        if (!sym.global) continue;
+        symbolIndex[sym.name] = symbolCount;
+        addSymbol(strtab.add(sym.name), STB_GLOBAL, STT_FUNC, SEC_TEXT, sym.offset);
+    }
+    for (const auto& reloc : code.relocations) {
+        if (symbolIndex.count(reloc.symbol)) continue;
+        symbolIndex[reloc.symbol] = symbolCount;
+        addSymbol(strtab.add(reloc.symbol), STB_GLOBAL, STT_NOTYPE, 0, 0);
+    }
+
+    // --- Relocations ---
+    ByteWriter rela;
+    for (const auto& reloc : code.relocations) {
+        uint64_t sym = symbolIndex.at(reloc.symbol);
+        rela.u64(reloc.offset);
+        rela.u64((sym << 32) | R_X86_64_PLT32);
+        rela.u64(static_cast<uint64_t>(static_cast<int64_t>(reloc.addend)));
+    }
+
+    // --- Section names ---
+    StringTable shstrtab;
+    SectionHeader sections[SEC_COUNT];
+    sections[SEC_TEXT].name = shstrtab.add(".text");
+    sections[SEC_RELA_TEXT].name = shstrtab.add(".rela.text");
+    sections[SEC_SYMTAB].name = shstrtab.add(".symtab");
+    sections[SEC_STRTAB].name = shstrtab.add(".strtab");
+    sections[SEC_SHSTRTAB].name = shstrtab.add(".shstrtab");
+    sections[SEC_NOTE_STACK].name = shstrtab.add(".note.GNU-stack");
+
+    // --- Layout: header, section contents, section header table ---
+    ByteWriter out;
+    out.data.resize(kEhdrSize);
+
+    auto place = [&](SectionIndex index, const std::vector<uint8_t>& contents, size_t align) {
+        out.align(align);
+        sections[index].offset = out.data.size();
+        sections[index].size = contents.size();
+        sections[index].addralign = align;
+        out.bytes(contents);
+    };
+    auto asBytes = [](const std::string& s) { return std::vector<uint8_t>(s.begin(), s.end()); };
+
+    place(SEC_TEXT, code.bytes, 16);
+    sections[SEC_TEXT].type = SHT_PROGBITS;
+    sections[SEC_TEXT].flags = SHF_ALLOC | SHF_EXECINSTR;
+
+    place(SEC_RELA_TEXT, rela.data, 8);
+    sections[SEC_RELA_TEXT].type = SHT_RELA;
+    sections[SEC_RELA_TEXT].flags = SHF_INFO_LINK;
+    sections[SEC_RELA_TEXT].link = SEC_SYMTAB;
+    sections[SEC_RELA_TEXT].info = SEC_TEXT;
+    sections[SEC_RELA_TEXT].entsize = kRelaSize;
+
+    place(SEC_SYMTAB, symtab.data, 8);
+    sections[SEC_SYMTAB].type = SHT_SYMTAB;
+    sections[SEC_SYMTAB].link = SEC_STRTAB;
+    sections[SEC_SYMTAB].info = firstGlobal;
+    sections[SEC_SYMTAB].entsize = kSymSize;
+
+    place(SEC_STRTAB, asBytes(strtab.data), 1);
+    sections[SEC_STRTAB].type = SHT_STRTAB;
+
+    place(SEC_SHSTRTAB, asBytes(shstrtab.data), 1);
+    sections[SEC_SHSTRTAB].type = SHT_STRTAB;
+
+    sections[SEC_NOTE_STACK].type = SHT_PROGBITS; // Empty: marks the stack non-executable
+    sections[SEC_NOTE_STACK].offset = out.data.size();
+
+    out.align(8);
+    uint64_t shoff = out.data.size();
+    for (const auto& sh : sections) {
+        out.u32(sh.name);
+        out.u32(sh.type);
+        out.u64(sh.flags);
+        out.u64(0); // sh_addr
+        out.u64(sh.offset);
+        out.u64(sh.size);
+        out.u32(sh.link);
+        out.u32(sh.info);
+        out.u64(sh.addralign);
+        out.u64(sh.entsize);
+    }
+
+    // --- ELF header ---
+    ByteWriter ehdr;
+    const uint8_t ident[16] = { 0x7F, 'E', 'L', 'F', 2 /* 64-bit */, 1 /* little-endian */, 1 /* EV_CURRENT */, 0 /* SysV ABI */ };
+    for (uint8_t b : ident) ehdr.u8(b);
+    ehdr.u16(ET_REL);
+    ehdr.u16(EM_X86_64);
+    ehdr.u32(1);            // e_version
+    ehdr.u64(0);            // e_entry
+    ehdr.u64(0);            // e_phoff
+    ehdr.u64(shoff);
+    ehdr.u32(0);            // e_flags
+    ehdr.u16(kEhdrSize);
+    ehdr.u16(0);            // e_phentsize
+    ehdr.u16(0);            // e_phnum
+    ehdr.u16(kShdrSize);
+    ehdr.u16(SEC_COUNT);
+    ehdr.u16(SEC_SHSTRTAB);
+    std::copy(ehdr.data.begin(), ehdr.data.end(), out.data.begin());
+
+    return out.data;
+}
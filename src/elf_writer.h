@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "x86_assembler.h"
+
+// Serializes assembled code as an ELF64 x86-64 relocatable object (.o) with a
+// single .text section. Calls to undefined symbols become R_X86_64_PLT32
+// relocations, so the result links like the output of `as`.
+std::vector<uint8_t> writeElfObject(const MachineCode& code);
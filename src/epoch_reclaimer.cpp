@@ -0,0 +1,50 @@
+// epoch_reclaimer.cpp
+#include "epoch_reclaimer.h"
+
+#include <algorithm>
+
+EpochReclaimer::~EpochReclaimer() {
+    for (auto& r : retired_) r.destroy();
+}
+
+EpochReclaimer::Participant* EpochReclaimer::registerThread() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    participants_.push_back(std::make_unique<Participant>());
+    return participants_.back().get();
+}
+
+void EpochReclaimer::unregisterThread(Participant* participant) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    participants_.erase(std::remove_if(participants_.begin(), participants_.end(),
+        [&](const std::unique_ptr<Participant>& p) { return p.get() == participant; }), participants_.end());
+}
+
+void EpochReclaimer::retire(std::function<void()> destroy) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // A reader that saw the object pinned an epoch <= the one returned here;
+    // readers pinning afterwards see a later epoch and can no longer reach it.
+    uint64_t epoch = globalEpoch_.fetch_add(1, std::memory_order_seq_cst);
+    retired_.push_back({ epoch, std::move(destroy) });
+}
+
+size_t EpochReclaimer::collect() {
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t oldestPinned = UINT64_MAX;
+        for (const auto& p : participants_) {
+            oldestPinned = std::min(oldestPinned, p->epoch_.load(std::memory_order_seq_cst));
+        }
+        auto keep = std::partition(retired_.begin(), retired_.end(),
+            [&](const Retired& r) { return r.epoch >= oldestPinned; });
+        for (auto it = keep; it != retired_.end(); ++it) ready.push_back(std::move(it->destroy));
+        retired_.erase(keep, retired_.end());
+    }
+    for (auto& destroy : ready) destroy();
+    return ready.size();
+}
+
+size_t EpochReclaimer::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return retired_.size();
+}
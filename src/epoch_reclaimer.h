@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Epoch-based reclamation. Readers pin the current epoch while they may touch
+// a shared object (e.g. run JIT code reached through a stub); writers unlink an
+// object and retire it with a destructor. A retired object is destroyed once
+// every registered thread is either idle or has pinned a later epoch, so no
+// thread can still be using it.
+class EpochReclaimer {
+public:
+    // One per thread that pins. Threads register once and reuse their participant.
+    class Participant {
+    public:
+        Participant() = default;
+        Participant(const Participant&) = delete;
+        Participant& operator=(const Participant&) = delete;
+
+    private:
+        friend class EpochReclaimer;
+        std::atomic<uint64_t> epoch_{ kIdle };
+    };
+
+    EpochReclaimer() = default;
+    ~EpochReclaimer(); // Runs every pending destructor
+    EpochReclaimer(const EpochReclaimer&) = delete;
+    EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+
+    Participant* registerThread();
+    void unregisterThread(Participant* participant);
+
+    // Reader side. Cheap: one load of the global epoch and one store.
+    void enter(Participant* participant) {
+        participant->epoch_.store(globalEpoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+    }
+    void exit(Participant* participant) {
+        participant->epoch_.store(kIdle, std::memory_order_release);
+    }
+
+    // Writer side: call after the object has been unlinked.
+    void retire(std::function<void()> destroy);
+    // Destroys what no thread can still see. Returns how many objects were freed.
+    size_t collect();
+    size_t pending() const;
+
+private:
+    static constexpr uint64_t kIdle = UINT64_MAX;
+
+    struct Retired {
+        uint64_t epoch;
+        std::function<void()> destroy;
+    };
+
+    std::atomic<uint64_t> globalEpoch_{ 0 };
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Participant>> participants_;
+    std::vector<Retired> retired_;
+};
+
+// Pins the current epoch for the lifetime of the guard.
+class EpochGuard {
+public:
+    EpochGuard(EpochReclaimer& reclaimer, EpochReclaimer::Participant* participant)
+        : reclaimer_(reclaimer), participant_(participant) {
+        reclaimer_.enter(participant_);
+    }
+    ~EpochGuard() { reclaimer_.exit(participant_); }
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+
+private:
+    EpochReclaimer& reclaimer_;
+    EpochReclaimer::Participant* participant_;
+};
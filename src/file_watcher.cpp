@@ -0,0 +1,130 @@
+// file_watcher.cpp
+#include "file_watcher.h"
+
+#include <algorithm>
+#include <set>
+#include <system_error>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+std::vector<fs::path> FileWatcher::scan() const {
+    std::vector<fs::path> files;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(root_, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file(ec) && matches(it->path())) files.push_back(it->path());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+#if defined(__linux__)
+
+FileWatcher::FileWatcher(const fs::path& root, std::string extension) : root_(root), extension_(std::move(extension)) {
+    fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd_ < 0) {
+        error_ = std::string("inotify_init1: ") + std::strerror(errno);
+        return;
+    }
+    addWatches(root_);
+    ok_ = !watches_.empty();
+    if (!ok_) error_ = "could not watch " + root_.string();
+}
+
+FileWatcher::~FileWatcher() {
+    if (fd_ >= 0) close(fd_);
+}
+
+void FileWatcher::addWatches(const fs::path& dir) {
+    // Writes finish with IN_CLOSE_WRITE; editors that save via rename produce IN_MOVED_TO.
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_MOVED_FROM;
+    int wd = inotify_add_watch(fd_, dir.c_str(), mask);
+    if (wd >= 0) watches_[wd] = dir;
+
+    std::error_code ec;
+    for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_directory(ec) && !it->is_symlink(ec)) addWatches(it->path());
+    }
+}
+
+std::vector<fs::path> FileWatcher::wait(std::chrono::milliseconds timeout) {
+    std::set<fs::path> changed;
+    alignas(inotify_event) char buffer[16 * 1024];
+
+    pollfd pfd{ fd_, POLLIN, 0 };
+    if (poll(&pfd, 1, static_cast<int>(timeout.count())) <= 0) return {};
+
+    // Drain everything that arrives in a short burst so one save is one rebuild.
+    for (;;) {
+        ssize_t n = read(fd_, buffer, sizeof(buffer));
+        if (n <= 0) {
+            if (poll(&pfd, 1, 5) <= 0) break;
+            continue;
+        }
+        for (char* p = buffer; p < buffer + n;) {
+            auto* event = reinterpret_cast<inotify_event*>(p);
+            p += sizeof(inotify_event) + event->len;
+            auto dir = watches_.find(event->wd);
+            if (dir == watches_.end() || event->len == 0) continue;
+
+            fs::path path = dir->second / event->name;
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    addWatches(path);
+                    for (const auto& f : scan()) {
+                        if (f.native().compare(0, path.native().size(), path.native()) == 0) changed.insert(f);
+                    }
+                }
+                continue;
+            }
+            // IN_CREATE alone is followed by IN_CLOSE_WRITE once the content is there.
+            if (matches(path) && !(event->mask == IN_CREATE)) changed.insert(path);
+        }
+    }
+    return { changed.begin(), changed.end() };
+}
+
+#else
+
+FileWatcher::FileWatcher(const fs::path& root, std::string extension) : root_(root), extension_(std::move(extension)) {
+    std::error_code ec;
+    ok_ = fs::is_directory(root_, ec);
+    if (!ok_) {
+        error_ = "not a directory: " + root_.string();
+        return;
+    }
+    for (const auto& f : scan()) mtimes_[f] = fs::last_write_time(f, ec);
+}
+
+FileWatcher::~FileWatcher() = default;
+
+std::vector<fs::path> FileWatcher::wait(std::chrono::milliseconds timeout) {
+    const auto pollInterval = std::chrono::milliseconds(50);
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (;;) {
+        std::vector<fs::path> changed;
+        std::map<fs::path, fs::file_time_type> current;
+        std::error_code ec;
+        for (const auto& f : scan()) {
+            current[f] = fs::last_write_time(f, ec);
+            auto it = mtimes_.find(f);
+            if (it == mtimes_.end() || it->second != current[f]) changed.push_back(f);
+        }
+        for (const auto& [f, t] : mtimes_) {
+            if (!current.count(f)) changed.push_back(f);
+        }
+        mtimes_ = std::move(current);
+        if (!changed.empty() || std::chrono::steady_clock::now() >= deadline) return changed;
+        std::this_thread::sleep_for(pollInterval);
+    }
+}
+
+#endif
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+// Reports files under a directory tree that were written, created, moved in or
+// removed. Uses inotify on Linux and falls back to polling modification times
+// elsewhere.
+class FileWatcher {
+public:
+    explicit FileWatcher(const std::filesystem::path& root, std::string extension);
+    ~FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    bool ok() const { return ok_; }
+    const std::string& error() const { return error_; }
+
+    // Every matching file currently in the tree.
+    std::vector<std::filesystem::path> scan() const;
+
+    // Blocks up to `timeout` for changes and returns the changed paths,
+    // de-duplicated. Editors that save in several steps are coalesced.
+    std::vector<std::filesystem::path> wait(std::chrono::milliseconds timeout);
+
+private:
+    std::filesystem::path root_;
+    std::string extension_;
+    bool ok_ = false;
+    std::string error_;
+
+#if defined(__linux__)
+    int fd_ = -1;
+    std::map<int, std::filesystem::path> watches_;
+    void addWatches(const std::filesystem::path& dir);
+#else
+    std::map<std::filesystem::path, std::filesystem::file_time_type> mtimes_;
+#endif
+
+    bool matches(const std::filesystem::path& p) const { return p.extension() == extension_; }
+};
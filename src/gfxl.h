@@ -0,0 +1,109 @@
+/* gfxl.h - embeddable GFXL compiler (libgfxl)
+ *
+ * Compiles GFXL source held in memory to assembly text, raw x86-64 machine code
+ * or an ELF object without touching the filesystem. A context owns the result of
+ * its most recent compile; the library has no global mutable state, so separate
+ * contexts may be used from separate threads concurrently. A single context must
+ * not be used by two threads at once.
+ *
+ *     gfxl_context* ctx = gfxl_context_create();
+ *     if (gfxl_compile(ctx, src, len, GFXL_OUTPUT_OBJECT) != GFXL_OK) {
+ *         for (size_t i = 0; i < gfxl_diagnostic_count(ctx); ++i)
+ *             fprintf(stderr, "%s\n", gfxl_diagnostic_format(ctx, i, "snippet.glx"));
+ *     }
+ *     size_t size;
+ *     const uint8_t* obj = gfxl_output(ctx, &size);
+ *     gfxl_context_destroy(ctx);
+ */
+#ifndef GFXL_H
+#define GFXL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(GFXL_SHARED)
+#  if defined(_WIN32)
+#    if defined(GFXL_BUILD)
+#      define GFXL_API __declspec(dllexport)
+#    else
+#      define GFXL_API __declspec(dllimport)
+#    endif
+#  else
+#    define GFXL_API __attribute__((visibility("default")))
+#  endif
+#else
+#  define GFXL_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct gfxl_context gfxl_context;
+
+typedef enum gfxl_status {
+    GFXL_OK = 0,
+    GFXL_ERROR_PARSE,
+    GFXL_ERROR_SEMANTIC,
+    GFXL_ERROR_CODEGEN,
+    GFXL_ERROR_INVALID_ARGUMENT,
+} gfxl_status;
+
+typedef enum gfxl_output_kind {
+    GFXL_OUTPUT_ASSEMBLY = 0,    /* Intel-syntax GNU as text, NUL-terminated */
+    GFXL_OUTPUT_MACHINE_CODE,    /* .text bytes; see gfxl_relocation_* and gfxl_symbol_offset */
+    GFXL_OUTPUT_OBJECT,          /* ELF64 relocatable object */
+    GFXL_OUTPUT_C,               /* Portable C11 source, NUL-terminated */
+} gfxl_output_kind;
+
+typedef enum gfxl_severity {
+    GFXL_SEVERITY_ERROR = 0,
+    GFXL_SEVERITY_WARNING,
+} gfxl_severity;
+
+/* A PC-relative 32-bit fixup: write (int32_t)(S + addend - P) at bytes + offset,
+ * where S is the symbol's address and P the address of the field. */
+typedef struct gfxl_relocation {
+    uint32_t offset;
+    int32_t addend;
+    const char* symbol;
+} gfxl_relocation;
+
+/* --- Contexts --- */
+GFXL_API gfxl_context* gfxl_context_create(void);
+GFXL_API void gfxl_context_destroy(gfxl_context* ctx);
+
+/* Symbol the program is compiled into (default "main"). */
+GFXL_API gfxl_status gfxl_set_entry_name(gfxl_context* ctx, const char* name);
+
+/* Nonzero selects size-optimized code generation (-Os); default 0. */
+GFXL_API gfxl_status gfxl_set_optimize_size(gfxl_context* ctx, int enabled);
+
+/* --- Compiling --- */
+GFXL_API gfxl_status gfxl_compile(gfxl_context* ctx, const char* source, size_t length, gfxl_output_kind kind);
+
+/* Output of the last successful compile; valid until the next compile or destroy. */
+GFXL_API const uint8_t* gfxl_output(const gfxl_context* ctx, size_t* size);
+
+/* Machine-code output only. */
+GFXL_API size_t gfxl_relocation_count(const gfxl_context* ctx);
+GFXL_API gfxl_relocation gfxl_relocation_get(const gfxl_context* ctx, size_t index);
+/* Offset of a global symbol in the machine code, or -1 if it does not exist. */
+GFXL_API int64_t gfxl_symbol_offset(const gfxl_context* ctx, const char* name);
+
+/* --- Diagnostics of the last compile --- */
+GFXL_API size_t gfxl_diagnostic_count(const gfxl_context* ctx);
+GFXL_API gfxl_severity gfxl_diagnostic_severity(const gfxl_context* ctx, size_t index);
+GFXL_API const char* gfxl_diagnostic_message(gfxl_context* ctx, size_t index);
+GFXL_API uint32_t gfxl_diagnostic_line(gfxl_context* ctx, size_t index);
+GFXL_API uint32_t gfxl_diagnostic_column(gfxl_context* ctx, size_t index);
+/* "filename:line:col: error: message"; filename may be NULL. */
+GFXL_API const char* gfxl_diagnostic_format(gfxl_context* ctx, size_t index, const char* filename);
+
+GFXL_API const char* gfxl_status_string(gfxl_status status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GFXL_H */
@@ -0,0 +1,172 @@
+// gfxl_api.cpp
+// C API over compileSource(). All state lives in the gfxl_context.
+#include "gfxl.h"
+
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "compiler.h"
+#include "diagnostics.h"
+
+struct gfxl_context {
+    std::string entryName = "main";
+    bool optimizeSize = false;
+    gfxl_output_kind kind = GFXL_OUTPUT_ASSEMBLY;
+    std::string source;                // Kept for line/column lookups
+    std::unique_ptr<SourceIndex> index;
+    CompileResult result;
+
+    // Strings handed out to the caller, produced on first request
+    std::vector<std::string> messages;
+    std::vector<std::string> formatted;
+};
+
+static gfxl_status statusFor(const std::vector<Diagnostic>& diagnostics) {
+    for (const auto& d : diagnostics) {
+        if (d.severity() != SEVERITY_ERROR) continue;
+        if (d.kind <= DIAG_NOT_CALLABLE) return GFXL_ERROR_PARSE;
+        if (d.kind == DIAG_CODEGEN) return GFXL_ERROR_CODEGEN;
+        return GFXL_ERROR_SEMANTIC;
+    }
+    return GFXL_ERROR_CODEGEN;
+}
+
+static bool validDiagnostic(const gfxl_context* ctx, size_t index) {
+    return ctx && index < ctx->result.diagnostics.size();
+}
+
+extern "C" {
+
+gfxl_context* gfxl_context_create(void) {
+    return new (std::nothrow) gfxl_context();
+}
+
+void gfxl_context_destroy(gfxl_context* ctx) {
+    delete ctx;
+}
+
+gfxl_status gfxl_set_entry_name(gfxl_context* ctx, const char* name) {
+    if (!ctx || !name || !*name) return GFXL_ERROR_INVALID_ARGUMENT;
+    ctx->entryName = name;
+    return GFXL_OK;
+}
+
+gfxl_status gfxl_set_optimize_size(gfxl_context* ctx, int enabled) {
+    if (!ctx) return GFXL_ERROR_INVALID_ARGUMENT;
+    ctx->optimizeSize = enabled != 0;
+    return GFXL_OK;
+}
+
+gfxl_status gfxl_compile(gfxl_context* ctx, const char* source, size_t length, gfxl_output_kind kind) {
+    if (!ctx || (!source && length)) return GFXL_ERROR_INVALID_ARGUMENT;
+
+    CompileOptions options;
+    options.entryName = ctx->entryName;
+    options.optimizeSize = ctx->optimizeSize;
+    switch (kind) {
+    case GFXL_OUTPUT_ASSEMBLY: options.output = OUTPUT_ASSEMBLY; break;
+    case GFXL_OUTPUT_MACHINE_CODE: options.output = OUTPUT_MACHINE_CODE; break;
+    case GFXL_OUTPUT_OBJECT: options.output = OUTPUT_OBJECT; break;
+    case GFXL_OUTPUT_C: options.output = OUTPUT_C; break;
+    default: return GFXL_ERROR_INVALID_ARGUMENT;
+    }
+
+    ctx->kind = kind;
+    ctx->source.assign(source ? source : "", length);
+    ctx->index = std::make_unique<SourceIndex>(ctx->source);
+    ctx->result = compileSource(ctx->source, options);
+    ctx->messages.assign(ctx->result.diagnostics.size(), std::string());
+    ctx->formatted.assign(ctx->result.diagnostics.size(), std::string());
+
+    return ctx->result.ok ? GFXL_OK : statusFor(ctx->result.diagnostics);
+}
+
+const uint8_t* gfxl_output(const gfxl_context* ctx, size_t* size) {
+    if (size) *size = 0;
+    if (!ctx || !ctx->result.ok) return nullptr;
+
+    const CompileResult& r = ctx->result;
+    switch (ctx->kind) {
+    case GFXL_OUTPUT_ASSEMBLY:
+        if (size) *size = r.assembly.size();
+        return reinterpret_cast<const uint8_t*>(r.assembly.c_str());
+    case GFXL_OUTPUT_MACHINE_CODE:
+        if (size) *size = r.machineCode.bytes.size();
+        return r.machineCode.bytes.data();
+    case GFXL_OUTPUT_OBJECT:
+        if (size) *size = r.object.size();
+        return r.object.data();
+    case GFXL_OUTPUT_C:
+        if (size) *size = r.cSource.size();
+        return reinterpret_cast<const uint8_t*>(r.cSource.c_str());
+    }
+    return nullptr;
+}
+
+size_t gfxl_relocation_count(const gfxl_context* ctx) {
+    return ctx ? ctx->result.machineCode.relocations.size() : 0;
+}
+
+gfxl_relocation gfxl_relocation_get(const gfxl_context* ctx, size_t index) {
+    gfxl_relocation out = { 0, 0, nullptr };
+    if (!ctx || index >= ctx->result.machineCode.relocations.size()) return out;
+    const Relocation& r = ctx->result.machineCode.relocations[index];
+    out.offset = r.offset;
+    out.addend = r.addend;
+    out.symbol = r.symbol.c_str();
+    return out;
+}
+
+int64_t gfxl_symbol_offset(const gfxl_context* ctx, const char* name) {
+    if (!ctx || !name) return -1;
+    const CodeSymbol* sym = ctx->result.machineCode.findSymbol(name);
+    return sym ? static_cast<int64_t>(sym->offset) : -1;
+}
+
+size_t gfxl_diagnostic_count(const gfxl_context* ctx) {
+    return ctx ? ctx->result.diagnostics.size() : 0;
+}
+
+gfxl_severity gfxl_diagnostic_severity(const gfxl_context* ctx, size_t index) {
+    if (!validDiagnostic(ctx, index)) return GFXL_SEVERITY_ERROR;
+    return ctx->result.diagnostics[index].severity() == SEVERITY_WARNING ? GFXL_SEVERITY_WARNING : GFXL_SEVERITY_ERROR;
+}
+
+const char* gfxl_diagnostic_message(gfxl_context* ctx, size_t index) {
+    if (!validDiagnostic(ctx, index)) return "";
+    std::string& msg = ctx->messages[index];
+    if (msg.empty()) msg = ctx->result.diagnostics[index].message();
+    return msg.c_str();
+}
+
+uint32_t gfxl_diagnostic_line(gfxl_context* ctx, size_t index) {
+    if (!validDiagnostic(ctx, index)) return 0;
+    return ctx->index->locate(ctx->result.diagnostics[index].offset).line;
+}
+
+uint32_t gfxl_diagnostic_column(gfxl_context* ctx, size_t index) {
+    if (!validDiagnostic(ctx, index)) return 0;
+    return ctx->index->locate(ctx->result.diagnostics[index].offset).column;
+}
+
+const char* gfxl_diagnostic_format(gfxl_context* ctx, size_t index, const char* filename) {
+    if (!validDiagnostic(ctx, index)) return "";
+    std::string& out = ctx->formatted[index];
+    out = formatDiagnostic(ctx->result.diagnostics[index], *ctx->index, filename ? filename : "<input>");
+    return out.c_str();
+}
+
+const char* gfxl_status_string(gfxl_status status) {
+    switch (status) {
+    case GFXL_OK: return "ok";
+    case GFXL_ERROR_PARSE: return "parse error";
+    case GFXL_ERROR_SEMANTIC: return "semantic error";
+    case GFXL_ERROR_CODEGEN: return "code generation error";
+    case GFXL_ERROR_INVALID_ARGUMENT: return "invalid argument";
+    }
+    return "unknown status";
+}
+
+} // extern "C"
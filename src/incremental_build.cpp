@@ -0,0 +1,109 @@
+// incremental_build.cpp
+#include "incremental_build.h"
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+#include "diagnostics.h"
+
+namespace fs = std::filesystem;
+
+static uint64_t fnv1a(const std::string& data) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+bool writeFileAtomically(const fs::path& path, const void* data, size_t size, std::string& error) {
+    fs::path tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            error = "could not open " + tmp.string() + " for writing";
+            return false;
+        }
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        if (!out) {
+            error = "could not write " + tmp.string();
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        error = "could not replace " + path.string() + ": " + ec.message();
+        fs::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+fs::path IncrementalBuilder::artifactFor(const fs::path& source) const {
+    fs::path artifact = source;
+    artifact.replace_extension(options_.output == OUTPUT_OBJECT ? ".o" : options_.output == OUTPUT_C ? ".c" : ".s");
+    return artifact;
+}
+
+BuildUnitResult IncrementalBuilder::build(const fs::path& source) {
+    auto start = std::chrono::steady_clock::now();
+    BuildUnitResult result;
+    result.source = source;
+    result.artifact = artifactFor(source);
+    auto finish = [&](BuildStatus status) {
+        result.status = status;
+        result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    };
+
+    std::error_code ec;
+    if (!fs::exists(source, ec)) {
+        units_.erase(source);
+        fs::remove(result.artifact, ec);
+        return finish(BUILD_REMOVED);
+    }
+
+    std::ifstream in(source, std::ios::binary);
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    std::string text = ss.str();
+
+    uint64_t hash = fnv1a(text);
+    auto cached = units_.find(source);
+    if (cached != units_.end() && cached->second.contentHash == hash) {
+        // Saved without changes (or touched): the artifact on disk is current.
+        result.messages = cached->second.messages;
+        return finish(cached->second.ok ? BUILD_UP_TO_DATE : BUILD_FAILED);
+    }
+
+    CompileResult compiled = compileSource(text, options_);
+    Unit& unit = units_[source];
+    unit.contentHash = hash;
+    unit.ok = compiled.ok;
+    unit.messages.clear();
+
+    SourceIndex index(text);
+    for (const auto& d : compiled.diagnostics) {
+        unit.messages.push_back(formatDiagnostic(d, index, source.string()));
+    }
+    if (compiled.ok) {
+        std::string error;
+        bool written = options_.output == OUTPUT_OBJECT
+            ? writeFileAtomically(result.artifact, compiled.object.data(), compiled.object.size(), error)
+            : options_.output == OUTPUT_C
+            ? writeFileAtomically(result.artifact, compiled.cSource.data(), compiled.cSource.size(), error)
+            : writeFileAtomically(result.artifact, compiled.assembly.data(), compiled.assembly.size(), error);
+        if (!written) {
+            unit.ok = false;
+            unit.contentHash = 0; // Retry on the next event
+            unit.messages.push_back(error);
+        }
+    }
+    result.messages = unit.messages;
+    return finish(unit.ok ? BUILD_BUILT : BUILD_FAILED);
+}
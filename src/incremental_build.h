@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "compiler.h"
+
+enum BuildStatus {
+    BUILD_BUILT,
+    BUILD_UP_TO_DATE, // Content hash unchanged since the last build
+    BUILD_FAILED,
+    BUILD_REMOVED,    // Source deleted; its artifact was removed too
+};
+
+struct BuildUnitResult {
+    std::filesystem::path source;
+    std::filesystem::path artifact;
+    BuildStatus status = BUILD_FAILED;
+    double milliseconds = 0.0;
+    std::vector<std::string> messages; // Formatted diagnostics
+};
+
+// Keeps one cache entry per .glx unit and rebuilds a unit only when its
+// content changed. Every unit is independent (the language has no imports),
+// so a change never invalidates another unit. Artifacts are written next to
+// the source and replaced atomically.
+class IncrementalBuilder {
+public:
+    explicit IncrementalBuilder(const CompileOptions& options) : options_(options) {}
+
+    BuildUnitResult build(const std::filesystem::path& source);
+    std::filesystem::path artifactFor(const std::filesystem::path& source) const;
+
+private:
+    struct Unit {
+        uint64_t contentHash = 0;
+        bool ok = false;
+        std::vector<std::string> messages;
+    };
+
+    CompileOptions options_;
+    std::map<std::filesystem::path, Unit> units_;
+};
+
+// Writes to a temporary file in the same directory and renames it over `path`,
+// so readers see either the old or the new artifact, never a partial one.
+bool writeFileAtomically(const std::filesystem::path& path, const void* data, size_t size, std::string& error);
@@ -0,0 +1,114 @@
+// inline_asm.cpp
+#include "inline_asm.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+struct RegisterNames {
+    const char* q; // 64-bit
+    const char* d; // 32-bit
+    const char* w; // 16-bit
+    const char* b; // 8-bit
+};
+
+const RegisterNames kRegisters[] = {
+    {"rax", "eax", "ax", "al"},     {"rcx", "ecx", "cx", "cl"},     {"rdx", "edx", "dx", "dl"},
+    {"rbx", "ebx", "bx", "bl"},     {"rsp", "esp", "sp", "spl"},    {"rbp", "ebp", "bp", "bpl"},
+    {"rsi", "esi", "si", "sil"},    {"rdi", "edi", "di", "dil"},    {"r8", "r8d", "r8w", "r8b"},
+    {"r9", "r9d", "r9w", "r9b"},    {"r10", "r10d", "r10w", "r10b"}, {"r11", "r11d", "r11w", "r11b"},
+    {"r12", "r12d", "r12w", "r12b"}, {"r13", "r13d", "r13w", "r13b"}, {"r14", "r14d", "r14w", "r14b"},
+    {"r15", "r15d", "r15w", "r15b"},
+};
+
+const RegisterNames* findRegister(const std::string& reg64) {
+    for (const auto& r : kRegisters) {
+        if (reg64 == r.q) return &r;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+AsmConstraint parseAsmConstraint(const std::string& text, bool output) {
+    AsmConstraint c;
+    std::string letters = text;
+    if (output) {
+        if (letters.empty() || (letters[0] != '=' && letters[0] != '+')) return c;
+        c.readWrite = letters[0] == '+';
+        letters.erase(0, 1);
+    }
+    if (letters.size() != 1) return c;
+
+    switch (letters[0]) {
+    case 'r': case 'm': c.kind = letters[0]; break;
+    case 'i': if (output) return c; c.kind = 'i'; break;
+    case 'a': c.fixedRegister = "rax"; break;
+    case 'b': c.fixedRegister = "rbx"; break;
+    case 'c': c.fixedRegister = "rcx"; break;
+    case 'd': c.fixedRegister = "rdx"; break;
+    case 'S': c.fixedRegister = "rsi"; break;
+    case 'D': c.fixedRegister = "rdi"; break;
+    default: return c;
+    }
+    c.valid = true;
+    return c;
+}
+
+std::string canonicalRegister(const std::string& name) {
+    for (const auto& r : kRegisters) {
+        if (name == r.q || name == r.d || name == r.w || name == r.b) return r.q;
+    }
+    return "";
+}
+
+std::string registerPart(const std::string& reg64, int bytes) {
+    const RegisterNames* r = findRegister(reg64);
+    if (!r) return reg64;
+    switch (bytes) {
+    case 1: return r->b;
+    case 2: return r->w;
+    case 4: return r->d;
+    default: return r->q;
+    }
+}
+
+bool isCalleeSaved(const std::string& reg64) {
+    return reg64 == "rbx" || reg64 == "rbp" || reg64 == "r12" || reg64 == "r13" || reg64 == "r14" || reg64 == "r15";
+}
+
+bool substituteAsmOperands(const std::string& line, const std::vector<std::string>& operands,
+                           std::string& out, std::string& bad) {
+    out.clear();
+    for (size_t i = 0; i < line.size(); ++i) {
+        if (line[i] != '%') {
+            out += line[i];
+            continue;
+        }
+        size_t start = i;
+        if (i + 1 < line.size() && line[i + 1] == '%') {
+            out += '%';
+            ++i;
+            continue;
+        }
+        int bytes = 8;
+        if (i + 1 < line.size() && std::string("bwkq").find(line[i + 1]) != std::string::npos) {
+            bytes = line[i + 1] == 'b' ? 1 : line[i + 1] == 'w' ? 2 : line[i + 1] == 'k' ? 4 : 8;
+            ++i;
+        }
+        size_t digits = i + 1;
+        size_t index = 0;
+        while (digits < line.size() && std::isdigit(static_cast<unsigned char>(line[digits]))) {
+            index = index * 10 + (line[digits] - '0');
+            ++digits;
+        }
+        if (digits == i + 1 || index >= operands.size()) {
+            bad = line.substr(start, std::max(digits, i + 1) - start);
+            return false;
+        }
+        out += registerPart(operands[index], bytes);
+        i = digits - 1;
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Helpers shared by semantic analysis and code generation for asm_ blocks.
+// Templates are Intel syntax, like the rest of the generated assembly.
+
+// How an operand reaches the template, from its GCC-style constraint string.
+//   "r"  any free register      "a" "b" "c" "d" "S" "D"  rax rbx rcx rdx rsi rdi
+//   "m"  the variable's stack slot (identifiers only)
+//   "i"  an integer literal substituted as an immediate (inputs only)
+// Outputs start with "=" (write-only) or "+" (read and written).
+struct AsmConstraint {
+    bool valid = false;
+    bool readWrite = false;    // "+": the output's old value is loaded first
+    char kind = 'r';           // 'r', 'm' or 'i'
+    std::string fixedRegister; // 64-bit name for the single-register letters, else empty
+};
+
+AsmConstraint parseAsmConstraint(const std::string& text, bool output);
+
+// Canonical 64-bit name of a general-purpose register ("eax" and "al" -> "rax"),
+// or "" if `name` is not one.
+std::string canonicalRegister(const std::string& name);
+
+// `reg64` at a width of 1, 2, 4 or 8 bytes ("rax", 4 -> "eax").
+std::string registerPart(const std::string& reg64, int bytes);
+
+// rbx, rbp and r12-r15 must survive the generated function.
+bool isCalleeSaved(const std::string& reg64);
+
+// Replaces %N (and %bN %wN %kN %qN for an 8/16/32/64-bit register) with
+// operands[N], and %% with %. A register operand is its 64-bit name; anything
+// else (a memory reference or an immediate) is substituted unchanged. Returns
+// false and sets `bad` to the offending reference if N is out of range.
+bool substituteAsmOperands(const std::string& line, const std::vector<std::string>& operands,
+                           std::string& out, std::string& bad);
@@ -0,0 +1,253 @@
+// jit.cpp
+#include "jit.h"
+
+#include <cstring>
+
+#include "compiler.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Every script is compiled into this symbol; the engine keys scripts by name instead.
+const char* const kEntrySymbol = "gfxl_entry";
+
+// --- Executable memory ---
+
+size_t pageSize() {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+size_t roundToPages(size_t size) {
+    size_t page = pageSize();
+    return (size + page - 1) / page * page;
+}
+
+// Mapped read-write; flipped to read-execute once written (W^X).
+uint8_t* mapPages(size_t size) {
+#if defined(_WIN32)
+    return static_cast<uint8_t*>(VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+#else
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? nullptr : static_cast<uint8_t*>(p);
+#endif
+}
+
+bool makeExecutable(uint8_t* p, size_t size) {
+#if defined(_WIN32)
+    DWORD old;
+    if (!VirtualProtect(p, size, PAGE_EXECUTE_READ, &old)) return false;
+    FlushInstructionCache(GetCurrentProcess(), p, size);
+    return true;
+#else
+    return mprotect(p, size, PROT_READ | PROT_EXEC) == 0;
+#endif
+}
+
+void unmapPages(uint8_t* p, size_t size) {
+#if defined(_WIN32)
+    (void)size;
+    VirtualFree(p, 0, MEM_RELEASE);
+#else
+    munmap(p, size);
+#endif
+}
+
+void writeRel32(uint8_t* field, const uint8_t* target) {
+    int32_t rel = static_cast<int32_t>(target - (field + 4));
+    std::memcpy(field, &rel, 4);
+}
+
+// `jmp qword ptr [rip+disp32]`
+constexpr uint8_t kJmpIndirect[] = { 0xFF, 0x25 };
+constexpr size_t kStubSize = 8;     // 6-byte jmp + 2 bytes of int3 padding
+constexpr size_t kVeneerSize = 16;  // jmp [rip+2], int3 x2, then the 8-byte target
+
+} // namespace
+
+// One compiled version of a script: its code followed by veneers that reach
+// host functions further than rel32 away.
+struct JitEngine::CodeBlock {
+    uint8_t* base = nullptr;
+    size_t size = 0;
+    JitEngine::Entry entry = nullptr;
+};
+
+// A page of stubs followed by a page of slots. The stub page is executable and
+// never written after creation; swaps only store to the read-write slot page.
+struct JitEngine::StubRegion {
+    uint8_t* base = nullptr;
+    size_t pageBytes = 0;
+    size_t used = 0;
+
+    size_t capacity() const { return pageBytes / kStubSize; }
+    uint8_t* stub(size_t i) const { return base + i * kStubSize; }
+    std::atomic<uintptr_t>* slot(size_t i) const {
+        return reinterpret_cast<std::atomic<uintptr_t>*>(base + pageBytes + i * sizeof(uintptr_t));
+    }
+};
+
+JitEngine::JitEngine() = default;
+
+JitEngine::~JitEngine() {
+    // Nothing may be running JIT code any more; drop retired code first, then live code and stubs.
+    epochs_.collect();
+    for (auto& [name, fn] : functions_) freeBlock(fn.code);
+    for (auto& region : stubRegions_) unmapPages(region->base, 2 * region->pageBytes);
+}
+
+void JitEngine::defineSymbol(const std::string& name, const void* address) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    symbols_[name] = address;
+}
+
+JitEngine::CodeBlock* JitEngine::link(const MachineCode& code) {
+    // Distinct imported symbols each get one veneer after the code.
+    std::map<std::string, size_t> veneerIndex;
+    for (const auto& reloc : code.relocations) {
+        if (!symbols_.count(reloc.symbol)) {
+            errors_.push_back({ DIAG_CODEGEN, 0, ILLEGAL, ILLEGAL, "JIT error: undefined symbol '" + reloc.symbol + "'." });
+            return nullptr;
+        }
+        veneerIndex.emplace(reloc.symbol, veneerIndex.size());
+    }
+    const CodeSymbol* entry = code.findSymbol(kEntrySymbol);
+    if (!entry) {
+        errors_.push_back({ DIAG_CODEGEN, 0, ILLEGAL, ILLEGAL, "JIT error: entry symbol missing." });
+        return nullptr;
+    }
+
+    size_t veneerStart = (code.bytes.size() + 15) & ~size_t(15);
+    size_t size = roundToPages(veneerStart + veneerIndex.size() * kVeneerSize);
+    uint8_t* base = mapPages(size);
+    if (!base) {
+        errors_.push_back({ DIAG_CODEGEN, 0, ILLEGAL, ILLEGAL, "JIT error: could not map code memory." });
+        return nullptr;
+    }
+    std::memset(base, 0xCC, size);
+    std::memcpy(base, code.bytes.data(), code.bytes.size());
+
+    for (const auto& [symbol, index] : veneerIndex) {
+        uint8_t* veneer = base + veneerStart + index * kVeneerSize;
+        veneer[0] = kJmpIndirect[0];
+        veneer[1] = kJmpIndirect[1];
+        int32_t disp = 2; // skip the int3 padding to the 8-byte-aligned target
+        std::memcpy(veneer + 2, &disp, 4);
+        uintptr_t target = reinterpret_cast<uintptr_t>(symbols_.at(symbol));
+        std::memcpy(veneer + 8, &target, sizeof(target));
+    }
+    for (const auto& reloc : code.relocations) {
+        writeRel32(base + reloc.offset, base + veneerStart + veneerIndex.at(reloc.symbol) * kVeneerSize);
+    }
+
+    if (!makeExecutable(base, size)) {
+        unmapPages(base, size);
+        errors_.push_back({ DIAG_CODEGEN, 0, ILLEGAL, ILLEGAL, "JIT error: could not make code executable." });
+        return nullptr;
+    }
+
+    auto* block = new CodeBlock;
+    block->base = base;
+    block->size = size;
+    block->entry = reinterpret_cast<Entry>(base + entry->offset);
+    ++liveBlocks_;
+    return block;
+}
+
+void JitEngine::freeBlock(CodeBlock* block) {
+    if (!block) return;
+    unmapPages(block->base, block->size);
+    delete block;
+    --liveBlocks_;
+}
+
+JitEngine::Function* JitEngine::createFunction(const std::string& name) {
+    if (stubRegions_.empty() || stubRegions_.back()->used == stubRegions_.back()->capacity()) {
+        auto region = std::make_unique<StubRegion>();
+        region->pageBytes = pageSize();
+        region->base = mapPages(2 * region->pageBytes);
+        if (!region->base) return nullptr;
+        std::memset(region->base, 0xCC, region->pageBytes);
+        for (size_t i = 0; i < region->capacity(); ++i) {
+            uint8_t* stub = region->stub(i);
+            stub[0] = kJmpIndirect[0];
+            stub[1] = kJmpIndirect[1];
+            writeRel32(stub + 2, reinterpret_cast<const uint8_t*>(region->slot(i)));
+        }
+        if (!makeExecutable(region->base, region->pageBytes)) {
+            unmapPages(region->base, 2 * region->pageBytes);
+            return nullptr;
+        }
+        stubRegions_.push_back(std::move(region));
+    }
+
+    StubRegion& region = *stubRegions_.back();
+    size_t i = region.used++;
+    Function& fn = functions_[name];
+    fn.stub = region.stub(i);
+    fn.slot = region.slot(i);
+    fn.code = nullptr;
+    return &fn;
+}
+
+bool JitEngine::load(const std::string& name, std::string_view source) {
+    CompileOptions options;
+    options.output = OUTPUT_MACHINE_CODE;
+    options.entryName = kEntrySymbol;
+    CompileResult result = compileSource(source, options);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    errors_ = std::move(result.diagnostics);
+    if (!result.ok) return false;
+
+    CodeBlock* block = link(result.machineCode);
+    if (!block) return false;
+
+    auto it = functions_.find(name);
+    Function* fn = it != functions_.end() ? &it->second : createFunction(name);
+    if (!fn) {
+        freeBlock(block);
+        errors_.push_back({ DIAG_CODEGEN, 0, ILLEGAL, ILLEGAL, "JIT error: could not map stub memory." });
+        return false;
+    }
+
+    // Threads entering the stub from now on run the new code. Anyone already
+    // inside the old block pinned an earlier epoch and keeps it alive.
+    fn->slot->store(reinterpret_cast<uintptr_t>(block->entry), std::memory_order_seq_cst);
+    CodeBlock* old = fn->code;
+    fn->code = block;
+    if (old) {
+        epochs_.retire([this, old] { freeBlock(old); });
+    }
+    return true;
+}
+
+JitEngine::Entry JitEngine::entry(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = functions_.find(name);
+    return it == functions_.end() ? nullptr : reinterpret_cast<Entry>(it->second.stub);
+}
+
+JitEngine::Entry JitEngine::target(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = functions_.find(name);
+    return it == functions_.end() ? nullptr : reinterpret_cast<Entry>(it->second.slot->load(std::memory_order_acquire));
+}
+
+int JitEngine::run(const std::string& name, EpochReclaimer::Participant* participant) {
+    Entry fn = entry(name);
+    if (!fn) return -1;
+    EpochGuard guard(epochs_, participant);
+    return fn();
+}
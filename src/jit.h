@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "diagnostics.h"
+#include "epoch_reclaimer.h"
+#include "x86_assembler.h"
+
+// In-process JIT with hot swapping. Every loaded script is reached through a
+// patchable stub (`jmp [rip+slot]`) whose address never changes; reloading the
+// script compiles new code and atomically swaps the slot. Old code is retired
+// to an EpochReclaimer and unmapped once no thread can be executing it, so
+// callers must run JIT code inside an EpochGuard (see run()).
+class JitEngine {
+public:
+    using Entry = int (*)();
+
+    JitEngine();
+    ~JitEngine();
+    JitEngine(const JitEngine&) = delete;
+    JitEngine& operator=(const JitEngine&) = delete;
+
+    // Host function the generated code may call (e.g. print_int).
+    void defineSymbol(const std::string& name, const void* address);
+
+    // Compiles `source` and points `name`'s stub at the result, creating the
+    // stub on first load. On failure the previous code stays installed.
+    bool load(const std::string& name, std::string_view source);
+    const std::vector<Diagnostic>& getErrors() const { return errors_; }
+
+    // Stable entry point for `name`, or nullptr if it was never loaded.
+    Entry entry(const std::string& name) const;
+
+    // Code currently behind the stub. Only valid while pinned; for measuring stub overhead.
+    Entry target(const std::string& name) const;
+
+    // Runs `name` pinned to the current epoch. `participant` comes from
+    // epochs().registerThread() on the calling thread.
+    int run(const std::string& name, EpochReclaimer::Participant* participant);
+
+    EpochReclaimer& epochs() { return epochs_; }
+    size_t reclaim() { return epochs_.collect(); }
+
+    // Code blocks currently mapped, including retired ones not yet reclaimed.
+    size_t liveCodeBlocks() const { return liveBlocks_.load(); }
+
+private:
+    struct CodeBlock;
+    struct StubRegion;
+
+    struct Function {
+        uint8_t* stub;                 // Executable: jmp [rip+slot]
+        std::atomic<uintptr_t>* slot;  // Current code address
+        CodeBlock* code;
+    };
+
+    mutable std::mutex mutex_;
+    std::map<std::string, const void*> symbols_;
+    std::map<std::string, Function> functions_;
+    std::vector<std::unique_ptr<StubRegion>> stubRegions_;
+    std::vector<Diagnostic> errors_;
+    std::atomic<size_t> liveBlocks_{ 0 };
+    EpochReclaimer epochs_; // Last: its pending destructors call freeBlock()
+
+    CodeBlock* link(const MachineCode& code);
+    Function* createFunction(const std::string& name);
+    void freeBlock(CodeBlock* block);
+};
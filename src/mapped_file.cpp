@@ -0,0 +1,128 @@
+// mapped_file.cpp
+#include "mapped_file.h"
+
+#include <cstring>
+#include <utility>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this == &other) return *this;
+    close();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    ok_ = std::exchange(other.ok_, false);
+    error_ = std::move(other.error_);
+    return *this;
+}
+
+bool MappedFile::open(const std::filesystem::path& path, uint32_t hints) {
+    close();
+    error_.clear();
+#if defined(_WIN32)
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        (hints & ACCESS_SEQUENTIAL) ? FILE_FLAG_SEQUENTIAL_SCAN : (hints & ACCESS_RANDOM) ? FILE_FLAG_RANDOM_ACCESS : 0,
+        nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        error_ = "cannot open " + path.string();
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        error_ = "cannot stat " + path.string();
+        return false;
+    }
+    size_ = static_cast<size_t>(size.QuadPart);
+    if (size_ > 0) {
+        // Empty files cannot be mapped; they are simply empty.
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (mapping) CloseHandle(mapping); // The view holds its own reference to the mapping
+        if (!view) {
+            CloseHandle(file);
+            error_ = "cannot map " + path.string();
+            size_ = 0;
+            return false;
+        }
+        data_ = static_cast<const uint8_t*>(view);
+        if (hints & ACCESS_WILL_NEED) {
+            WIN32_MEMORY_RANGE_ENTRY range{ view, size_ };
+            PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+        }
+    }
+    // As on POSIX, the view keeps the file's pages reachable without the handles.
+    CloseHandle(file);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error_ = "cannot open " + path.string() + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        error_ = "cannot stat " + path.string() + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    if (size_ > 0) {
+        // Empty files cannot be mapped; they are simply empty.
+        void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            error_ = "cannot map " + path.string() + ": " + std::strerror(errno);
+            ::close(fd);
+            size_ = 0;
+            return false;
+        }
+        data_ = static_cast<const uint8_t*>(p);
+        if (hints & ACCESS_SEQUENTIAL) madvise(p, size_, MADV_SEQUENTIAL);
+        if (hints & ACCESS_RANDOM) madvise(p, size_, MADV_RANDOM);
+        if (hints & ACCESS_WILL_NEED) madvise(p, size_, MADV_WILLNEED);
+    }
+    // The mapping keeps the file's pages reachable without the descriptor.
+    ::close(fd);
+#endif
+    ok_ = true;
+    return true;
+}
+
+void MappedFile::close() {
+#if defined(_WIN32)
+    if (data_) UnmapViewOfFile(data_);
+#else
+    if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    ok_ = false;
+}
+
+bool MappedFile::checkView(size_t offset, size_t& count, size_t elementSize, size_t alignment,
+                           const uint8_t*& start) const {
+    if (offset > size_) return false;
+    size_t available = size_ - offset;
+    if (count == SIZE_MAX) {
+        if (available % elementSize != 0) return false;
+        count = available / elementSize;
+    }
+    else if (count > available / elementSize) {
+        return false;
+    }
+    start = data_ + offset;
+    // An empty view has no elements to misalign.
+    if (count > 0 && reinterpret_cast<uintptr_t>(start) % alignment != 0) return false;
+    return true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <type_traits>
+
+// A whole file mapped read-only into memory, for host code that feeds meshes
+// and textures to scripts: pages are read on first touch and no copy is made,
+// so multi-gigabyte assets cost address space rather than RAM. Access hints
+// are passed to madvise (PrefetchVirtualMemory for ACCESS_WILL_NEED on Windows).
+class MappedFile {
+public:
+    enum Access : uint32_t {
+        ACCESS_NORMAL = 0,
+        ACCESS_SEQUENTIAL = 1 << 0, // Read ahead aggressively and drop pages behind the reader
+        ACCESS_RANDOM = 1 << 1,     // No read-ahead
+        ACCESS_WILL_NEED = 1 << 2,  // Start reading the whole file in now
+    };
+
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path& path, uint32_t hints = ACCESS_NORMAL) { open(path, hints); }
+    ~MappedFile() { close(); }
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::filesystem::path& path, uint32_t hints = ACCESS_NORMAL);
+    void close();
+
+    bool ok() const { return ok_; }
+    const std::string& error() const { return error_; }
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    std::span<const uint8_t> bytes() const { return { data_, size_ }; }
+
+    // `count` elements of T starting `offset` bytes in; all of the rest when
+    // `count` is SIZE_MAX, which must then be a whole number of elements.
+    // Fails when the range is out of bounds or misaligned for T.
+    template <typename T>
+    bool view(std::span<const T>& out, size_t offset = 0, size_t count = SIZE_MAX) const {
+        static_assert(std::is_trivially_copyable_v<T>, "views reinterpret file bytes");
+        const uint8_t* start;
+        if (!checkView(offset, count, sizeof(T), alignof(T), start)) return false;
+        out = { reinterpret_cast<const T*>(start), count };
+        return true;
+    }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    bool ok_ = false;
+    std::string error_;
+
+    bool checkView(size_t offset, size_t& count, size_t elementSize, size_t alignment, const uint8_t*& start) const;
+};
@@ -0,0 +1,74 @@
+// match_lowering.cpp
+#include "match_lowering.h"
+
+#include <algorithm>
+#include <set>
+#include <utility>
+
+std::vector<MatchCase> matchCases(const MatchExpression& node) {
+    std::vector<MatchCase> cases;
+    std::vector<std::pair<int64_t, int64_t>> claimed; // Sorted and disjoint
+    for (size_t arm = 0; arm < node.arms.size(); ++arm) {
+        for (const auto& [lo, hi] : node.arms[arm].ranges) {
+            if (lo > hi) continue;
+
+            // The parts of [lo, hi] that no earlier pattern claims.
+            int64_t next = lo;
+            for (const auto& [claimedLo, claimedHi] : claimed) {
+                if (claimedHi < next) continue;
+                if (claimedLo > hi) break;
+                if (claimedLo > next) cases.push_back({ next, claimedLo - 1, arm });
+                next = std::max(next, claimedHi + 1);
+            }
+            if (next <= hi) cases.push_back({ next, static_cast<int64_t>(hi), arm });
+
+            claimed.push_back({ lo, hi });
+            std::sort(claimed.begin(), claimed.end());
+            size_t kept = 0;
+            for (size_t i = 1; i < claimed.size(); ++i) {
+                if (claimed[i].first <= claimed[kept].second + 1) {
+                    claimed[kept].second = std::max(claimed[kept].second, claimed[i].second);
+                }
+                else {
+                    claimed[++kept] = claimed[i];
+                }
+            }
+            claimed.resize(kept + 1);
+        }
+    }
+
+    std::sort(cases.begin(), cases.end(), [](const MatchCase& a, const MatchCase& b) { return a.lo < b.lo; });
+    std::vector<MatchCase> merged;
+    for (const auto& c : cases) {
+        if (!merged.empty() && merged.back().arm == c.arm && merged.back().hi + 1 == c.lo) {
+            merged.back().hi = c.hi;
+        }
+        else {
+            merged.push_back(c);
+        }
+    }
+    return merged;
+}
+
+MatchLowering chooseMatchLowering(const std::vector<MatchCase>& cases) {
+    if (cases.size() < 3) return MATCH_COMPARE_TREE;
+
+    int64_t span = cases.back().hi - cases.front().lo + 1;
+    int64_t values = 0;
+    std::set<size_t> arms;
+    for (const auto& c : cases) {
+        values += c.hi - c.lo + 1;
+        arms.insert(c.arm);
+    }
+    if (span <= 64 && arms.size() <= 3) return MATCH_BIT_TEST;
+    if (cases.size() >= 4 && span <= 4096 && values * 10 >= span * 4) return MATCH_JUMP_TABLE;
+    return MATCH_COMPARE_TREE;
+}
+
+const char* matchLoweringName(MatchLowering lowering) {
+    switch (lowering) {
+    case MATCH_JUMP_TABLE: return "jump table";
+    case MATCH_BIT_TEST: return "bit test";
+    default: return "compare tree";
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ast.h"
+
+// Dispatch planning for `match`, shared by the native backend and the bytecode compiler.
+
+// A run of consecutive subject values that selects one arm.
+struct MatchCase {
+    int64_t lo;
+    int64_t hi;
+    size_t  arm; // Index into MatchExpression::arms
+};
+
+// The values each arm other than `_` actually receives, sorted and disjoint:
+// values an earlier pattern already claims are dropped (the first matching arm
+// wins) and adjacent runs selecting the same arm are merged. Values in no case
+// go to the `_` arm.
+std::vector<MatchCase> matchCases(const MatchExpression& node);
+
+enum MatchLowering {
+    MATCH_COMPARE_TREE, // Binary search over the cases, linear compares at the leaves
+    MATCH_JUMP_TABLE,   // Bounds check, then an indirect jump through a table of arm offsets
+    MATCH_BIT_TEST,     // Bounds check, then one `bt` against a 64-bit mask per arm
+};
+
+// Picks the dispatch by the cases' span and density, as LLVM lowers switches:
+//   bit test    at least 3 cases spanning at most 64 values and reaching at most 3 arms
+//   jump table  at least 4 cases spanning at most 4096 values, 40% or more of them matched
+//   otherwise a compare tree, O(log cases) branches.
+MatchLowering chooseMatchLowering(const std::vector<MatchCase>& cases);
+
+const char* matchLoweringName(MatchLowering lowering);
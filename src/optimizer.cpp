@@ -0,0 +1,438 @@
+// optimizer.cpp
+#include "optimizer.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <map>
+#include <sstream>
+
+namespace {
+
+const IntegerLiteral* asInt(const Expression* node) {
+    return dynamic_cast<const IntegerLiteral*>(node);
+}
+
+const BooleanLiteral* asBool(const Expression* node) {
+    return dynamic_cast<const BooleanLiteral*>(node);
+}
+
+bool fitsInt(int64_t v) {
+    return v >= INT_MIN && v <= INT_MAX;
+}
+
+std::unique_ptr<Expression> makeInt(int64_t value, uint32_t offset) {
+    auto lit = std::make_unique<IntegerLiteral>(static_cast<int>(value));
+    lit->resolvedType = INT;
+    lit->offset = offset;
+    return lit;
+}
+
+std::unique_ptr<Expression> makeBool(bool value, uint32_t offset) {
+    auto lit = std::make_unique<BooleanLiteral>(value);
+    lit->resolvedType = BOOL;
+    lit->offset = offset;
+    return lit;
+}
+
+std::unique_ptr<Expression> cloneLiteral(const Expression* literal, uint32_t offset) {
+    if (auto i = asInt(literal)) return makeInt(i->value, offset);
+    return makeBool(asBool(literal)->value, offset);
+}
+
+// Division and remainder fault on a zero divisor, and on INT64_MIN / -1.
+bool mayTrap(const Expression* node) {
+    if (auto bin = dynamic_cast<const BinaryExpression*>(node)) {
+        if (bin->op == SLASH || bin->op == PERCENT) {
+            const IntegerLiteral* divisor = asInt(bin->right.get());
+            if (!divisor || divisor->value == 0 || divisor->value == -1) return true;
+        }
+        return mayTrap(bin->left.get()) || mayTrap(bin->right.get());
+    }
+    if (auto unary = dynamic_cast<const UnaryExpression*>(node)) {
+        return mayTrap(unary->operand.get());
+    }
+    if (auto cond = dynamic_cast<const ConditionalExpression*>(node)) {
+        return mayTrap(cond->condition.get()) || mayTrap(cond->thenExpr.get()) || mayTrap(cond->elseExpr.get());
+    }
+    if (auto match = dynamic_cast<const MatchExpression*>(node)) {
+        if (mayTrap(match->subject.get())) return true;
+        for (const auto& arm : match->arms) {
+            if (mayTrap(arm.value.get())) return true;
+        }
+    }
+    return false;
+}
+
+// Marks every variable the expression reads in `reads`, indexed by slot.
+void collectReads(const Expression* node, std::vector<bool>& reads) {
+    if (auto id = dynamic_cast<const IdentifierExpr*>(node)) {
+        reads[id->slot] = true;
+    }
+    else if (auto bin = dynamic_cast<const BinaryExpression*>(node)) {
+        collectReads(bin->left.get(), reads);
+        collectReads(bin->right.get(), reads);
+    }
+    else if (auto unary = dynamic_cast<const UnaryExpression*>(node)) {
+        collectReads(unary->operand.get(), reads);
+    }
+    else if (auto cond = dynamic_cast<const ConditionalExpression*>(node)) {
+        collectReads(cond->condition.get(), reads);
+        collectReads(cond->thenExpr.get(), reads);
+        collectReads(cond->elseExpr.get(), reads);
+    }
+    else if (auto match = dynamic_cast<const MatchExpression*>(node)) {
+        collectReads(match->subject.get(), reads);
+        for (const auto& arm : match->arms) {
+            collectReads(arm.value.get(), reads);
+        }
+    }
+}
+
+const char* opSymbol(TokenType op) {
+    switch (op) {
+    case PLUS: return "+";
+    case MINUS: return "-";
+    case ASTERISK: return "*";
+    case SLASH: return "/";
+    case PERCENT: return "%";
+    case EQ: return "==";
+    case NOT_EQ: return "!=";
+    case LT: return "<";
+    case GT: return ">";
+    case LT_EQ: return "<=";
+    case GT_EQ: return ">=";
+    case AND: return "&&";
+    case OR: return "||";
+    case BANG: return "!";
+    default: return tokenTypeName(op);
+    }
+}
+
+void writeExpression(std::ostringstream& out, const Expression* node, bool nested) {
+    if (auto i = asInt(node)) {
+        out << i->value;
+    }
+    else if (auto b = asBool(node)) {
+        out << (b->value ? "true" : "false");
+    }
+    else if (auto id = dynamic_cast<const IdentifierExpr*>(node)) {
+        out << id->name;
+    }
+    else if (auto bin = dynamic_cast<const BinaryExpression*>(node)) {
+        if (nested) out << "(";
+        writeExpression(out, bin->left.get(), true);
+        out << " " << opSymbol(bin->op) << " ";
+        writeExpression(out, bin->right.get(), true);
+        if (nested) out << ")";
+    }
+    else if (auto unary = dynamic_cast<const UnaryExpression*>(node)) {
+        out << opSymbol(unary->op);
+        writeExpression(out, unary->operand.get(), true);
+    }
+    else if (auto cond = dynamic_cast<const ConditionalExpression*>(node)) {
+        if (nested) out << "(";
+        writeExpression(out, cond->condition.get(), true);
+        out << " ? ";
+        writeExpression(out, cond->thenExpr.get(), true);
+        out << " : ";
+        writeExpression(out, cond->elseExpr.get(), true);
+        if (nested) out << ")";
+    }
+    else if (auto match = dynamic_cast<const MatchExpression*>(node)) {
+        out << "match ";
+        writeExpression(out, match->subject.get(), true);
+        out << " {";
+        for (size_t i = 0; i < match->arms.size(); ++i) {
+            const MatchArm& arm = match->arms[i];
+            out << (i ? ", " : " ");
+            if (arm.ranges.empty()) out << "_";
+            for (size_t r = 0; r < arm.ranges.size(); ++r) {
+                out << (r ? ", " : "") << arm.ranges[r].first;
+                if (arm.ranges[r].second != arm.ranges[r].first) out << ".." << arm.ranges[r].second;
+            }
+            out << " => ";
+            writeExpression(out, arm.value.get(), false);
+        }
+        out << " }";
+    }
+    else {
+        out << "<expr>";
+    }
+}
+
+} // namespace
+
+std::string expressionText(const Expression* node) {
+    std::ostringstream out;
+    writeExpression(out, node, false);
+    return out.str();
+}
+
+bool parsePassList(const std::string& list, unsigned& passes) {
+    static const std::map<std::string, unsigned> kNames = {
+        {"fold", PASS_FOLD}, {"propagate", PASS_PROPAGATE}, {"dse", PASS_DEAD_STORES},
+        {"strength", PASS_STRENGTH}, {"forward", PASS_FORWARD}, {"range", PASS_RANGE}, {"all", PASS_ALL}, {"none", 0},
+    };
+    passes = 0;
+    std::istringstream in(list);
+    std::string name;
+    while (std::getline(in, name, ',')) {
+        auto it = kNames.find(name);
+        if (it == kNames.end()) return false;
+        passes |= it->second;
+    }
+    return true;
+}
+
+void Optimizer::remark(const char* pass, uint32_t offset, std::string message) {
+    remarks_.push_back({ offset, pass, std::move(message) });
+}
+
+void Optimizer::run(Program& program) {
+    known_.assign(program.slotCount, Known{});
+    for (auto& stmt : program.statements) {
+        if (auto assignment = dynamic_cast<AssignmentStatement*>(stmt.get())) {
+            simplify(assignment->value);
+            assign(assignment->identifier.get(), assignment->value.get());
+        }
+        else if (auto exprStmt = dynamic_cast<ExpressionStatement*>(stmt.get())) {
+            simplify(exprStmt->expression);
+        }
+        else if (auto print = dynamic_cast<PrintStatement*>(stmt.get())) {
+            simplify(print->expression);
+        }
+        else if (auto block = dynamic_cast<AsmStatement*>(stmt.get())) {
+            // Inputs are plain values; "m" inputs must stay variables and "i" ones literals.
+            for (auto& input : block->inputs) {
+                if (input.constraint != "m") simplify(input.expression);
+            }
+            if (std::find(block->clobbers.begin(), block->clobbers.end(), "memory") != block->clobbers.end()) {
+                known_.assign(known_.size(), Known{}); // The block may have written any variable
+            }
+            for (auto& output : block->outputs) {
+                assign(static_cast<IdentifierExpr*>(output.expression.get()), nullptr);
+            }
+        }
+    }
+    if (passes_ & PASS_DEAD_STORES) {
+        eliminateDeadStores(program);
+    }
+    std::stable_sort(remarks_.begin(), remarks_.end(), [](const Remark& a, const Remark& b) { return a.offset < b.offset; });
+}
+
+void Optimizer::simplify(std::unique_ptr<Expression>& slot) {
+    Expression* node = slot.get();
+    if (auto id = dynamic_cast<IdentifierExpr*>(node)) {
+        if (!(passes_ & PASS_PROPAGATE)) return;
+        const Known& known = known_[id->slot];
+        std::unique_ptr<Expression> replacement;
+        if (known.literal) {
+            replacement = cloneLiteral(known.literal, id->offset);
+        }
+        else if (known.copySlot != kNoSlot) {
+            auto copy = std::make_unique<IdentifierExpr>(known.copyOf);
+            copy->slot = known.copySlot;
+            copy->resolvedType = id->resolvedType;
+            copy->offset = id->offset;
+            replacement = std::move(copy);
+        }
+        else {
+            return;
+        }
+        remark("propagate", id->offset, id->name + " -> " + expressionText(replacement.get()));
+        slot = std::move(replacement);
+    }
+    else if (auto bin = dynamic_cast<BinaryExpression*>(node)) {
+        simplify(bin->left);
+        simplify(bin->right);
+        if (passes_ & PASS_FOLD) foldBinary(slot);
+    }
+    else if (auto unary = dynamic_cast<UnaryExpression*>(node)) {
+        simplify(unary->operand);
+        if (passes_ & PASS_FOLD) foldUnary(slot);
+    }
+    else if (auto cond = dynamic_cast<ConditionalExpression*>(node)) {
+        simplify(cond->condition);
+        simplify(cond->thenExpr);
+        simplify(cond->elseExpr);
+        const BooleanLiteral* c = asBool(cond->condition.get());
+        if ((passes_ & PASS_FOLD) && c) {
+            std::string before = expressionText(cond);
+            std::unique_ptr<Expression> taken = std::move(c->value ? cond->thenExpr : cond->elseExpr);
+            remark("fold", cond->offset, before + " -> " + expressionText(taken.get()));
+            slot = std::move(taken);
+        }
+    }
+    else if (auto match = dynamic_cast<MatchExpression*>(node)) {
+        simplify(match->subject);
+        for (auto& arm : match->arms) {
+            simplify(arm.value);
+        }
+        const IntegerLiteral* subject = asInt(match->subject.get());
+        if ((passes_ & PASS_FOLD) && subject) {
+            // Only the selected arm runs, so the others may be dropped even if they could trap.
+            auto taken = std::find_if(match->arms.begin(), match->arms.end(), [&](const MatchArm& arm) {
+                return arm.ranges.empty() || std::any_of(arm.ranges.begin(), arm.ranges.end(), [&](const auto& range) {
+                    return range.first <= subject->value && subject->value <= range.second;
+                });
+            });
+            if (taken == match->arms.end()) return;
+            std::string before = expressionText(match);
+            std::unique_ptr<Expression> value = std::move(taken->value);
+            remark("fold", match->offset, before + " -> " + expressionText(value.get()));
+            slot = std::move(value);
+        }
+    }
+}
+
+void Optimizer::foldBinary(std::unique_ptr<Expression>& slot) {
+    auto* bin = static_cast<BinaryExpression*>(slot.get());
+    uint32_t offset = bin->offset;
+    std::string before = expressionText(bin);
+    std::unique_ptr<Expression> result;
+
+    const IntegerLiteral* li = asInt(bin->left.get());
+    const IntegerLiteral* ri = asInt(bin->right.get());
+    const BooleanLiteral* lb = asBool(bin->left.get());
+    const BooleanLiteral* rb = asBool(bin->right.get());
+
+    if (li && ri) {
+        // Operands are 32-bit, so 64-bit arithmetic is exact; the result must fit a literal.
+        int64_t a = li->value, b = ri->value;
+        switch (bin->op) {
+        case PLUS: if (fitsInt(a + b)) result = makeInt(a + b, offset); break;
+        case MINUS: if (fitsInt(a - b)) result = makeInt(a - b, offset); break;
+        case ASTERISK: if (fitsInt(a * b)) result = makeInt(a * b, offset); break;
+        case SLASH: if (b != 0 && fitsInt(a / b)) result = makeInt(a / b, offset); break;
+        case PERCENT: if (b != 0) result = makeInt(a % b, offset); break;
+        case EQ: result = makeBool(a == b, offset); break;
+        case NOT_EQ: result = makeBool(a != b, offset); break;
+        case LT: result = makeBool(a < b, offset); break;
+        case GT: result = makeBool(a > b, offset); break;
+        case LT_EQ: result = makeBool(a <= b, offset); break;
+        case GT_EQ: result = makeBool(a >= b, offset); break;
+        default: break;
+        }
+    }
+    else if (lb && rb && (bin->op == EQ || bin->op == NOT_EQ)) {
+        result = makeBool((lb->value == rb->value) == (bin->op == EQ), offset);
+    }
+    else if (lb && (bin->op == AND || bin->op == OR)) {
+        // The left operand decides (false && x, true || x) or the result is the right operand.
+        bool decides = bin->op == AND ? !lb->value : lb->value;
+        result = decides ? makeBool(lb->value, offset) : std::move(bin->right);
+    }
+    else if (ri && (((bin->op == PLUS || bin->op == MINUS) && ri->value == 0) || ((bin->op == ASTERISK || bin->op == SLASH) && ri->value == 1))) {
+        result = std::move(bin->left);
+    }
+    else if (li && ((bin->op == PLUS && li->value == 0) || (bin->op == ASTERISK && li->value == 1))) {
+        result = std::move(bin->right);
+    }
+
+    if (!result) return;
+    remark("fold", offset, before + " -> " + expressionText(result.get()));
+    slot = std::move(result);
+}
+
+void Optimizer::foldUnary(std::unique_ptr<Expression>& slot) {
+    auto* unary = static_cast<UnaryExpression*>(slot.get());
+    std::string before = expressionText(unary);
+    std::unique_ptr<Expression> result;
+    if (unary->op == PLUS) {
+        result = std::move(unary->operand);
+    }
+    else if (auto i = asInt(unary->operand.get()); i && unary->op == MINUS && fitsInt(-static_cast<int64_t>(i->value))) {
+        result = makeInt(-static_cast<int64_t>(i->value), unary->offset);
+    }
+    else if (auto b = asBool(unary->operand.get()); b && unary->op == BANG) {
+        result = makeBool(!b->value, unary->offset);
+    }
+    if (!result) return;
+    remark("fold", unary->offset, before + " -> " + expressionText(result.get()));
+    slot = std::move(result);
+}
+
+void Optimizer::assign(const IdentifierExpr* target, const Expression* value) {
+    // The old value and every copy of it are gone.
+    uint32_t slot = target->slot;
+    known_[slot] = Known{};
+    for (auto& known : known_) {
+        if (known.copySlot == slot) known = Known{};
+    }
+    if (!(passes_ & PASS_PROPAGATE)) return;
+
+    if (asInt(value) || asBool(value)) {
+        knownLiterals_.push_back(cloneLiteral(value, value->offset));
+        known_[slot].literal = knownLiterals_.back().get();
+    }
+    else if (auto id = dynamic_cast<const IdentifierExpr*>(value); id && id->slot != slot) {
+        known_[slot].copyOf = id->name;
+        known_[slot].copySlot = id->slot;
+    }
+}
+
+// Backward liveness over the statement list: a store is dead when no later
+// statement reads the variable before it is assigned again.
+void Optimizer::eliminateDeadStores(Program& program) {
+    auto& statements = program.statements;
+    std::vector<bool> live(program.slotCount, false);
+    std::vector<bool> dead(statements.size(), false);
+    for (size_t i = statements.size(); i-- > 0;) {
+        Statement* stmt = statements[i].get();
+        if (auto assignment = dynamic_cast<AssignmentStatement*>(stmt)) {
+            const IdentifierExpr* target = assignment->identifier.get();
+            if (!live[target->slot] && !mayTrap(assignment->value.get())) {
+                dead[i] = true;
+                remark("dse", stmt->offset, "removed dead store to " + target->name);
+                continue;
+            }
+            live[target->slot] = false;
+            collectReads(assignment->value.get(), live);
+        }
+        else if (auto exprStmt = dynamic_cast<ExpressionStatement*>(stmt)) {
+            if (!mayTrap(exprStmt->expression.get())) {
+                dead[i] = true;
+                remark("dse", stmt->offset, "removed unused expression " + expressionText(exprStmt->expression.get()));
+                continue;
+            }
+            collectReads(exprStmt->expression.get(), live);
+        }
+        else if (auto print = dynamic_cast<PrintStatement*>(stmt)) {
+            collectReads(print->expression.get(), live);
+        }
+        else if (auto block = dynamic_cast<AsmStatement*>(stmt)) {
+            // Like GCC: a block that is not @volatile, has outputs and none of them is read is dropped.
+            bool used = block->isVolatile || block->outputs.empty() ||
+                std::find(block->clobbers.begin(), block->clobbers.end(), "memory") != block->clobbers.end();
+            for (const auto& output : block->outputs) {
+                used = used || live[static_cast<IdentifierExpr*>(output.expression.get())->slot];
+            }
+            for (const auto& input : block->inputs) {
+                used = used || mayTrap(input.expression.get());
+            }
+            if (!used) {
+                dead[i] = true;
+                remark("dse", stmt->offset, "removed asm_ block whose outputs are never read");
+                continue;
+            }
+            for (const auto& output : block->outputs) {
+                // "+" outputs are read before they are written
+                live[static_cast<IdentifierExpr*>(output.expression.get())->slot] = output.constraint[0] == '+';
+            }
+            if (std::find(block->clobbers.begin(), block->clobbers.end(), "memory") != block->clobbers.end()) {
+                // The block may read any variable
+                live.assign(live.size(), true);
+            }
+            for (const auto& input : block->inputs) {
+                collectReads(input.expression.get(), live);
+            }
+        }
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < statements.size(); ++i) {
+        if (!dead[i]) statements[kept++] = std::move(statements[i]);
+    }
+    statements.resize(kept);
+}
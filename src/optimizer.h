@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ast.h"
+#include "diagnostics.h"
+
+// Optimization passes, selectable individually with --passes=. The program is
+// straight-line code, so every analysis below is exact rather than conservative.
+enum OptPass : unsigned {
+    PASS_FOLD = 1u << 0,        // Constant folding and algebraic identities (x + 0, x * 1, ...)
+    PASS_PROPAGATE = 1u << 1,   // Constant and copy propagation through variables
+    PASS_DEAD_STORES = 1u << 2, // Assignments never read again and unused expression statements
+    PASS_STRENGTH = 1u << 3,    // Codegen: immediate operands, shifts for powers of two
+    PASS_FORWARD = 1u << 4,     // Codegen: reuse values already in registers instead of reloading them
+    PASS_RANGE = 1u << 5,       // Codegen: unsigned and 32-bit division where value ranges allow it
+    PASS_ALL = PASS_FOLD | PASS_PROPAGATE | PASS_DEAD_STORES | PASS_STRENGTH | PASS_FORWARD | PASS_RANGE,
+};
+
+// Parses a comma-separated list of pass names ("fold,propagate,dse,strength",
+// "all" or "none"); returns false on an unknown name.
+bool parsePassList(const std::string& list, unsigned& passes);
+
+// Rewrites an analyzed program in place between semantic analysis and code
+// generation. Rewrites never remove an expression that can trap at run time
+// (division or remainder by a value that may be 0 or -1), so a program that
+// faults without optimization still faults with it.
+class Optimizer {
+public:
+    explicit Optimizer(unsigned passes) : passes_(passes) {}
+
+    void run(Program& program);
+    const std::vector<Remark>& remarks() const { return remarks_; }
+
+private:
+    // A variable's value as far as propagation knows: a constant, a copy of another variable or neither.
+    struct Known {
+        const Expression* literal = nullptr; // IntegerLiteral or BooleanLiteral, owned by knownLiterals_
+        std::string copyOf;
+        uint32_t copySlot = kNoSlot;
+    };
+
+    unsigned passes_;
+    std::vector<Remark> remarks_;
+    std::vector<Known> known_; // By variable slot
+    std::vector<std::unique_ptr<Expression>> knownLiterals_;
+
+    void simplify(std::unique_ptr<Expression>& slot);
+    void foldBinary(std::unique_ptr<Expression>& slot);
+    void foldUnary(std::unique_ptr<Expression>& slot);
+    void assign(const IdentifierExpr* target, const Expression* value);
+    void eliminateDeadStores(Program& program);
+    void remark(const char* pass, uint32_t offset, std::string message);
+};
+
+// Source-like text of an expression, for remarks.
+std::string expressionText(const Expression* node);
@@ -0,0 +1,536 @@
+// perf_analysis.cpp
+#include "perf_analysis.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <map>
+
+#include "inline_asm.h"
+
+namespace {
+
+// What an instruction does to its operands; costs come from the tables below.
+enum OpKind {
+    OP_MOVE,     // mov, movzx, movsx, movsxd: no ALU uop when an operand is memory
+    OP_ALU,      // add, sub, and, or, xor, adc, sbb: destination read and written, flags written
+    OP_COMPARE,  // cmp, test, bt: operands read, flags written
+    OP_UNARY,    // neg, not, inc, dec
+    OP_SHIFT,    // By an immediate
+    OP_SHIFT_CL, // By CL
+    OP_IMUL,     // Two- and three-operand imul
+    OP_WIDE_MUL, // One-operand imul/mul: RDX:RAX = RAX * operand
+    OP_DIV64,    // idiv/div of RDX:RAX
+    OP_DIV32,    // idiv/div of EDX:EAX
+    OP_CQO,      // cqo, cdq
+    OP_SETCC,
+    OP_CMOV,
+    OP_LEA,
+    OP_JCC,
+    OP_JMP,
+    OP_CALL,
+    OP_RET,
+    OP_PUSH,
+    OP_POP,
+    OP_LEAVE,
+    OP_NOP,
+    OP_UNKNOWN,
+    OP_KIND_COUNT,
+};
+
+struct UopGroup {
+    uint32_t ports = 0; // Bit per port; the uops spread evenly over them
+    int count = 0;
+};
+
+struct OpCost {
+    int latency = 1;
+    int fused = 1;        // Fused-domain uops, before any memory operand
+    UopGroup uops[3];
+    int divider = 0;      // Cycles the non-pipelined divider is busy
+};
+
+struct ArchModel {
+    std::vector<std::string> ports; // The last one is the divider
+    int issueWidth;
+    int loadLatency;
+    int storeForward;     // Store to a load of the same address
+    bool memoryRenaming;  // Zen: RSP/RBP-based loads of a stored value forward in about a cycle
+    uint32_t loadPorts, storeAddressPorts, storeDataPorts;
+    OpCost costs[OP_KIND_COUNT];
+};
+
+// Skylake client: p0 p1 p5 p6 ALUs, p2 p3 loads, p4 store data, p7 store addresses.
+ArchModel skylake() {
+    enum : uint32_t { P0 = 1, P1 = 2, P2 = 4, P3 = 8, P4 = 16, P5 = 32, P6 = 64, P7 = 128 };
+    const uint32_t alu = P0 | P1 | P5 | P6, p06 = P0 | P6, p15 = P1 | P5, p23 = P2 | P3;
+    ArchModel m{ { "p0", "p1", "p2", "p3", "p4", "p5", "p6", "p7", "div" }, 4, 5, 5, false, p23, p23 | P7, P4, {} };
+    auto& c = m.costs;
+    c[OP_MOVE] = { 1, 1, { { alu, 1 } } };
+    c[OP_ALU] = c[OP_COMPARE] = c[OP_UNARY] = c[OP_MOVE];
+    c[OP_SHIFT] = { 1, 1, { { p06, 1 } } };
+    c[OP_SHIFT_CL] = { 2, 3, { { p06, 2 }, { alu, 1 } } };
+    c[OP_IMUL] = { 3, 1, { { P1, 1 } } };
+    c[OP_WIDE_MUL] = { 3, 2, { { P1, 1 }, { P5, 1 } } };
+    c[OP_DIV64] = { 42, 57, { { alu, 57 } }, 24 };
+    c[OP_DIV32] = { 26, 10, { { alu, 10 } }, 6 };
+    c[OP_CQO] = c[OP_SETCC] = c[OP_CMOV] = c[OP_SHIFT];
+    c[OP_LEA] = { 1, 1, { { p15, 1 } } };
+    c[OP_JCC] = { 1, 1, { { p06, 1 } } };
+    c[OP_JMP] = { 1, 1, { { P6, 1 } } };
+    c[OP_CALL] = { 1, 2, { { P6, 1 }, { P2 | P3 | P7, 1 }, { P4, 1 } } };
+    c[OP_RET] = { 1, 1, { { P6, 1 }, { p23, 1 } } };
+    c[OP_PUSH] = c[OP_POP] = { 0, 0, {} }; // The stack engine updates RSP; only the memory access is left
+    c[OP_LEAVE] = { 1, 2, { { alu, 1 } } };
+    c[OP_NOP] = { 0, 1, {} };
+    c[OP_UNKNOWN] = c[OP_MOVE];
+    return m;
+}
+
+// Zen 3: four ALUs (branches on 0 and 3, multiplies on 1, shifts on 1 and 2)
+// and three AGUs shared by loads and stores.
+ArchModel zen3() {
+    enum : uint32_t { A0 = 1, A1 = 2, A2 = 4, A3 = 8, G0 = 16, G1 = 32, G2 = 64 };
+    const uint32_t alu = A0 | A1 | A2 | A3, branch = A0 | A3, agu = G0 | G1 | G2;
+    ArchModel m{ { "alu0", "alu1", "alu2", "alu3", "agu0", "agu1", "agu2", "div" }, 6, 4, 7, true, agu, agu, 0, {} };
+    auto& c = m.costs;
+    c[OP_MOVE] = { 1, 1, { { alu, 1 } } };
+    c[OP_ALU] = c[OP_COMPARE] = c[OP_UNARY] = c[OP_LEA] = c[OP_CQO] = c[OP_MOVE];
+    c[OP_SHIFT] = c[OP_SHIFT_CL] = { 1, 1, { { A1 | A2, 1 } } };
+    c[OP_IMUL] = { 3, 1, { { A1, 1 } } };
+    c[OP_WIDE_MUL] = { 3, 2, { { A1, 1 }, { alu, 1 } } };
+    c[OP_DIV64] = { 14, 2, { { A2, 2 } }, 9 };
+    c[OP_DIV32] = { 10, 2, { { A2, 2 } }, 6 };
+    c[OP_SETCC] = c[OP_CMOV] = { 1, 1, { { branch, 1 } } };
+    c[OP_JCC] = c[OP_JMP] = c[OP_SETCC];
+    c[OP_CALL] = { 1, 2, { { branch, 1 }, { agu, 1 } } };
+    c[OP_RET] = { 1, 1, { { branch, 1 }, { agu, 1 } } };
+    c[OP_PUSH] = c[OP_POP] = { 0, 0, {} };
+    c[OP_LEAVE] = { 1, 2, { { alu, 1 } } };
+    c[OP_NOP] = { 0, 1, {} };
+    c[OP_UNKNOWN] = c[OP_MOVE];
+    return m;
+}
+
+// Zen 4 keeps Zen 3's integer core; division got faster.
+ArchModel zen4() {
+    ArchModel m = zen3();
+    m.costs[OP_DIV64].divider = 7;
+    m.costs[OP_DIV32].divider = 5;
+    return m;
+}
+
+OpKind classify(const std::string& mnemonic, size_t operandCount, bool shiftByCl) {
+    static const std::map<std::string, OpKind> kinds = {
+        { "mov", OP_MOVE }, { "movzx", OP_MOVE }, { "movsx", OP_MOVE }, { "movsxd", OP_MOVE },
+        { "add", OP_ALU }, { "sub", OP_ALU }, { "and", OP_ALU }, { "or", OP_ALU }, { "xor", OP_ALU },
+        { "adc", OP_ALU }, { "sbb", OP_ALU },
+        { "cmp", OP_COMPARE }, { "test", OP_COMPARE }, { "bt", OP_COMPARE },
+        { "neg", OP_UNARY }, { "not", OP_UNARY }, { "inc", OP_UNARY }, { "dec", OP_UNARY },
+        { "shl", OP_SHIFT }, { "sal", OP_SHIFT }, { "shr", OP_SHIFT }, { "sar", OP_SHIFT },
+        { "rol", OP_SHIFT }, { "ror", OP_SHIFT },
+        { "cqo", OP_CQO }, { "cdq", OP_CQO }, { "lea", OP_LEA },
+        { "jmp", OP_JMP }, { "call", OP_CALL }, { "ret", OP_RET },
+        { "push", OP_PUSH }, { "pop", OP_POP }, { "leave", OP_LEAVE }, { "nop", OP_NOP },
+    };
+    auto it = kinds.find(mnemonic);
+    if (it != kinds.end()) return it->second == OP_SHIFT && shiftByCl ? OP_SHIFT_CL : it->second;
+    if (mnemonic == "imul") return operandCount == 1 ? OP_WIDE_MUL : OP_IMUL;
+    if (mnemonic == "mul") return OP_WIDE_MUL;
+    if (mnemonic == "idiv" || mnemonic == "div") return OP_DIV64; // Narrowed by operand width below
+    if (mnemonic.rfind("set", 0) == 0) return OP_SETCC;
+    if (mnemonic.rfind("cmov", 0) == 0) return OP_CMOV;
+    if (mnemonic.size() >= 2 && mnemonic[0] == 'j') return OP_JCC;
+    return OP_UNKNOWN;
+}
+
+struct Operand {
+    std::string reg;               // 64-bit register name, if a register
+    int width = 0;                 // Register bytes
+    bool memory = false;
+    std::vector<std::string> address; // Registers forming the address
+    std::string slot;              // Memory the analysis can follow: "rbp-8", or "" if unknown
+    bool renamable = false;        // RSP/RBP base and no index
+};
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t");
+    if (begin == std::string::npos) return "";
+    size_t end = text.find_last_not_of(" \t");
+    return text.substr(begin, end - begin + 1);
+}
+
+// Commas inside brackets belong to the memory operand.
+std::vector<std::string> splitOperands(const std::string& text) {
+    std::vector<std::string> operands;
+    std::string current;
+    int depth = 0;
+    for (char c : text) {
+        if (c == '[') ++depth;
+        if (c == ']') --depth;
+        if (c == ',' && depth == 0) {
+            operands.push_back(trim(current));
+            current.clear();
+        }
+        else {
+            current += c;
+        }
+    }
+    if (!trim(current).empty()) operands.push_back(trim(current));
+    return operands;
+}
+
+int registerWidth(const std::string& name, const std::string& reg64) {
+    if (name == reg64) return 8;
+    for (int bytes : { 4, 2 }) {
+        if (registerPart(reg64, bytes) == name) return bytes;
+    }
+    return 1;
+}
+
+// `stackDepth` is RSP relative to the start of the block, or INT32_MIN once unknown.
+Operand parseOperand(const std::string& text, int stackDepth) {
+    Operand op;
+    size_t open = text.find('[');
+    if (open == std::string::npos) {
+        op.reg = canonicalRegister(text);
+        if (!op.reg.empty()) op.width = registerWidth(text, op.reg);
+        return op;
+    }
+    op.memory = true;
+    std::string inside = text.substr(open + 1, text.find(']', open) - open - 1);
+    inside.erase(std::remove_if(inside.begin(), inside.end(), [](char c) { return std::isspace(static_cast<unsigned char>(c)); }), inside.end());
+
+    std::string base;
+    long long displacement = 0;
+    bool simple = true;
+    size_t pos = 0;
+    while (pos < inside.size()) {
+        int sign = 1;
+        if (inside[pos] == '+' || inside[pos] == '-') sign = inside[pos++] == '-' ? -1 : 1;
+        size_t end = inside.find_first_of("+-", pos);
+        std::string term = inside.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+        pos = end == std::string::npos ? inside.size() : end;
+        std::string reg = canonicalRegister(term.substr(0, term.find('*')));
+        char* numberEnd = nullptr;
+        long long value = std::strtoll(term.c_str(), &numberEnd, 0);
+        if (!reg.empty()) {
+            op.address.push_back(reg);
+            if (base.empty() && term.find('*') == std::string::npos && sign > 0) base = reg;
+            else simple = false;
+        }
+        else if (!term.empty() && *numberEnd == '\0') {
+            displacement += sign * value;
+        }
+        else {
+            simple = false; // A symbol, as in [rip + .Ltable0]
+        }
+    }
+    op.renamable = simple && (base == "rbp" || base == "rsp");
+    if (simple && base == "rbp") {
+        op.slot = "rbp" + std::to_string(displacement);
+    }
+    else if (simple && base == "rsp" && stackDepth != INT32_MIN) {
+        op.slot = "rsp" + std::to_string(stackDepth + displacement);
+    }
+    return op;
+}
+
+// A register, flags or memory value: when it is ready and which instruction produced it.
+struct Value {
+    double ready = 0.0;
+    int producer = -1; // Index into the block's instructions, -1 if produced before the block
+};
+
+class BlockAnalyzer {
+public:
+    explicit BlockAnalyzer(const ArchModel& model) : model_(model) {}
+
+    PerfBlock run(const std::vector<ListedInstruction>& listing, size_t begin, size_t end, std::string label);
+
+private:
+    const ArchModel& model_;
+    std::map<std::string, Value> registers_; // Includes "flags"
+    std::map<std::string, Value> memory_;    // Stored values by slot
+    std::vector<int> predecessor_;           // Input each instruction waited for last
+    std::vector<double> pressure_;
+    int stackDepth_ = 0;
+
+    void addUops(const UopGroup& group);
+    const Value& registerValue(const std::string& reg) { return registers_[reg]; }
+};
+
+void BlockAnalyzer::addUops(const UopGroup& group) {
+    int ports = 0;
+    for (uint32_t bits = group.ports; bits; bits &= bits - 1) ++ports;
+    if (ports == 0) return;
+    for (size_t p = 0; p + 1 < model_.ports.size(); ++p) {
+        if (group.ports & (1u << p)) pressure_[p] += static_cast<double>(group.count) / ports;
+    }
+}
+
+PerfBlock BlockAnalyzer::run(const std::vector<ListedInstruction>& listing, size_t begin, size_t end, std::string label) {
+    PerfBlock block;
+    block.label = std::move(label);
+    pressure_.assign(model_.ports.size(), 0.0);
+    int fused = 0;
+
+    for (size_t index = begin; index < end; ++index) {
+        const std::string& text = listing[index].text;
+        size_t space = text.find(' ');
+        std::string mnemonic = text.substr(0, space);
+        std::vector<std::string> texts = space == std::string::npos ? std::vector<std::string>() : splitOperands(text.substr(space + 1));
+        bool shiftByCl = texts.size() == 2 && texts[1] == "cl";
+        OpKind kind = classify(mnemonic, texts.size(), shiftByCl);
+
+        // Push and pop address the stack slot below or at RSP.
+        if (kind == OP_PUSH && stackDepth_ != INT32_MIN) stackDepth_ -= 8;
+        std::vector<Operand> ops;
+        for (const auto& t : texts) ops.push_back(parseOperand(t, stackDepth_));
+        if (kind == OP_DIV64 && !ops.empty() && ops[0].width == 4) kind = OP_DIV32;
+        OpCost cost = model_.costs[kind];
+
+        PerfInstruction inst;
+        inst.listing = index;
+        inst.modeled = kind != OP_UNKNOWN;
+        int self = static_cast<int>(block.instructions.size());
+        double start = 0.0;
+        int waitedFor = -1;
+        // Ties go to the later input, so a forwarded load waits for its store rather than its address.
+        auto need = [&](const Value& v, double extra = 0.0) {
+            if (v.ready + extra >= start && (v.ready + extra > start || v.producer >= 0)) {
+                start = v.ready + extra;
+                waitedFor = v.producer;
+            }
+        };
+
+        // --- Inputs and outputs by kind ---
+        std::vector<std::string> reads, writes;
+        const Operand* loaded = nullptr;   // Memory operand read
+        const Operand* stored = nullptr;   // Memory operand written
+        Operand stackSlot;
+        Operand* dest = ops.empty() ? nullptr : &ops[0];
+        Operand* src = ops.size() > 1 ? &ops[1] : nullptr;
+        auto readOperand = [&](const Operand* op) {
+            if (!op) return;
+            if (op->memory) loaded = op;
+            else if (!op->reg.empty()) reads.push_back(op->reg);
+        };
+        auto writeOperand = [&](const Operand* op) {
+            if (!op) return;
+            if (op->memory) stored = op;
+            else if (!op->reg.empty()) {
+                if (op->width < 4) reads.push_back(op->reg); // Partial writes merge with the old value
+                writes.push_back(op->reg);
+            }
+        };
+        bool zeroIdiom = (mnemonic == "xor" || mnemonic == "sub") && dest && src && !dest->reg.empty() && dest->reg == src->reg;
+
+        switch (kind) {
+        case OP_MOVE:
+        case OP_LEA:
+            if (kind == OP_LEA && src) reads.insert(reads.end(), src->address.begin(), src->address.end());
+            else readOperand(src);
+            writeOperand(dest);
+            break;
+        case OP_ALU:
+        case OP_UNARY:
+        case OP_SHIFT:
+        case OP_SHIFT_CL:
+        case OP_CMOV:
+            if (!zeroIdiom) {
+                readOperand(dest);
+                readOperand(src);
+            }
+            if (kind == OP_CMOV) reads.push_back("flags");
+            writeOperand(dest);
+            if (kind != OP_CMOV && mnemonic != "not") writes.push_back("flags");
+            break;
+        case OP_COMPARE:
+            readOperand(dest);
+            readOperand(src);
+            writes.push_back("flags");
+            break;
+        case OP_IMUL:
+            if (ops.size() == 2) readOperand(dest);
+            readOperand(src);
+            writeOperand(dest);
+            writes.push_back("flags");
+            break;
+        case OP_WIDE_MUL:
+        case OP_DIV64:
+        case OP_DIV32:
+            reads.push_back("rax");
+            if (kind != OP_WIDE_MUL) reads.push_back("rdx");
+            readOperand(dest);
+            writes.insert(writes.end(), { "rax", "rdx", "flags" });
+            break;
+        case OP_CQO:
+            reads.push_back("rax");
+            writes.push_back("rdx");
+            break;
+        case OP_SETCC:
+            reads.push_back("flags");
+            writeOperand(dest);
+            break;
+        case OP_JCC:
+            reads.push_back("flags");
+            break;
+        case OP_JMP:
+            readOperand(dest);
+            break;
+        case OP_PUSH:
+        case OP_POP:
+            stackSlot.memory = true;
+            stackSlot.renamable = true;
+            if (stackDepth_ != INT32_MIN) stackSlot.slot = "rsp" + std::to_string(stackDepth_);
+            if (kind == OP_PUSH) {
+                readOperand(dest);
+                stored = &stackSlot;
+            }
+            else {
+                loaded = &stackSlot;
+                writeOperand(dest);
+                if (stackDepth_ != INT32_MIN) stackDepth_ += 8;
+            }
+            break;
+        case OP_LEAVE:
+            reads.push_back("rbp");
+            stackSlot.memory = true;
+            loaded = &stackSlot;
+            writes.push_back("rbp");
+            stackDepth_ = INT32_MIN;
+            break;
+        case OP_UNKNOWN:
+            for (const auto& op : ops) readOperand(&op);
+            if (dest) writeOperand(dest);
+            break;
+        default:
+            break;
+        }
+        if (dest && dest->reg == "rsp" && kind != OP_PUSH && kind != OP_POP && kind != OP_COMPARE && stackDepth_ != INT32_MIN) {
+            bool adjust = (mnemonic == "add" || mnemonic == "sub") && src && src->reg.empty() && !src->memory;
+            int bytes = adjust ? static_cast<int>(std::strtol(texts[1].c_str(), nullptr, 0)) : 0;
+            stackDepth_ = adjust ? stackDepth_ + (mnemonic == "sub" ? -bytes : bytes) : INT32_MIN;
+        }
+
+        // --- Timing: the load, then the operation once every input is ready ---
+        for (const auto& reg : reads) {
+            if (reg != "rsp") need(registerValue(reg)); // The stack engine tracks RSP outside the core
+        }
+        if (loaded) {
+            Value address;
+            for (const auto& reg : loaded->address) {
+                if (reg != "rsp" && registerValue(reg).ready >= address.ready) address = registerValue(reg);
+            }
+            need(address, model_.loadLatency);
+            auto it = loaded->slot.empty() ? memory_.end() : memory_.find(loaded->slot);
+            if (it != memory_.end()) {
+                // Stored earlier in the block: the value comes from the store buffer.
+                bool renamed = model_.memoryRenaming && loaded->renamable;
+                need(it->second, renamed ? 1 : model_.storeForward);
+            }
+        }
+        bool pureMove = (kind == OP_MOVE || kind == OP_PUSH || kind == OP_POP) && (loaded || stored);
+        int latency = pureMove || zeroIdiom ? 0 : cost.latency;
+        inst.latency = latency + (loaded ? model_.loadLatency : 0);
+        inst.ready = start + latency;
+        predecessor_.push_back(waitedFor);
+        for (const auto& reg : writes) registers_[reg] = { inst.ready, self };
+        if (stored) {
+            if (stored->slot.empty()) memory_.clear(); // May alias any slot followed so far
+            else memory_[stored->slot] = { inst.ready, self };
+        }
+
+        // --- Resources: a load micro-fuses with its operation, a store adds one fused uop ---
+        inst.uops = pureMove ? 1 : cost.fused + (stored ? 1 : 0);
+        if (!(pureMove && kind == OP_MOVE)) {
+            for (const auto& group : cost.uops) addUops(group);
+        }
+        if (loaded) addUops({ model_.loadPorts, 1 });
+        if (stored) {
+            addUops({ model_.storeAddressPorts, 1 });
+            addUops({ model_.storeDataPorts, 1 });
+        }
+        pressure_.back() += cost.divider;
+        fused += inst.uops;
+        block.instructions.push_back(inst);
+    }
+
+    // --- Critical chain ---
+    int last = -1;
+    for (size_t i = 0; i < block.instructions.size(); ++i) {
+        if (last < 0 || block.instructions[i].ready > block.instructions[last].ready) last = static_cast<int>(i);
+    }
+    for (int i = last; i >= 0; i = predecessor_[i]) block.instructions[i].critical = true;
+    block.latency = last < 0 ? 0.0 : block.instructions[last].ready;
+
+    block.uops = fused;
+    block.portPressure = pressure_;
+    block.throughput = static_cast<double>(fused) / model_.issueWidth;
+    block.bottleneck = "issue width";
+    for (size_t p = 0; p < pressure_.size(); ++p) {
+        if (pressure_[p] > block.throughput) {
+            block.throughput = pressure_[p];
+            block.bottleneck = p + 1 == pressure_.size() ? "divider" : model_.ports[p];
+        }
+    }
+    if (block.latency > block.throughput) block.bottleneck = "dependency chain";
+    return block;
+}
+
+bool endsBlock(const std::string& text) {
+    std::string mnemonic = text.substr(0, text.find(' '));
+    return (mnemonic.size() >= 2 && mnemonic[0] == 'j') || mnemonic == "call" || mnemonic == "ret";
+}
+
+} // namespace
+
+bool parseMicroarch(const std::string& name, Microarch& out) {
+    for (Microarch arch : { MICROARCH_SKYLAKE, MICROARCH_ZEN3, MICROARCH_ZEN4 }) {
+        if (name == microarchName(arch)) {
+            out = arch;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* microarchName(Microarch arch) {
+    switch (arch) {
+    case MICROARCH_SKYLAKE: return "skylake";
+    case MICROARCH_ZEN3: return "zen3";
+    case MICROARCH_ZEN4: return "zen4";
+    }
+    return "unknown";
+}
+
+PerfReport analyzePerformance(const std::vector<ListedInstruction>& listing, Microarch arch) {
+    ArchModel model = arch == MICROARCH_SKYLAKE ? skylake() : arch == MICROARCH_ZEN3 ? zen3() : zen4();
+    PerfReport report;
+    report.arch = arch;
+    report.ports = model.ports;
+
+    // Labels written inside asm_ templates arrive as instructions ending in ':'.
+    auto isLabel = [](const ListedInstruction& line) {
+        return line.label || (!line.text.empty() && line.text.back() == ':');
+    };
+    size_t i = 0;
+    while (i < listing.size()) {
+        std::string label;
+        if (isLabel(listing[i])) {
+            label = listing[i].text;
+            if (!listing[i].label) label.pop_back();
+            ++i;
+        }
+        size_t first = i;
+        while (i < listing.size() && !isLabel(listing[i])) {
+            if (endsBlock(listing[i++].text)) break;
+        }
+        if (first < i) {
+            BlockAnalyzer analyzer(model);
+            report.blocks.push_back(analyzer.run(listing, first, i, label));
+        }
+    }
+    return report;
+}
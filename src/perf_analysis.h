@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Codegen.h"
+
+// Static throughput analysis of the generated function, in the manner of
+// llvm-mca, for --analyze-perf. The listing is split into basic blocks at
+// labels and after jumps, calls and returns. Every instruction gets a latency,
+// a count of fused-domain uops and the execution ports its uops can use from
+// a per-microarchitecture table; dependencies go through registers, flags and
+// stack memory (variable slots and push/pop temporaries), where a load after a
+// store to the same slot waits for store-to-load forwarding. Each block then
+// has two estimates: the critical dependency chain of one pass, and the cycles
+// per iteration if it ran back to back, limited by the busiest port, the
+// divider or the issue width. Table values are typical-case figures from the
+// vendors' optimization manuals and published measurements; division uses the
+// fast end of its data-dependent range.
+
+enum Microarch {
+    MICROARCH_SKYLAKE,
+    MICROARCH_ZEN3,
+    MICROARCH_ZEN4,
+};
+
+// "skylake", "zen3" or "zen4".
+bool parseMicroarch(const std::string& name, Microarch& out);
+const char* microarchName(Microarch arch);
+
+struct PerfInstruction {
+    size_t listing = 0;    // Index into the analyzed listing
+    int latency = 0;       // Cycles from its inputs being ready to its result, including any load
+    int uops = 0;          // Fused-domain uops issued
+    double ready = 0.0;    // Cycle its result is ready, counted from the start of the block
+    bool critical = false; // On the block's longest dependency chain
+    bool modeled = true;   // False for mnemonics the tables lack: counted as one ALU uop of latency 1
+};
+
+struct PerfBlock {
+    std::string label;                  // Label the block starts at, or "" after a jump or call
+    std::vector<PerfInstruction> instructions;
+    int uops = 0;
+    double latency = 0.0;               // Longest dependency chain through one pass
+    double throughput = 0.0;            // Cycles per iteration run back to back
+    std::string bottleneck;             // Port name, "divider", "issue width" or "dependency chain"
+    std::vector<double> portPressure;   // Cycles per iteration on each of PerfReport::ports
+};
+
+struct PerfReport {
+    Microarch arch = MICROARCH_SKYLAKE;
+    std::vector<std::string> ports;     // Execution ports, then the divider
+    std::vector<PerfBlock> blocks;      // In listing order; blocks without instructions are left out
+};
+
+PerfReport analyzePerformance(const std::vector<ListedInstruction>& listing, Microarch arch);
@@ -0,0 +1,268 @@
+// radix_sort.cpp
+#include "radix_sort.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "reduce_scan.h"
+
+namespace {
+
+constexpr size_t kNetworkSize = 16;
+constexpr size_t kMergeLimit = 1024; // Larger arrays are radix sorted
+constexpr size_t kBuckets = 256; // 8-bit digits
+
+// Keys as unsigned integers whose order is the keys' order.
+uint32_t sortBits(uint32_t key) { return key; }
+uint64_t sortBits(uint64_t key) { return key; }
+
+// Negative floats reverse their magnitude order, so all their bits flip;
+// non-negative ones only need to sort above them.
+uint32_t sortBits(float key) {
+    uint32_t bits;
+    std::memcpy(&bits, &key, sizeof(bits));
+    return bits & 0x80000000u ? ~bits : bits | 0x80000000u;
+}
+
+template <typename K>
+using Bits = decltype(sortBits(K{}));
+
+// --- Sorting network ---
+
+template <typename K>
+struct Entry {
+    Bits<K> bits;
+    uint32_t index; // Position before sorting; breaks ties so the sort is stable
+};
+
+template <typename K>
+bool operator<(const Entry<K>& a, const Entry<K>& b) {
+    return a.bits < b.bits || (a.bits == b.bits && a.index < b.index);
+}
+
+// Branchless: both selects compile to conditional moves.
+template <typename K>
+void compareExchange(Entry<K>& a, Entry<K>& b) {
+    bool swap = b < a;
+    Entry<K> lo = swap ? b : a;
+    Entry<K> hi = swap ? a : b;
+    a = lo;
+    b = hi;
+}
+
+struct Comparator {
+    uint8_t a, b;
+};
+
+// Batcher's odd-even merge sort over 16 inputs: 63 comparators.
+constexpr auto kNetwork = [] {
+    std::array<Comparator, 63> network{};
+    size_t count = 0;
+    for (size_t p = 1; p < kNetworkSize; p <<= 1) {
+        for (size_t k = p; k >= 1; k >>= 1) {
+            for (size_t j = k % p; j + k < kNetworkSize; j += 2 * k) {
+                for (size_t i = 0; i < k && i + j + k < kNetworkSize; ++i) {
+                    if ((i + j) / (2 * p) == (i + j + k) / (2 * p)) {
+                        network[count++] = { uint8_t(i + j), uint8_t(i + j + k) };
+                    }
+                }
+            }
+        }
+    }
+    return network;
+}();
+
+// Sorts up to 16 entries in place; missing entries are padded with the largest
+// key and sort after the real ones.
+template <typename K>
+void sortingNetwork(Entry<K>* entries, size_t n) {
+    Entry<K> run[kNetworkSize];
+    for (uint32_t i = 0; i < kNetworkSize; ++i) {
+        run[i] = i < n ? entries[i] : Entry<K>{ std::numeric_limits<Bits<K>>::max(), UINT32_MAX };
+    }
+    for (const Comparator& c : kNetwork) compareExchange(run[c.a], run[c.b]);
+    std::copy(run, run + n, entries);
+}
+
+// Keys back from their sort bits.
+template <typename K>
+K fromBits(Bits<K> bits) {
+    if constexpr (std::is_same_v<K, float>) {
+        bits = bits & 0x80000000u ? bits & 0x7FFFFFFFu : ~bits;
+        float key;
+        std::memcpy(&key, &bits, sizeof(key));
+        return key;
+    }
+    else {
+        return bits;
+    }
+}
+
+template <typename K>
+void writeSorted(const Entry<K>* entries, K* keys, uint32_t* values, uint32_t* scratch, size_t n) {
+    if (values) {
+        for (size_t i = 0; i < n; ++i) scratch[i] = values[entries[i].index];
+        std::copy(scratch, scratch + n, values);
+    }
+    for (size_t i = 0; i < n; ++i) keys[i] = fromBits<K>(entries[i].bits);
+}
+
+// Small arrays: the network sorts runs of 16, then bottom-up merges join them.
+template <typename K>
+void networkMergeSort(K* keys, uint32_t* values, size_t n) {
+    if (n <= kNetworkSize) {
+        Entry<K> entries[kNetworkSize];
+        uint32_t scratch[kNetworkSize];
+        for (size_t i = 0; i < n; ++i) entries[i] = { sortBits(keys[i]), static_cast<uint32_t>(i) };
+        sortingNetwork(entries, n);
+        writeSorted(entries, keys, values, scratch, n);
+        return;
+    }
+    std::vector<Entry<K>> buffer(2 * n);
+    Entry<K>* entries = buffer.data();
+    Entry<K>* merged = entries + n;
+    for (size_t i = 0; i < n; ++i) entries[i] = { sortBits(keys[i]), static_cast<uint32_t>(i) };
+    for (size_t i = 0; i < n; i += kNetworkSize) {
+        sortingNetwork(entries + i, std::min(kNetworkSize, n - i));
+    }
+    for (size_t width = kNetworkSize; width < n; width *= 2) {
+        for (size_t i = 0; i < n; i += 2 * width) {
+            size_t mid = std::min(i + width, n), end = std::min(i + 2 * width, n);
+            std::merge(entries + i, entries + mid, entries + mid, entries + end, merged + i);
+        }
+        std::swap(entries, merged);
+    }
+    std::vector<uint32_t> scratch(values ? n : 0);
+    writeSorted(entries, keys, values, scratch.data(), n);
+}
+
+// --- Radix sort ---
+
+template <typename K>
+size_t digitOf(K key, int digit) {
+    return static_cast<size_t>(sortBits(key) >> (8 * digit)) & (kBuckets - 1);
+}
+
+template <typename K>
+struct Histogram {
+    size_t counts[sizeof(Bits<K>)][kBuckets];
+};
+
+// Counts every digit of every key in one read of the keys.
+template <typename K>
+void countDigits(const K* keys, size_t begin, size_t end, Histogram<K>& histogram) {
+    std::memset(&histogram, 0, sizeof(histogram));
+    for (size_t i = begin; i < end; ++i) {
+        Bits<K> bits = sortBits(keys[i]);
+        for (size_t d = 0; d < sizeof(Bits<K>); ++d) {
+            ++histogram.counts[d][(bits >> (8 * d)) & (kBuckets - 1)];
+        }
+    }
+}
+
+// Moves keys [begin, end) to their buckets; `offsets` holds each bucket's next slot.
+template <typename K, bool VALUES>
+void scatter(const K* keys, const uint32_t* values, K* keysOut, uint32_t* valuesOut,
+             size_t begin, size_t end, int digit, size_t* offsets) {
+    for (size_t i = begin; i < end; ++i) {
+        size_t slot = offsets[digitOf(keys[i], digit)]++;
+        keysOut[slot] = keys[i];
+        if constexpr (VALUES) valuesOut[slot] = values[i];
+    }
+}
+
+template <typename K, bool VALUES>
+void radixSortImpl(K* keys, uint32_t* values, size_t n, const SortOptions& options) {
+    constexpr int kDigits = sizeof(Bits<K>);
+    ScanOptions split;
+    split.parallelThreshold = options.parallelThreshold;
+    split.threads = options.threads;
+    const size_t blocks = scanBlockCount(n, split);
+    auto begin = [&](size_t b) { return n * b / blocks; };
+
+    std::vector<Histogram<K>> histograms(blocks);
+    runScanBlocks(blocks, [&](size_t b) { countDigits(keys, begin(b), begin(b + 1), histograms[b]); });
+    Histogram<K> total = histograms[0];
+    for (size_t b = 1; b < blocks; ++b) {
+        for (int d = 0; d < kDigits; ++d) {
+            for (size_t bucket = 0; bucket < kBuckets; ++bucket) total.counts[d][bucket] += histograms[b].counts[d][bucket];
+        }
+    }
+
+    std::vector<K> keyBuffer(n);
+    std::vector<uint32_t> valueBuffer(VALUES ? n : 0);
+    K* from = keys;
+    K* to = keyBuffer.data();
+    uint32_t* valuesFrom = values;
+    uint32_t* valuesTo = valueBuffer.data();
+    // Digit totals do not depend on order, but per-block counts describe the
+    // keys' original order only and are redone for later digits.
+    bool original = true;
+    std::vector<size_t> offsets(blocks * kBuckets);
+
+    for (int d = 0; d < kDigits; ++d) {
+        if (total.counts[d][digitOf(keys[0], d)] == n) continue; // Every key has the same digit
+        if (blocks == 1) {
+            std::copy(total.counts[d], total.counts[d] + kBuckets, offsets.begin());
+        }
+        else if (original) {
+            for (size_t b = 0; b < blocks; ++b) {
+                std::copy(histograms[b].counts[d], histograms[b].counts[d] + kBuckets, &offsets[b * kBuckets]);
+            }
+        }
+        else {
+            runScanBlocks(blocks, [&](size_t b) {
+                size_t* counts = &offsets[b * kBuckets];
+                std::fill(counts, counts + kBuckets, 0);
+                for (size_t i = begin(b); i < begin(b + 1); ++i) ++counts[digitOf(from[i], d)];
+            });
+        }
+        // Bucket-major, block-minor exclusive prefix keeps the sort stable.
+        size_t sum = 0;
+        for (size_t bucket = 0; bucket < kBuckets; ++bucket) {
+            for (size_t b = 0; b < blocks; ++b) {
+                size_t count = offsets[b * kBuckets + bucket];
+                offsets[b * kBuckets + bucket] = sum;
+                sum += count;
+            }
+        }
+        runScanBlocks(blocks, [&](size_t b) {
+            scatter<K, VALUES>(from, valuesFrom, to, valuesTo, begin(b), begin(b + 1), d, &offsets[b * kBuckets]);
+        });
+        std::swap(from, to);
+        std::swap(valuesFrom, valuesTo);
+        original = false;
+    }
+
+    if (from != keys) {
+        std::copy(from, from + n, keys);
+        if constexpr (VALUES) std::copy(valuesFrom, valuesFrom + n, values);
+    }
+}
+
+template <typename K>
+void sortKeys(K* keys, uint32_t* values, size_t n, const SortOptions& options) {
+    if (n < 2) return;
+    if (n <= kMergeLimit) networkMergeSort(keys, values, n);
+    else if (values) radixSortImpl<K, true>(keys, values, n, options);
+    else radixSortImpl<K, false>(keys, values, n, options);
+}
+
+} // namespace
+
+void radixSort(uint32_t* keys, uint32_t* values, size_t n, const SortOptions& options) {
+    sortKeys(keys, values, n, options);
+}
+
+void radixSort(uint64_t* keys, uint32_t* values, size_t n, const SortOptions& options) {
+    sortKeys(keys, values, n, options);
+}
+
+void radixSort(float* keys, uint32_t* values, size_t n, const SortOptions& options) {
+    sortKeys(keys, values, n, options);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Stable ascending sort of keys with an optional array of values that moves
+// with them, for host code such as depth sorting transparent geometry and
+// particles. Up to 1024 elements are sorted in runs of 16 by a branchless
+// sorting network and merged; larger arrays use an LSD radix sort over 8-bit
+// digits, building every digit's histogram in one read of the keys and
+// skipping digits all keys share. Arrays of at least `parallelThreshold` keys
+// histogram and scatter each digit in one block per thread. Float keys sort
+// by IEEE total order: -NaN < -inf < ... < -0.0 < +0.0 < ... < +inf < +NaN.
+// `values` may be null.
+
+struct SortOptions {
+    size_t parallelThreshold = size_t(1) << 17; // Keys; smaller arrays sort on the calling thread
+    unsigned threads = 0;                       // 0: std::thread::hardware_concurrency()
+};
+
+void radixSort(uint32_t* keys, uint32_t* values, size_t n, const SortOptions& options = {});
+void radixSort(uint64_t* keys, uint32_t* values, size_t n, const SortOptions& options = {});
+void radixSort(float* keys, uint32_t* values, size_t n, const SortOptions& options = {});
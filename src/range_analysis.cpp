@@ -0,0 +1,294 @@
+// range_analysis.cpp
+#include "range_analysis.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+// Checked 64-bit arithmetic; false when the exact result does not fit.
+bool addChecked(int64_t a, int64_t b, int64_t& out) {
+    if ((b > 0 && a > INT64_MAX - b) || (b < 0 && a < INT64_MIN - b)) return false;
+    out = a + b;
+    return true;
+}
+
+bool subChecked(int64_t a, int64_t b, int64_t& out) {
+    if ((b < 0 && a > INT64_MAX + b) || (b > 0 && a < INT64_MIN + b)) return false;
+    out = a - b;
+    return true;
+}
+
+bool mulChecked(int64_t a, int64_t b, int64_t& out) {
+    if (a == 0 || b == 0) { out = 0; return true; }
+    if ((a == -1 && b == INT64_MIN) || (b == -1 && a == INT64_MIN)) return false;
+    if (a > 0 ? (b > 0 ? a > INT64_MAX / b : b < INT64_MIN / a)
+              : (b > 0 ? a < INT64_MIN / b : a < INT64_MAX / b)) return false;
+    out = a * b;
+    return true;
+}
+
+// Hull of the four corner results of a binary operation; full() if any wraps.
+template <typename Op>
+Interval corners(const Interval& a, const Interval& b, Op op) {
+    int64_t values[4];
+    if (!op(a.lo, b.lo, values[0]) || !op(a.lo, b.hi, values[1]) ||
+        !op(a.hi, b.lo, values[2]) || !op(a.hi, b.hi, values[3])) {
+        return Interval::full();
+    }
+    return { *std::min_element(values, values + 4), *std::max_element(values, values + 4) };
+}
+
+Interval hull(const Interval& a, const Interval& b) {
+    return { std::min(a.lo, b.lo), std::max(a.hi, b.hi) };
+}
+
+// Largest magnitude in the interval; INT64_MAX stands in for |INT64_MIN|.
+int64_t magnitude(const Interval& a) {
+    int64_t lo = a.lo == INT64_MIN ? INT64_MAX : -a.lo;
+    return std::max(lo, a.hi);
+}
+
+Interval divide(const Interval& a, const Interval& b) {
+    // A divisor that may be zero faults; otherwise |a / b| <= |a|.
+    if (b.contains(0) || (b.contains(-1) && a.lo == INT64_MIN)) {
+        int64_t m = magnitude(a);
+        return { -m, m };
+    }
+    // Truncating division is monotonic in each operand when the divisor keeps its sign.
+    return corners(a, b, [](int64_t x, int64_t y, int64_t& out) { out = x / y; return true; });
+}
+
+Interval remainder(const Interval& a, const Interval& b) {
+    if (a.lo == a.hi && b.lo == b.hi && b.lo != 0 && !(a.lo == INT64_MIN && b.lo == -1)) {
+        return Interval::exactly(a.lo % b.lo);
+    }
+    // The result takes the dividend's sign and is smaller in magnitude than the divisor.
+    int64_t m = magnitude(b);
+    if (m > 0) m -= 1;
+    int64_t up = std::min(std::max<int64_t>(a.hi, 0), m);
+    int64_t down = std::min(a.lo < 0 ? magnitude({ a.lo, 0 }) : 0, m);
+    return { -down, up };
+}
+
+bool isComparison(TokenType op) {
+    return op == LT || op == GT || op == LT_EQ || op == GT_EQ || op == EQ || op == NOT_EQ;
+}
+
+TokenType negate(TokenType op) {
+    switch (op) {
+    case LT: return GT_EQ;
+    case GT: return LT_EQ;
+    case LT_EQ: return GT;
+    case GT_EQ: return LT;
+    case EQ: return NOT_EQ;
+    default: return EQ;
+    }
+}
+
+// `lit < x` is `x > lit`.
+TokenType mirror(TokenType op) {
+    switch (op) {
+    case LT: return GT;
+    case GT: return LT;
+    case LT_EQ: return GT_EQ;
+    case GT_EQ: return LT_EQ;
+    default: return op;
+    }
+}
+
+} // namespace
+
+std::string Interval::str() const {
+    std::ostringstream out;
+    out << "[";
+    if (lo == INT64_MIN) out << "-inf"; else out << lo;
+    out << ", ";
+    if (hi == INT64_MAX) out << "+inf"; else out << hi;
+    out << "]";
+    return out.str();
+}
+
+void RangeAnalysis::run(const Program& program) {
+    ranges_.clear();
+    variables_.assign(program.slotCount, Interval::full());
+    remarks_.clear();
+
+    for (const auto& stmt : program.statements) {
+        if (auto assign = dynamic_cast<const AssignmentStatement*>(stmt.get())) {
+            Interval range = visit(assign->value.get());
+            variables_[assign->identifier->slot] = range;
+            if (!range.isFull() && assign->value->resolvedType == INT) {
+                remarks_.push_back({ assign->offset, "range",
+                    assign->identifier->name + " in " + range.str() });
+            }
+        }
+        else if (auto print = dynamic_cast<const PrintStatement*>(stmt.get())) {
+            visit(print->expression.get());
+        }
+        else if (auto expr = dynamic_cast<const ExpressionStatement*>(stmt.get())) {
+            visit(expr->expression.get());
+        }
+        else if (auto block = dynamic_cast<const AsmStatement*>(stmt.get())) {
+            for (const auto& input : block->inputs) {
+                visit(input.expression.get());
+            }
+            for (const auto& clobber : block->clobbers) {
+                if (clobber == "memory") variables_.assign(variables_.size(), Interval::full());
+            }
+            for (const auto& output : block->outputs) {
+                variables_[static_cast<const IdentifierExpr*>(output.expression.get())->slot] = Interval::full();
+            }
+        }
+    }
+}
+
+Interval RangeAnalysis::rangeOf(const Expression* node) const {
+    auto it = ranges_.find(node);
+    return it == ranges_.end() ? Interval::full() : it->second;
+}
+
+Interval RangeAnalysis::visit(const Expression* node) {
+    Interval range = Interval::full();
+    if (auto i = dynamic_cast<const IntegerLiteral*>(node)) {
+        range = Interval::exactly(i->value);
+    }
+    else if (auto b = dynamic_cast<const BooleanLiteral*>(node)) {
+        range = Interval::exactly(b->value ? 1 : 0);
+    }
+    else if (auto id = dynamic_cast<const IdentifierExpr*>(node)) {
+        range = variables_[id->slot];
+    }
+    else if (auto bin = dynamic_cast<const BinaryExpression*>(node)) {
+        range = visitBinary(bin);
+    }
+    else if (auto unary = dynamic_cast<const UnaryExpression*>(node)) {
+        Interval operand = visit(unary->operand.get());
+        if (unary->op == BANG) {
+            range = { 0, 1 };
+        }
+        else if (unary->op == MINUS && operand.lo != INT64_MIN) {
+            range = { -operand.hi, -operand.lo };
+        }
+    }
+    else if (auto cond = dynamic_cast<const ConditionalExpression*>(node)) {
+        range = visitConditional(cond);
+    }
+    else if (auto match = dynamic_cast<const MatchExpression*>(node)) {
+        range = visitMatch(match);
+    }
+    if (node->resolvedType == BOOL) {
+        range = { std::max<int64_t>(range.lo, 0), std::min<int64_t>(range.hi, 1) };
+        if (range.lo > range.hi) range = { 0, 1 };
+    }
+    ranges_[node] = range;
+    return range;
+}
+
+Interval RangeAnalysis::visitBinary(const BinaryExpression* node) {
+    Interval left = visit(node->left.get());
+    if (node->op == AND || node->op == OR) {
+        // The right operand only runs when the left one did not decide the result.
+        auto saved = variables_;
+        refine(node->left.get(), node->op == AND);
+        visit(node->right.get());
+        variables_ = std::move(saved);
+        return { 0, 1 };
+    }
+    Interval right = visit(node->right.get());
+
+    switch (node->op) {
+    case PLUS: return corners(left, right, addChecked);
+    case MINUS: return corners(left, right, subChecked);
+    case ASTERISK: return corners(left, right, mulChecked);
+    case SLASH: return divide(left, right);
+    case PERCENT: return remainder(left, right);
+    default: return { 0, 1 };
+    }
+}
+
+Interval RangeAnalysis::visitConditional(const ConditionalExpression* node) {
+    Interval condition = visit(node->condition.get());
+    auto saved = variables_;
+
+    refine(node->condition.get(), true);
+    Interval thenRange = visit(node->thenExpr.get());
+    variables_ = saved;
+
+    refine(node->condition.get(), false);
+    Interval elseRange = visit(node->elseExpr.get());
+    variables_ = std::move(saved);
+
+    if (condition.lo == 1) return thenRange;
+    if (condition.hi == 0) return elseRange;
+    return hull(thenRange, elseRange);
+}
+
+// Inside an arm the subject holds one of the arm's values; a variable subject is
+// narrowed to their hull. Arms the subject's range cannot reach do not count.
+Interval RangeAnalysis::visitMatch(const MatchExpression* node) {
+    Interval subject = visit(node->subject.get());
+    auto id = dynamic_cast<const IdentifierExpr*>(node->subject.get());
+    Interval result;
+    bool any = false;
+    for (const auto& arm : node->arms) {
+        Interval values = subject;
+        if (!arm.ranges.empty()) {
+            Interval patterns = { arm.ranges[0].first, arm.ranges[0].second };
+            for (const auto& [lo, hi] : arm.ranges) {
+                patterns = hull(patterns, { lo, hi });
+            }
+            values = { std::max(subject.lo, patterns.lo), std::min(subject.hi, patterns.hi) };
+        }
+        auto saved = variables_;
+        bool reachable = values.lo <= values.hi;
+        if (id && reachable) variables_[id->slot] = values;
+        Interval range = visit(arm.value.get());
+        variables_ = std::move(saved);
+        if (!reachable) continue;
+        result = any ? hull(result, range) : range;
+        any = true;
+    }
+    return any ? result : Interval::full();
+}
+
+// Narrows variable ranges under the assumption that `condition` evaluated to `taken`.
+void RangeAnalysis::refine(const Expression* condition, bool taken) {
+    if (auto unary = dynamic_cast<const UnaryExpression*>(condition)) {
+        if (unary->op == BANG) refine(unary->operand.get(), !taken);
+        return;
+    }
+    auto bin = dynamic_cast<const BinaryExpression*>(condition);
+    if (!bin) return;
+    if ((bin->op == AND && taken) || (bin->op == OR && !taken)) {
+        refine(bin->left.get(), taken);
+        refine(bin->right.get(), taken);
+        return;
+    }
+    if (!isComparison(bin->op)) return;
+
+    TokenType op = bin->op;
+    auto id = dynamic_cast<const IdentifierExpr*>(bin->left.get());
+    const Expression* bound = bin->right.get();
+    if (!id) {
+        id = dynamic_cast<const IdentifierExpr*>(bin->right.get());
+        bound = bin->left.get();
+        op = mirror(op);
+    }
+    if (!id || id->resolvedType != INT) return;
+    if (!taken) op = negate(op);
+
+    Interval limit = rangeOf(bound);
+    Interval& var = variables_[id->slot];
+    Interval narrowed = var;
+    switch (op) {
+    case LT: if (limit.hi != INT64_MIN) narrowed.hi = std::min(var.hi, limit.hi - 1); break;
+    case LT_EQ: narrowed.hi = std::min(var.hi, limit.hi); break;
+    case GT: if (limit.lo != INT64_MAX) narrowed.lo = std::max(var.lo, limit.lo + 1); break;
+    case GT_EQ: narrowed.lo = std::max(var.lo, limit.lo); break;
+    case EQ: narrowed = { std::max(var.lo, limit.lo), std::min(var.hi, limit.hi) }; break;
+    default: break;
+    }
+    // An empty range means the branch is unreachable; keep the old range rather than invent one.
+    if (narrowed.lo <= narrowed.hi) var = narrowed;
+}
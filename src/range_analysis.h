@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ast.h"
+#include "diagnostics.h"
+
+// Closed interval of 64-bit values. Arithmetic that could wrap yields full().
+struct Interval {
+    int64_t lo = INT64_MIN;
+    int64_t hi = INT64_MAX;
+
+    static Interval full() { return {}; }
+    static Interval exactly(int64_t v) { return { v, v }; }
+    bool isFull() const { return lo == INT64_MIN && hi == INT64_MAX; }
+    bool nonNegative() const { return lo >= 0; }
+    bool within(int64_t min, int64_t max) const { return lo >= min && hi <= max; }
+    bool contains(int64_t v) const { return lo <= v && v <= hi; }
+    std::string str() const;
+};
+
+// Forward interval analysis over the straight-line program. Ranges come from
+// literals, arithmetic, `%` by a bounded divisor, and comparisons: in
+// `x < 10 ? a : b` the analysis knows x <= 9 while evaluating `a` and x >= 10
+// while evaluating `b`, and a `match` subject lies within each arm's patterns
+// while that arm is evaluated. Booleans are [0, 1].
+class RangeAnalysis {
+public:
+    void run(const Program& program);
+
+    // Range of an expression node analyzed by run(); full() if unknown.
+    Interval rangeOf(const Expression* node) const;
+    const std::vector<Remark>& remarks() const { return remarks_; }
+
+private:
+    std::map<const Expression*, Interval> ranges_;
+    std::vector<Interval> variables_; // By variable slot
+    std::vector<Remark> remarks_;
+
+    Interval visit(const Expression* node);
+    Interval visitBinary(const BinaryExpression* node);
+    Interval visitConditional(const ConditionalExpression* node);
+    Interval visitMatch(const MatchExpression* node);
+    void refine(const Expression* condition, bool taken);
+};
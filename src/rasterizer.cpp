@@ -0,0 +1,327 @@
+// rasterizer.cpp
+#include "rasterizer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "reduce_scan.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GFXL_HAVE_SSE2 1
+#endif
+
+namespace {
+
+constexpr int kTileSize = 64;
+constexpr int kBlockSize = 8;
+constexpr int kSubpixelBits = 4;
+constexpr int kSubpixel = 1 << kSubpixelBits;
+constexpr float kGuardBand = 8192.0f;
+
+// E(px, py) = origin + stepX * px + stepY * py at pixel centers; a pixel is
+// inside the edge when E >= 0. `bias` (0 or 1) is already subtracted from
+// `origin` on edges the fill rule does not own.
+struct Edge {
+    int64_t origin;
+    int64_t stepX;
+    int64_t stepY;
+    int64_t bias;
+
+    int64_t at(int64_t px, int64_t py) const { return origin + stepX * px + stepY * py; }
+};
+
+struct Triangle {
+    Edge edges[3];        // edges[k] is opposite vertex k; its value is k's barycentric weight times 2 * area
+    double invArea;       // 1 / (2 * area) in subpixel units
+    int b1Edge, b2Edge;   // Edges giving the second and third vertex's weights in the caller's winding
+    float z0, dz1, dz2;   // z = z0 + b1 * dz1 + b2 * dz2
+    int minX, minY, maxX, maxY; // Pixel bounds, inclusive, clipped to the image
+    uint32_t index;
+};
+
+int64_t snap(float v) {
+    return static_cast<int64_t>(std::lround(v * kSubpixel));
+}
+
+int64_t floorDiv(int64_t a, int64_t b) {
+    return a / b - ((a % b != 0) && ((a < 0) != (b < 0)));
+}
+
+// The edge from a to b; inside is to its left in a y-down, positively wound triangle.
+Edge makeEdge(int64_t ax, int64_t ay, int64_t bx, int64_t by) {
+    Edge e;
+    int64_t dx = bx - ax, dy = by - ay;
+    e.stepX = -dy * kSubpixel;
+    e.stepY = dx * kSubpixel;
+    // Pixel (0, 0) samples at subpixel (kSubpixel / 2, kSubpixel / 2).
+    e.origin = dx * (kSubpixel / 2 - ay) - dy * (kSubpixel / 2 - ax);
+    // The neighbour sharing this edge walks it the other way, so exactly one of
+    // the two owns pixels lying on it.
+    bool owned = dy > 0 || (dy == 0 && dx < 0);
+    e.bias = owned ? 0 : 1;
+    e.origin -= e.bias;
+    return e;
+}
+
+bool setupTriangle(const RasterImage& image, const RasterVertex* vertices, const uint32_t* indices,
+                   uint32_t index, Triangle& t) {
+    const RasterVertex* v[3] = { &vertices[indices[3 * index]], &vertices[indices[3 * index + 1]],
+                                 &vertices[indices[3 * index + 2]] };
+    int64_t x[3], y[3];
+    for (int k = 0; k < 3; ++k) {
+        if (!(std::fabs(v[k]->x) < kGuardBand && std::fabs(v[k]->y) < kGuardBand)) return false;
+        x[k] = snap(v[k]->x);
+        y[k] = snap(v[k]->y);
+    }
+    int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+    if (area == 0) return false;
+    bool swapped = area < 0;
+    if (swapped) {
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+        area = -area;
+    }
+
+    int64_t minX = std::min({ x[0], x[1], x[2] }), maxX = std::max({ x[0], x[1], x[2] });
+    int64_t minY = std::min({ y[0], y[1], y[2] }), maxY = std::max({ y[0], y[1], y[2] });
+    t.minX = static_cast<int>(std::max<int64_t>(0, -floorDiv(kSubpixel / 2 - minX, kSubpixel)));
+    t.minY = static_cast<int>(std::max<int64_t>(0, -floorDiv(kSubpixel / 2 - minY, kSubpixel)));
+    t.maxX = static_cast<int>(std::min<int64_t>(image.width - 1, floorDiv(maxX - kSubpixel / 2, kSubpixel)));
+    t.maxY = static_cast<int>(std::min<int64_t>(image.height - 1, floorDiv(maxY - kSubpixel / 2, kSubpixel)));
+    if (t.minX > t.maxX || t.minY > t.maxY) return false;
+
+    t.edges[0] = makeEdge(x[1], y[1], x[2], y[2]);
+    t.edges[1] = makeEdge(x[2], y[2], x[0], y[0]);
+    t.edges[2] = makeEdge(x[0], y[0], x[1], y[1]);
+    t.invArea = 1.0 / static_cast<double>(area);
+    t.b1Edge = swapped ? 2 : 1;
+    t.b2Edge = swapped ? 1 : 2;
+    t.z0 = v[0]->z;
+    t.dz1 = v[1]->z - v[0]->z;
+    t.dz2 = v[2]->z - v[0]->z;
+    t.index = index;
+    return true;
+}
+
+// --- Tiles ---
+
+// A barycentric weight as a float plane relative to the region origin.
+struct Plane {
+    float origin, dx, dy;
+};
+
+Plane weightPlane(const Triangle& t, int edge, int x0, int y0) {
+    const Edge& e = t.edges[edge];
+    return { static_cast<float>((e.at(x0, y0) + e.bias) * t.invArea),
+             static_cast<float>(e.stepX * t.invArea), static_cast<float>(e.stepY * t.invArea) };
+}
+
+// Edge values at the region origin and per-pixel steps; a zero edge always passes.
+struct QuadEdges {
+    int32_t origin[3];
+    int32_t stepX[3];
+    int32_t stepY[3];
+    alignas(16) int32_t lanes[3][4]; // Offsets of a quad's four pixels from its top-left one
+
+    void set(int k, int32_t value, int32_t dx, int32_t dy) {
+        origin[k] = value;
+        stepX[k] = dx;
+        stepY[k] = dy;
+        lanes[k][0] = 0;
+        lanes[k][1] = dx;
+        lanes[k][2] = dy;
+        lanes[k][3] = dx + dy;
+    }
+};
+
+// Coverage of the quad at (dx, dy) from the region origin, lane i = bit i.
+uint32_t coverQuad(const QuadEdges& q, int dx, int dy) {
+#if GFXL_HAVE_SSE2
+    __m128i outside = _mm_setzero_si128();
+    for (int k = 0; k < 3; ++k) {
+        int32_t base = q.origin[k] + q.stepX[k] * dx + q.stepY[k] * dy;
+        __m128i lanes = _mm_add_epi32(_mm_set1_epi32(base), _mm_load_si128(reinterpret_cast<const __m128i*>(q.lanes[k])));
+        outside = _mm_or_si128(outside, lanes);
+    }
+    return ~static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(outside))) & 0xF;
+#else
+    uint32_t mask = 0;
+    for (int lane = 0; lane < 4; ++lane) {
+        bool inside = true;
+        for (int k = 0; k < 3; ++k) {
+            inside &= q.origin[k] + q.stepX[k] * dx + q.stepY[k] * dy + q.lanes[k][lane] >= 0;
+        }
+        mask |= uint32_t(inside) << lane;
+    }
+    return mask;
+#endif
+}
+
+struct TileContext {
+    RasterImage* image;
+    const std::vector<Triangle>* triangles;
+    FragmentShader shader;
+    void* user;
+};
+
+void shadeQuad(const TileContext& ctx, const Triangle& t, const Plane& b1, const Plane& b2,
+               int x, int y, int dx, int dy, uint32_t mask, RasterStats& stats) {
+    // Locals, so stores to the image need not reload them.
+    uint32_t* const pixels = ctx.image->pixels;
+    float* const depth = ctx.image->depth;
+    const size_t rows[2] = { size_t(y) * ctx.image->stride + x, size_t(y + 1) * ctx.image->stride + x };
+
+    RasterQuad quad;
+    quad.x = x;
+    quad.y = y;
+    quad.triangle = t.index;
+#if GFXL_HAVE_SSE2
+    const __m128 fx = _mm_add_ps(_mm_set1_ps(static_cast<float>(dx)), _mm_setr_ps(0, 1, 0, 1));
+    const __m128 fy = _mm_add_ps(_mm_set1_ps(static_cast<float>(dy)), _mm_setr_ps(0, 0, 1, 1));
+    __m128 w1 = _mm_add_ps(_mm_set1_ps(b1.origin), _mm_add_ps(_mm_mul_ps(_mm_set1_ps(b1.dx), fx), _mm_mul_ps(_mm_set1_ps(b1.dy), fy)));
+    __m128 w2 = _mm_add_ps(_mm_set1_ps(b2.origin), _mm_add_ps(_mm_mul_ps(_mm_set1_ps(b2.dx), fx), _mm_mul_ps(_mm_set1_ps(b2.dy), fy)));
+    __m128 z = _mm_add_ps(_mm_set1_ps(t.z0), _mm_add_ps(_mm_mul_ps(w1, _mm_set1_ps(t.dz1)), _mm_mul_ps(w2, _mm_set1_ps(t.dz2))));
+    _mm_storeu_ps(quad.b1, w1);
+    _mm_storeu_ps(quad.b2, w2);
+    _mm_storeu_ps(quad.z, z);
+#else
+    for (int lane = 0; lane < 4; ++lane) {
+        float fx = static_cast<float>(dx + (lane & 1)), fy = static_cast<float>(dy + (lane >> 1));
+        quad.b1[lane] = b1.origin + b1.dx * fx + b1.dy * fy;
+        quad.b2[lane] = b2.origin + b2.dx * fx + b2.dy * fy;
+        quad.z[lane] = t.z0 + quad.b1[lane] * t.dz1 + quad.b2[lane] * t.dz2;
+    }
+#endif
+    if (depth) {
+        for (int lane = 0; lane < 4; ++lane) {
+            if ((mask >> lane & 1) && !(quad.z[lane] < depth[rows[lane >> 1] + (lane & 1)])) mask &= ~(1u << lane);
+        }
+        if (!mask) return;
+    }
+    quad.mask = mask;
+    uint32_t colors[4];
+    ctx.shader(quad, colors, ctx.user);
+    if (mask == 0xF && !depth) {
+        pixels[rows[0]] = colors[0];
+        pixels[rows[0] + 1] = colors[1];
+        pixels[rows[1]] = colors[2];
+        pixels[rows[1] + 1] = colors[3];
+    }
+    else {
+        for (int lane = 0; lane < 4; ++lane) {
+            if (!(mask >> lane & 1)) continue;
+            size_t offset = rows[lane >> 1] + (lane & 1);
+            pixels[offset] = colors[lane];
+            if (depth) depth[offset] = quad.z[lane];
+        }
+    }
+    ++stats.quads;
+    // Bits set in each 4-bit mask; std::popcount is a library call without -mpopcnt.
+    stats.pixels += (0x4332322132212110ull >> (mask * 4)) & 0xF;
+}
+
+// Rasterizes one triangle over [x0, x1) x [y0, y1) of one tile, x0 and y0 even.
+void rasterizeRegion(const TileContext& ctx, const Triangle& t, int x0, int y0, int x1, int y1,
+                     RasterStats& stats) {
+    // Quads may reach one pixel past an odd region edge; the image bounds mask them.
+    int qx1 = x0 + ((x1 - x0 + 1) & ~1), qy1 = y0 + ((y1 - y0 + 1) & ~1);
+
+    // Reject the region or trivially accept edges from their values at its corners.
+    QuadEdges q = {};
+    for (int k = 0; k < 3; ++k) {
+        const Edge& e = t.edges[k];
+        int64_t corners[4] = { e.at(x0, y0), e.at(qx1 - 1, y0), e.at(x0, qy1 - 1), e.at(qx1 - 1, qy1 - 1) };
+        if (*std::max_element(corners, corners + 4) < 0) return;
+        if (*std::min_element(corners, corners + 4) >= 0) continue;
+        // The edge crosses the region, so its values here fit in 32 bits.
+        q.set(k, static_cast<int32_t>(corners[0]), static_cast<int32_t>(e.stepX), static_cast<int32_t>(e.stepY));
+    }
+    Plane b1 = weightPlane(t, t.b1Edge, x0, y0);
+    Plane b2 = weightPlane(t, t.b2Edge, x0, y0);
+    const RasterImage& image = *ctx.image;
+
+    for (int by = y0; by < qy1; by += kBlockSize) {
+        for (int bx = x0; bx < qx1; bx += kBlockSize) {
+            int w = std::min(kBlockSize, qx1 - bx), h = std::min(kBlockSize, qy1 - by);
+            // The same test per 8x8 block, on the 32-bit values.
+            QuadEdges block = q;
+            bool rejected = false;
+            for (int k = 0; k < 3 && !rejected; ++k) {
+                if (q.stepX[k] == 0 && q.stepY[k] == 0 && q.origin[k] == 0) continue;
+                int32_t v = q.origin[k] + q.stepX[k] * (bx - x0) + q.stepY[k] * (by - y0);
+                int32_t across = q.stepX[k] * (w - 1), down = q.stepY[k] * (h - 1);
+                int32_t lo = v + std::min(across, 0) + std::min(down, 0);
+                int32_t hi = v + std::max(across, 0) + std::max(down, 0);
+                if (hi < 0) rejected = true;
+                else if (lo >= 0) block.set(k, 0, 0, 0);
+            }
+            if (rejected) continue;
+
+            for (int y = by; y < by + h; y += 2) {
+                uint32_t rows = y + 1 < image.height ? 0xF : 0x3;
+                for (int x = bx; x < bx + w; x += 2) {
+                    uint32_t mask = coverQuad(block, x - x0, y - y0) & rows;
+                    if (x + 1 >= image.width) mask &= 0x5;
+                    if (mask) shadeQuad(ctx, t, b1, b2, x, y, x - x0, y - y0, mask, stats);
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+RasterStats drawTriangles(RasterImage& image, const RasterVertex* vertices, const uint32_t* indices,
+                          size_t triangleCount, FragmentShader shader, void* user,
+                          const RasterOptions& options) {
+    RasterStats total;
+    if (image.width <= 0 || image.height <= 0) return total;
+    const int tilesX = (image.width + kTileSize - 1) / kTileSize;
+    const int tilesY = (image.height + kTileSize - 1) / kTileSize;
+    const size_t tileCount = size_t(tilesX) * tilesY;
+
+    // Setup and binning, in draw order.
+    std::vector<Triangle> triangles;
+    triangles.reserve(triangleCount);
+    std::vector<std::vector<uint32_t>> bins(tileCount);
+    for (size_t i = 0; i < triangleCount; ++i) {
+        Triangle t;
+        if (!setupTriangle(image, vertices, indices, static_cast<uint32_t>(i), t)) continue;
+        uint32_t slot = static_cast<uint32_t>(triangles.size());
+        triangles.push_back(t);
+        for (int ty = t.minY / kTileSize; ty <= t.maxY / kTileSize; ++ty) {
+            for (int tx = t.minX / kTileSize; tx <= t.maxX / kTileSize; ++tx) {
+                bins[size_t(ty) * tilesX + tx].push_back(slot);
+            }
+        }
+    }
+    total.triangles = triangles.size();
+
+    TileContext ctx{ &image, &triangles, shader, user };
+    size_t workers = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    workers = std::min(workers, tileCount);
+    std::vector<RasterStats> stats(workers);
+    std::atomic<size_t> nextTile{ 0 };
+    runScanBlocks(workers, [&](size_t worker) {
+        for (size_t tile; (tile = nextTile.fetch_add(1, std::memory_order_relaxed)) < tileCount;) {
+            int tx0 = int(tile % tilesX) * kTileSize, ty0 = int(tile / tilesX) * kTileSize;
+            int tx1 = std::min(tx0 + kTileSize, image.width), ty1 = std::min(ty0 + kTileSize, image.height);
+            for (uint32_t slot : bins[tile]) {
+                const Triangle& t = triangles[slot];
+                // Clip to the triangle's bounds, keeping quads aligned to even pixels.
+                int x0 = std::max(tx0, t.minX & ~1), y0 = std::max(ty0, t.minY & ~1);
+                int x1 = std::min(tx1, t.maxX + 1), y1 = std::min(ty1, t.maxY + 1);
+                rasterizeRegion(ctx, t, x0, y0, x1, y1, stats[worker]);
+            }
+        }
+    });
+    for (const auto& s : stats) {
+        total.quads += s.quads;
+        total.pixels += s.pixels;
+    }
+    return total;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Tiled software rasterizer for rendering without a GPU (CI, reference images).
+// Triangles are set up and binned into 64x64 tiles on the calling thread;
+// worker threads then take tiles one at a time and, for every triangle binned
+// there in draw order, reject or trivially accept the tile and then each 8x8
+// block against the three edges before evaluating the edges on 2x2 quads,
+// four pixels per SSE2 step. Covered quads pass an optional depth test and
+// the fragment shader colors them. Tiles do not overlap, so the result does
+// not depend on the thread count.
+//
+// Coverage uses fixed-point edge functions with 4 subpixel bits, pixel
+// centers and a top-left fill rule, so triangles sharing an edge touch every
+// pixel along it exactly once. Both windings are drawn. Triangles with a
+// vertex outside the +/-8192 pixel guard band are skipped.
+
+struct RasterImage {
+    uint32_t* pixels = nullptr; // `height` rows of `stride` pixels
+    float* depth = nullptr;     // Same layout; null disables the depth test
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+};
+
+struct RasterVertex {
+    float x, y; // Screen space, pixels
+    float z;    // Interpolated for the depth test; smaller is nearer
+};
+
+// A 2x2 block of pixels for the shader; lane i is pixel (x + i % 2, y + i / 2).
+struct RasterQuad {
+    int x, y;
+    uint32_t mask;     // Lanes covered by the triangle and passing the depth test
+    uint32_t triangle; // Index of the triangle's first entry in `indices`, divided by 3
+    float b1[4], b2[4]; // Barycentric weights of the triangle's second and third vertex
+    float z[4];
+};
+
+// Writes the color of every lane in `quad.mask`.
+using FragmentShader = void (*)(const RasterQuad& quad, uint32_t colors[4], void* user);
+
+struct RasterOptions {
+    unsigned threads = 0; // 0: std::thread::hardware_concurrency()
+};
+
+struct RasterStats {
+    size_t triangles = 0; // Set up and binned: not degenerate, inside the guard band, overlapping the image
+    size_t quads = 0;     // Shader invocations
+    size_t pixels = 0;    // Pixels written
+};
+
+RasterStats drawTriangles(RasterImage& image, const RasterVertex* vertices, const uint32_t* indices,
+                          size_t triangleCount, FragmentShader shader, void* user,
+                          const RasterOptions& options = {});
@@ -0,0 +1,243 @@
+// reduce_scan.cpp
+#include "reduce_scan.h"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GFXL_HAVE_SSE2 1
+#endif
+
+namespace {
+
+template <typename T, ScanOp OP>
+T identityOf() {
+    if constexpr (OP == SCAN_MIN) return std::numeric_limits<T>::max();
+    else if constexpr (OP == SCAN_MAX) return std::numeric_limits<T>::min();
+    else if constexpr (OP == SCAN_AND) return T(-1);
+    else return T(0);
+}
+
+template <typename T, ScanOp OP>
+T combine(T a, T b) {
+    if constexpr (OP == SCAN_ADD) return T(static_cast<std::make_unsigned_t<T>>(a) + static_cast<std::make_unsigned_t<T>>(b));
+    else if constexpr (OP == SCAN_MIN) return std::min(a, b);
+    else if constexpr (OP == SCAN_MAX) return std::max(a, b);
+    else if constexpr (OP == SCAN_AND) return a & b;
+    else if constexpr (OP == SCAN_OR) return a | b;
+    else return a ^ b;
+}
+
+// --- SSE2 lanes ---
+
+#if GFXL_HAVE_SSE2
+// SSE2 has no 64-bit compares, so 64-bit min and max stay scalar.
+template <typename T, ScanOp OP>
+constexpr bool kVectorized = sizeof(T) == 4 || (OP != SCAN_MIN && OP != SCAN_MAX);
+
+template <typename T>
+__m128i splat(T value) {
+    if constexpr (sizeof(T) == 4) return _mm_set1_epi32(value);
+    else return _mm_set1_epi64x(value);
+}
+
+template <typename T, ScanOp OP>
+__m128i combineLanes(__m128i a, __m128i b) {
+    if constexpr (OP == SCAN_ADD) return sizeof(T) == 4 ? _mm_add_epi32(a, b) : _mm_add_epi64(a, b);
+    else if constexpr (OP == SCAN_MIN || OP == SCAN_MAX) {
+        __m128i greater = _mm_cmpgt_epi32(a, b);
+        if constexpr (OP == SCAN_MIN) return _mm_or_si128(_mm_and_si128(greater, b), _mm_andnot_si128(greater, a));
+        else return _mm_or_si128(_mm_and_si128(greater, a), _mm_andnot_si128(greater, b));
+    }
+    else if constexpr (OP == SCAN_AND) return _mm_and_si128(a, b);
+    else if constexpr (OP == SCAN_OR) return _mm_or_si128(a, b);
+    else return _mm_xor_si128(a, b);
+}
+
+// Moves every lane up by `BYTES`, filling the vacated low lanes with the identity.
+template <int BYTES>
+__m128i shiftUp(__m128i x, __m128i identity) {
+    const __m128i low = _mm_srli_si128(_mm_set1_epi32(-1), 16 - BYTES);
+    return _mm_or_si128(_mm_slli_si128(x, BYTES), _mm_and_si128(identity, low));
+}
+
+// Inclusive scan of the lanes of `x` (log2(lanes) shift-and-combine steps).
+template <typename T, ScanOp OP>
+__m128i scanLanes(__m128i x, __m128i identity) {
+    if constexpr (sizeof(T) == 4) x = combineLanes<T, OP>(x, shiftUp<4>(x, identity));
+    return combineLanes<T, OP>(x, shiftUp<8>(x, identity));
+}
+
+// The top lane copied into every lane.
+template <typename T>
+__m128i broadcastLast(__m128i x) {
+    return _mm_shuffle_epi32(x, sizeof(T) == 4 ? 0xFF : 0xEE);
+}
+
+template <typename T, ScanOp OP>
+T reduceLanes(__m128i x) {
+    alignas(16) T lanes[16 / sizeof(T)];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), x);
+    T acc = lanes[0];
+    for (size_t i = 1; i < 16 / sizeof(T); ++i) acc = combine<T, OP>(acc, lanes[i]);
+    return acc;
+}
+#else
+template <typename T, ScanOp OP>
+constexpr bool kVectorized = false;
+#endif
+
+// --- Block kernels ---
+
+template <typename T, ScanOp OP>
+T reduceBlock(const T* data, size_t n) {
+    size_t i = 0;
+    T acc = identityOf<T, OP>();
+#if GFXL_HAVE_SSE2
+    if constexpr (kVectorized<T, OP>) {
+        // Two accumulators hide the latency of the combine.
+        constexpr size_t kLanes = 16 / sizeof(T);
+        __m128i a = splat<T>(acc), b = a;
+        for (; i + 2 * kLanes <= n; i += 2 * kLanes) {
+            a = combineLanes<T, OP>(a, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+            b = combineLanes<T, OP>(b, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + kLanes)));
+        }
+        acc = reduceLanes<T, OP>(combineLanes<T, OP>(a, b));
+    }
+    else
+#endif
+    {
+        // Independent accumulators let the compiler keep several combines in flight.
+        T acc1 = acc, acc2 = acc, acc3 = acc;
+        for (; i + 4 <= n; i += 4) {
+            acc = combine<T, OP>(acc, data[i]);
+            acc1 = combine<T, OP>(acc1, data[i + 1]);
+            acc2 = combine<T, OP>(acc2, data[i + 2]);
+            acc3 = combine<T, OP>(acc3, data[i + 3]);
+        }
+        acc = combine<T, OP>(combine<T, OP>(acc, acc1), combine<T, OP>(acc2, acc3));
+    }
+    for (; i < n; ++i) acc = combine<T, OP>(acc, data[i]);
+    return acc;
+}
+
+template <typename T, ScanOp OP, bool EXCLUSIVE>
+void scanBlock(const T* in, T* out, size_t n, T carry) {
+    size_t i = 0;
+#if GFXL_HAVE_SSE2
+    if constexpr (kVectorized<T, OP>) {
+        constexpr size_t kLanes = 16 / sizeof(T);
+        const __m128i identity = splat<T>(identityOf<T, OP>());
+        __m128i carried = splat<T>(carry);
+        for (; i + kLanes <= n; i += kLanes) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            x = combineLanes<T, OP>(carried, scanLanes<T, OP>(x, identity));
+            __m128i result = x;
+            // Exclusive results are the inclusive ones one lane up, led by the old carry.
+            if constexpr (EXCLUSIVE) result = shiftUp<sizeof(T)>(x, carried);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), result);
+            carried = broadcastLast<T>(x);
+        }
+        alignas(16) T lanes[kLanes];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), carried);
+        carry = lanes[0];
+    }
+#endif
+    for (; i < n; ++i) {
+        T value = in[i];
+        T next = combine<T, OP>(carry, value);
+        out[i] = EXCLUSIVE ? carry : next;
+        carry = next;
+    }
+}
+
+// Calls `fn.template operator()<OP>()` with `op` as a template argument.
+template <typename Fn>
+auto withOp(ScanOp op, Fn&& fn) {
+    switch (op) {
+    case SCAN_MIN: return fn.template operator()<SCAN_MIN>();
+    case SCAN_MAX: return fn.template operator()<SCAN_MAX>();
+    case SCAN_AND: return fn.template operator()<SCAN_AND>();
+    case SCAN_OR: return fn.template operator()<SCAN_OR>();
+    case SCAN_XOR: return fn.template operator()<SCAN_XOR>();
+    default: return fn.template operator()<SCAN_ADD>();
+    }
+}
+
+template <typename T>
+T reduceBuiltin(const T* data, size_t n, ScanOp op, const ScanOptions& options) {
+    return withOp(op, [&]<ScanOp OP>() {
+        size_t blocks = scanBlockCount(n, options);
+        std::vector<T> totals(blocks);
+        runScanBlocks(blocks, [&](size_t b) {
+            size_t begin = n * b / blocks;
+            totals[b] = reduceBlock<T, OP>(data + begin, n * (b + 1) / blocks - begin);
+        });
+        return reduceBlock<T, OP>(totals.data(), blocks);
+    });
+}
+
+template <typename T, bool EXCLUSIVE>
+void scanBuiltin(const T* in, T* out, size_t n, ScanOp op, const ScanOptions& options) {
+    withOp(op, [&]<ScanOp OP>() {
+        blockedScan(in, out, n, identityOf<T, OP>(), combine<T, OP>, reduceBlock<T, OP>,
+            scanBlock<T, OP, EXCLUSIVE>, options);
+    });
+}
+
+} // namespace
+
+size_t scanBlockCount(size_t n, const ScanOptions& options) {
+    if (n < options.parallelThreshold || n < 2) return 1;
+    size_t threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    // Blocks below half the threshold cost more to start than they save.
+    size_t minBlock = std::max<size_t>(options.parallelThreshold / 2, 1);
+    return std::max<size_t>(1, std::min(threads, n / minBlock));
+}
+
+void runScanBlocks(size_t blocks, const std::function<void(size_t)>& fn) {
+    std::vector<std::thread> threads;
+    threads.reserve(blocks > 0 ? blocks - 1 : 0);
+    for (size_t b = 1; b < blocks; ++b) threads.emplace_back(fn, b);
+    if (blocks > 0) fn(0);
+    for (auto& t : threads) t.join();
+}
+
+int32_t reduce(const int32_t* data, size_t n, ScanOp op, const ScanOptions& options) {
+    return reduceBuiltin(data, n, op, options);
+}
+
+int64_t reduce(const int64_t* data, size_t n, ScanOp op, const ScanOptions& options) {
+    return reduceBuiltin(data, n, op, options);
+}
+
+void inclusiveScan(const int32_t* in, int32_t* out, size_t n, ScanOp op, const ScanOptions& options) {
+    scanBuiltin<int32_t, false>(in, out, n, op, options);
+}
+
+void inclusiveScan(const int64_t* in, int64_t* out, size_t n, ScanOp op, const ScanOptions& options) {
+    scanBuiltin<int64_t, false>(in, out, n, op, options);
+}
+
+void exclusiveScan(const int32_t* in, int32_t* out, size_t n, ScanOp op, const ScanOptions& options) {
+    scanBuiltin<int32_t, true>(in, out, n, op, options);
+}
+
+void exclusiveScan(const int64_t* in, int64_t* out, size_t n, ScanOp op, const ScanOptions& options) {
+    scanBuiltin<int64_t, true>(in, out, n, op, options);
+}
+
+const char* scanOpName(ScanOp op) {
+    switch (op) {
+    case SCAN_ADD: return "+";
+    case SCAN_MIN: return "min";
+    case SCAN_MAX: return "max";
+    case SCAN_AND: return "&";
+    case SCAN_OR: return "|";
+    case SCAN_XOR: return "^";
+    }
+    return "?";
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Reductions and prefix scans over arrays for host code driving GFXL scripts
+// (histogram equalization, stream compaction). The built-in operators run SSE2
+// kernels within a block; generic versions accept any associative `op` with
+// its identity. Inputs of at least `parallelThreshold` elements are split
+// into one block per thread. Scans take two passes over such inputs: every
+// thread reduces its block, the block totals are scanned serially into
+// carries, then every thread scans its block starting from its carry.
+// `in` and `out` may be the same array.
+
+enum ScanOp { SCAN_ADD, SCAN_MIN, SCAN_MAX, SCAN_AND, SCAN_OR, SCAN_XOR };
+
+struct ScanOptions {
+    size_t parallelThreshold = size_t(1) << 18; // Elements; smaller inputs run on the calling thread
+    unsigned threads = 0;                       // 0: std::thread::hardware_concurrency()
+};
+
+int32_t reduce(const int32_t* data, size_t n, ScanOp op, const ScanOptions& options = {});
+int64_t reduce(const int64_t* data, size_t n, ScanOp op, const ScanOptions& options = {});
+
+// out[i] = in[0] op ... op in[i]
+void inclusiveScan(const int32_t* in, int32_t* out, size_t n, ScanOp op, const ScanOptions& options = {});
+void inclusiveScan(const int64_t* in, int64_t* out, size_t n, ScanOp op, const ScanOptions& options = {});
+
+// out[0] = identity, out[i] = in[0] op ... op in[i - 1]
+void exclusiveScan(const int32_t* in, int32_t* out, size_t n, ScanOp op, const ScanOptions& options = {});
+void exclusiveScan(const int64_t* in, int64_t* out, size_t n, ScanOp op, const ScanOptions& options = {});
+
+const char* scanOpName(ScanOp op);
+
+// --- Blocked driver ---
+
+// How many blocks to split `n` elements into: 1 below the threshold.
+size_t scanBlockCount(size_t n, const ScanOptions& options);
+// Calls `fn(b)` for every block, block 0 on the calling thread.
+void runScanBlocks(size_t blocks, const std::function<void(size_t)>& fn);
+
+// Two-pass blocked scan. `reduceBlock(in, count)` returns a block's total and
+// `scanBlock(in, out, count, carry)` scans one block starting from `carry`.
+template <typename T, typename Op, typename ReduceBlock, typename ScanBlock>
+void blockedScan(const T* in, T* out, size_t n, T identity, Op op,
+                 ReduceBlock reduceBlock, ScanBlock scanBlock, const ScanOptions& options) {
+    size_t blocks = scanBlockCount(n, options);
+    auto begin = [&](size_t b) { return n * b / blocks; };
+    if (blocks == 1) {
+        scanBlock(in, out, n, identity);
+        return;
+    }
+    // The last block's total is never needed.
+    std::vector<T> carries(blocks, identity);
+    runScanBlocks(blocks - 1, [&](size_t b) {
+        carries[b + 1] = reduceBlock(in + begin(b), begin(b + 1) - begin(b));
+    });
+    for (size_t b = 1; b < blocks; ++b) {
+        carries[b] = op(carries[b - 1], carries[b]);
+    }
+    runScanBlocks(blocks, [&](size_t b) {
+        scanBlock(in + begin(b), out + begin(b), begin(b + 1) - begin(b), carries[b]);
+    });
+}
+
+// --- Generic operators ---
+
+template <typename T, typename Op>
+T reduce(const T* data, size_t n, T identity, Op op, const ScanOptions& options = {}) {
+    size_t blocks = scanBlockCount(n, options);
+    std::vector<T> totals(blocks, identity);
+    runScanBlocks(blocks, [&](size_t b) {
+        T acc = identity;
+        for (size_t i = n * b / blocks, end = n * (b + 1) / blocks; i < end; ++i) acc = op(acc, data[i]);
+        totals[b] = acc;
+    });
+    T acc = identity;
+    for (const T& total : totals) acc = op(acc, total);
+    return acc;
+}
+
+template <typename T, typename Op>
+void inclusiveScan(const T* in, T* out, size_t n, T identity, Op op, const ScanOptions& options = {}) {
+    blockedScan(in, out, n, identity, op,
+        [&](const T* p, size_t count) {
+            T acc = identity;
+            for (size_t i = 0; i < count; ++i) acc = op(acc, p[i]);
+            return acc;
+        },
+        [&](const T* p, T* q, size_t count, T acc) {
+            for (size_t i = 0; i < count; ++i) q[i] = acc = op(acc, p[i]);
+        },
+        options);
+}
+
+template <typename T, typename Op>
+void exclusiveScan(const T* in, T* out, size_t n, T identity, Op op, const ScanOptions& options = {}) {
+    blockedScan(in, out, n, identity, op,
+        [&](const T* p, size_t count) {
+            T acc = identity;
+            for (size_t i = 0; i < count; ++i) acc = op(acc, p[i]);
+            return acc;
+        },
+        [&](const T* p, T* q, size_t count, T acc) {
+            for (size_t i = 0; i < count; ++i) {
+                T value = p[i];
+                q[i] = acc;
+                acc = op(acc, value);
+            }
+        },
+        options);
+}
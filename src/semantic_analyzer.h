@@ -2,10 +2,13 @@
 
 #include "ast.h"
 #include "symbol_table.h"
+#include "diagnostics.h"
+#include "inline_asm.h"
 #include <vector>
 #include <string>
 #include <iostream>
 #include <map>
+#include <set>
 
 class ASTVisitor {
 public:
@@ -14,12 +17,18 @@ public:
     virtual void visit(ExpressionStatement& node) = 0;
     virtual void visit(AssignmentStatement& node) = 0;
     virtual void visit(PrintStatement& node) = 0;
+    virtual void visit(AsmStatement& node) = 0;
     virtual void visit(BooleanLiteral& node) = 0;
     virtual void visit(StringLiteral& node) = 0;
     virtual void visit(CharLiteral& node) = 0;
     virtual void visit(IdentifierExpr& node) = 0;
     virtual void visit(IntegerLiteral& node) = 0;
     virtual void visit(BinaryExpression& node) = 0;
+    virtual void visit(UnaryExpression& node) = 0;
+    virtual void visit(ConditionalExpression& node) = 0;
+    virtual void visit(MatchExpression& node) = 0;
+    virtual void visit(CallExpression& node) = 0;
+    virtual void visit(MemberAccessExpression& node) = 0;
     virtual void visit(CommentNode& node) = 0;
 };
 
@@ -27,7 +36,7 @@ class SemanticAnalyzer : public ASTVisitor {
 public:
     SemanticAnalyzer() : currentScope(std::make_unique<SymbolTable>()) {}
 
-    const std::vector<std::string>& getErrors() const {
+    const std::vector<Diagnostic>& getErrors() const {
         return errors;
     }
 
@@ -36,6 +45,7 @@ public:
         // No explicit enterScope() here, as constructor already set up the initial scope.
         program.accept(*this);
         // No explicit exitScope() here either, as program analysis finishes in global scope.
+        program.slotCount = nextSlot;
     }
 
     void visit(Program& node) override {
@@ -52,24 +62,23 @@ public:
         SymbolEntry* entry = currentScope->resolve(node.identifier->name);
         if (!entry) {
             if (valueType == ILLEGAL) {
-                addError("Semantic Error: Attempting to define variable '" + node.identifier->name + "' with an unresolved type.");
-                currentScope->define(node.identifier->name, SYM_VAR, ILLEGAL);
-                node.identifier->resolvedType = ILLEGAL;
+                addError({ DIAG_UNRESOLVED_DEFINITION, node.offset, ILLEGAL, ILLEGAL, node.identifier->name });
+                defineVariable(*node.identifier, ILLEGAL);
             }
             else {// <--- HERE!
-                currentScope->define(node.identifier->name, SYM_VAR, valueType); 
-                node.identifier->resolvedType = valueType;
+                defineVariable(*node.identifier, valueType);
             }
         }
         else {
             node.identifier->resolvedType = entry->declaredTokenType;
+            node.identifier->slot = entry->slot;
 
             if (node.identifier->resolvedType != valueType) {
                 if(valueType == ILLEGAL) {
-                    addError("Semantic Warning: Assignment value for '" + node.identifier->name + "' has an unresolved type. Variable type remains " + tokenTypeStrings.at(node.identifier->resolvedType) + ".");
+                    addError({ DIAG_UNRESOLVED_ASSIGNMENT, node.offset, node.identifier->resolvedType, ILLEGAL, node.identifier->name });
                 }
                 else {
-                    addError("Semantic Error: Type mismatch in assignment to '" + node.identifier->name + "'. Expected " + tokenTypeStrings.at(node.identifier->resolvedType) + ", but got " + tokenTypeStrings.at(valueType) + ".");
+                    addError({ DIAG_ASSIGNMENT_MISMATCH, node.offset, node.identifier->resolvedType, valueType, node.identifier->name });
                 }
 
                 node.identifier->resolvedType = ILLEGAL;
@@ -85,7 +94,74 @@ public:
         node.expression->accept(*this);
 
         if (node.expression->resolvedType == ILLEGAL) {
-            addError("Semantic Error: PRINT statement argument has an unresolved or invalid type.");
+            addError({ DIAG_PRINT_UNRESOLVED, node.offset });
+        }
+    }
+
+    // Inputs are checked before outputs define anything, so an input never sees
+    // a variable the block itself introduces.
+    void visit(AsmStatement& node) override {
+        std::set<std::string> fixed;
+        auto checkFixed = [&](const AsmConstraint& c, uint32_t offset, const std::string& text) {
+            if (!c.fixedRegister.empty() && !fixed.insert(c.fixedRegister).second) {
+                addError({ DIAG_ASM_CONSTRAINT, offset, ILLEGAL, ILLEGAL, text });
+            }
+        };
+
+        for (auto& input : node.inputs) {
+            Expression* expr = input.expression.get();
+            expr->accept(*this);
+            AsmConstraint c = parseAsmConstraint(input.constraint, false);
+            bool fits = (c.kind != 'i' || dynamic_cast<IntegerLiteral*>(expr)) &&
+                        (c.kind != 'm' || dynamic_cast<IdentifierExpr*>(expr));
+            if (!c.valid || !fits) {
+                addError({ DIAG_ASM_CONSTRAINT, expr->offset, ILLEGAL, ILLEGAL, input.constraint });
+            }
+            else if (expr->resolvedType != INT && expr->resolvedType != BOOL && expr->resolvedType != ILLEGAL) {
+                addError({ DIAG_ASM_OPERAND_TYPE, expr->offset, expr->resolvedType });
+            }
+            checkFixed(c, expr->offset, input.constraint);
+        }
+
+        for (auto& output : node.outputs) {
+            auto* id = static_cast<IdentifierExpr*>(output.expression.get());
+            AsmConstraint c = parseAsmConstraint(output.constraint, true);
+            if (!c.valid) {
+                addError({ DIAG_ASM_CONSTRAINT, id->offset, ILLEGAL, ILLEGAL, output.constraint });
+            }
+            checkFixed(c, id->offset, output.constraint);
+
+            SymbolEntry* entry = currentScope->resolve(id->name);
+            if (!entry) {
+                if (c.readWrite) {
+                    addError({ DIAG_UNDEFINED_VARIABLE, id->offset, ILLEGAL, ILLEGAL, id->name });
+                }
+                defineVariable(*id, INT);
+            }
+            else {
+                id->resolvedType = entry->declaredTokenType;
+                id->slot = entry->slot;
+                if (id->resolvedType != INT) {
+                    addError({ DIAG_ASM_OPERAND_TYPE, id->offset, id->resolvedType });
+                }
+            }
+        }
+
+        for (const auto& clobber : node.clobbers) {
+            std::string reg = canonicalRegister(clobber);
+            bool ok = clobber == "cc" || clobber == "memory" ||
+                      (!reg.empty() && reg != "rsp" && reg != "rbp" && !fixed.count(reg));
+            if (!ok) {
+                addError({ DIAG_ASM_CLOBBER, node.offset, ILLEGAL, ILLEGAL, clobber });
+            }
+        }
+
+        std::vector<std::string> operands(node.outputs.size() + node.inputs.size(), "rax");
+        for (const auto& line : node.lines) {
+            std::string text, bad;
+            if (!substituteAsmOperands(line, operands, text, bad)) {
+                addError({ DIAG_ASM_OPERAND, node.offset, ILLEGAL, ILLEGAL, bad });
+            }
         }
     }
 
@@ -107,11 +183,12 @@ public:
     void visit(IdentifierExpr& node) override {
         SymbolEntry* entry = currentScope->resolve(node.name);
         if (!entry) {
-            addError("Semantic Error: Undefined variable '" + node.name + "'.");
+            addError({ DIAG_UNDEFINED_VARIABLE, node.offset, ILLEGAL, ILLEGAL, node.name });
             node.resolvedType = ILLEGAL;
         }
         else {
             node.resolvedType = entry->declaredTokenType;
+            node.slot = entry->slot;
         }
     }
 
@@ -123,54 +200,191 @@ public:
         node.left->accept(*this);
         node.right->accept(*this);
 
-        TokenType leftType = ILLEGAL;
-        if (auto* id_expr = dynamic_cast<IdentifierExpr*>(node.left.get())) {
-            leftType = id_expr->resolvedType;
+        TokenType leftType = node.left->resolvedType;
+        TokenType rightType = node.right->resolvedType;
+        node.resolvedType = ILLEGAL;
+
+        if (leftType == ILLEGAL || rightType == ILLEGAL) {
+            return;
         }
-        else if (auto* int_lit = dynamic_cast<IntegerLiteral*>(node.left.get())) {
-            leftType = INT;
+
+        switch (node.op) {
+        case PLUS: case MINUS: case ASTERISK: case SLASH: case PERCENT:
+            if (leftType != INT || rightType != INT) {
+                addError({ DIAG_ARITHMETIC_OPERANDS, node.offset, node.op });
+                return;
+            }
+            node.resolvedType = INT;
+            break;
+        case LT: case GT: case LT_EQ: case GT_EQ:
+            if (leftType != INT || rightType != INT) {
+                addError({ DIAG_RELATIONAL_OPERANDS, node.offset, node.op });
+                return;
+            }
+            node.resolvedType = BOOL;
+            break;
+        case EQ: case NOT_EQ:
+            if (leftType != rightType) {
+                addError({ DIAG_EQUALITY_OPERANDS, node.offset, leftType, rightType, tokenTypeName(node.op) });
+                return;
+            }
+            node.resolvedType = BOOL;
+            break;
+        case AND: case OR:
+            if (leftType != BOOL || rightType != BOOL) {
+                addError({ DIAG_LOGICAL_OPERANDS, node.offset, node.op });
+                return;
+            }
+            node.resolvedType = BOOL;
+            break;
+        default:
+            addError({ DIAG_UNSUPPORTED_BINARY, node.offset, node.op });
+            return;
         }
-        else if (auto* bin_expr = dynamic_cast<BinaryExpression*>(node.left.get())) {
-            leftType = bin_expr->resolvedType;
+
+        if (node.op == SLASH || node.op == PERCENT) {
+            if (auto* int_lit = dynamic_cast<IntegerLiteral*>(node.right.get())) {
+                if (int_lit->value == 0) {
+                    addError({ DIAG_DIVISION_BY_ZERO, node.offset });
+                    node.resolvedType = ILLEGAL;
+                }
+            }
         }
+    }
+
+    void visit(UnaryExpression& node) override {
+        node.operand->accept(*this);
+        TokenType operandType = node.operand->resolvedType;
+        node.resolvedType = ILLEGAL;
 
-        TokenType rightType = ILLEGAL;
-        if (auto* id_expr = dynamic_cast<IdentifierExpr*>(node.right.get())) {
-            rightType = id_expr->resolvedType;
+        if (operandType == ILLEGAL) {
+            return;
         }
-        else if (auto* int_lit = dynamic_cast<IntegerLiteral*>(node.right.get())) {
-            rightType = INT;
+
+        switch (node.op) {
+        case MINUS: case PLUS:
+            if (operandType != INT) {
+                addError({ DIAG_UNARY_INT_OPERAND, node.offset, node.op });
+                return;
+            }
+            node.resolvedType = INT;
+            break;
+        case BANG:
+            if (operandType != BOOL) {
+                addError({ DIAG_UNARY_BOOL_OPERAND, node.offset });
+                return;
+            }
+            node.resolvedType = BOOL;
+            break;
+        case ASTERISK:
+            addError({ DIAG_DEREF_NON_POINTER, node.offset, operandType });
+            break;
+        default:
+            addError({ DIAG_UNSUPPORTED_UNARY, node.offset, node.op });
+            break;
         }
-        else if (auto* bin_expr = dynamic_cast<BinaryExpression*>(node.right.get())) {
-            rightType = bin_expr->resolvedType;
+    }
+
+    void visit(ConditionalExpression& node) override {
+        node.condition->accept(*this);
+        node.thenExpr->accept(*this);
+        node.elseExpr->accept(*this);
+        node.resolvedType = ILLEGAL;
+
+        TokenType condType = node.condition->resolvedType;
+        TokenType thenType = node.thenExpr->resolvedType;
+        TokenType elseType = node.elseExpr->resolvedType;
+        if (condType == ILLEGAL || thenType == ILLEGAL || elseType == ILLEGAL) {
+            return;
         }
 
-        if (leftType == ILLEGAL || rightType == ILLEGAL) {
-            node.resolvedType = ILLEGAL;
+        if (condType != BOOL) {
+            addError({ DIAG_CONDITION_NOT_BOOL, node.offset, condType });
         }
-        else if (leftType != INT || rightType != INT) {
-            addError("Semantic Error: Arithmetic operator '" + tokenTypeStrings.at(node.op) + "' expects integer operands.");
-            node.resolvedType = ILLEGAL;
+        else if (thenType != elseType) {
+            addError({ DIAG_BRANCH_MISMATCH, node.offset, thenType, elseType });
         }
         else {
-            node.resolvedType = INT;
+            node.resolvedType = thenType;
         }
+    }
 
-        if (node.op == SLASH) {
-            if (auto* int_lit = dynamic_cast<IntegerLiteral*>(node.right.get())) {
-                if (int_lit->value == 0) {
-                    addError("Semantic Error: Division by zero detected.");
-                    node.resolvedType = ILLEGAL;
+    void visit(MatchExpression& node) override {
+        node.subject->accept(*this);
+        for (auto& arm : node.arms) {
+            arm.value->accept(*this);
+        }
+        node.resolvedType = ILLEGAL;
+
+        TokenType subjectType = node.subject->resolvedType;
+        bool ok = subjectType == INT;
+        if (subjectType != ILLEGAL && subjectType != INT) {
+            addError({ DIAG_MATCH_SUBJECT, node.offset, subjectType });
+        }
+
+        TokenType armType = ILLEGAL;
+        for (size_t i = 0; i < node.arms.size(); ++i) {
+            const MatchArm& arm = node.arms[i];
+            if (arm.ranges.empty() != (i + 1 == node.arms.size())) {
+                addError({ DIAG_MATCH_DEFAULT, arm.offset });
+                ok = false;
+            }
+            for (const auto& [lo, hi] : arm.ranges) {
+                if (lo > hi) {
+                    addError({ DIAG_MATCH_RANGE, arm.offset, ILLEGAL, ILLEGAL, std::to_string(lo) + ".." + std::to_string(hi) });
+                    ok = false;
                 }
             }
+            TokenType type = arm.value->resolvedType;
+            if (type == ILLEGAL) {
+                ok = false;
+            }
+            else if (armType == ILLEGAL) {
+                armType = type;
+            }
+            else if (type != armType) {
+                addError({ DIAG_MATCH_ARM_TYPE, arm.offset, armType, type });
+                ok = false;
+            }
+        }
+        if (node.arms.empty()) {
+            addError({ DIAG_MATCH_DEFAULT, node.offset });
+            ok = false;
+        }
+        if (ok) {
+            node.resolvedType = armType;
         }
     }
+
+    void visit(CallExpression& node) override {
+        for (const auto& arg : node.arguments) {
+            arg->accept(*this);
+        }
+        // The language has no function definitions yet, so no callee can resolve.
+        addError({ DIAG_UNDEFINED_FUNCTION, node.offset, ILLEGAL, ILLEGAL, node.callee });
+        node.resolvedType = ILLEGAL;
+    }
+
+    void visit(MemberAccessExpression& node) override {
+        node.object->accept(*this);
+        if (node.object->resolvedType != ILLEGAL) {
+            addError({ DIAG_MEMBER_ACCESS, node.offset, node.object->resolvedType, ILLEGAL, node.member });
+        }
+        node.resolvedType = ILLEGAL;
+    }
 private:
     std::unique_ptr<SymbolTable> currentScope;
-    std::vector<std::string> errors;
+    std::vector<Diagnostic> errors;
+    uint32_t nextSlot = 0; // Slots number variables densely so later phases index arrays instead of looking up names
+
+    void addError(Diagnostic diag) {
+        errors.push_back(std::move(diag));
+    }
 
-    void addError(const std::string& msg) {
-        errors.push_back(msg);
+    void defineVariable(IdentifierExpr& id, TokenType type) {
+        currentScope->define(id.name, SYM_VAR, type, nextSlot);
+        id.resolvedType = type;
+        id.slot = nextSlot++;
     }
 
     void enterScope() {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Token.h"	
+#include <cstdint>
 #include <string>
 #include <map>
 #include <memory>
@@ -14,8 +15,9 @@ struct SymbolEntry {
 	std::string name;
 	SymbolType type;
 	TokenType declaredTokenType;
+	uint32_t slot; // Dense index across every scope, in definition order
 
-	SymbolEntry(std::string n, SymbolType st, TokenType tt) : name(std::move(n)), type(std::move(st)), declaredTokenType(std::move(tt))	{}
+	SymbolEntry(std::string n, SymbolType st, TokenType tt, uint32_t s) : name(std::move(n)), type(std::move(st)), declaredTokenType(std::move(tt)), slot(s)	{}
 };
 
 class SymbolTable {
@@ -23,12 +25,12 @@ public:
 	SymbolTable() : outer(nullptr) {}
 	SymbolTable(std::unique_ptr<SymbolTable> o) : outer(std::move(o)) {}
 
-	bool define(const std::string& name, SymbolType symType, TokenType declaredType) {
+	bool define(const std::string& name, SymbolType symType, TokenType declaredType, uint32_t slot) {
 		if (store.count(name)) {
 			return false;
 		}
 		 
-		store.emplace(name, SymbolEntry(name, symType, declaredType));
+		store.emplace(name, SymbolEntry(name, symType, declaredType, slot));
 		return true;
 	}
 
@@ -0,0 +1,113 @@
+// tiered.cpp
+#include "tiered.h"
+
+#include "compiler.h"
+
+TieredRuntime::TieredRuntime(const RuntimeHooks& hooks, const TieredOptions& options)
+    : hooks_(hooks), options_(options) {
+    jit_.defineSymbol("print_int", reinterpret_cast<const void*>(hooks_.printInt));
+    jit_.defineSymbol("print_bool", reinterpret_cast<const void*>(hooks_.printBool));
+    if (options_.background) {
+        worker_ = std::thread([this] { workerLoop(); });
+    }
+}
+
+TieredRuntime::~TieredRuntime() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        stopping_ = true;
+    }
+    queueChanged_.notify_all();
+    if (worker_.joinable()) worker_.join();
+}
+
+bool TieredRuntime::load(const std::string& name, std::string_view source) {
+    CompileOptions options;
+    options.output = OUTPUT_AST;
+    CompileResult result = compileSource(source, options);
+    errors_ = std::move(result.diagnostics);
+    if (!result.ok) return false;
+
+    auto script = std::make_shared<Script>();
+    script->source = std::string(source);
+    BytecodeCompiler compiler;
+    if (!compiler.compile(result.ast.get(), script->chunk)) {
+        errors_.insert(errors_.end(), compiler.getErrors().begin(), compiler.getErrors().end());
+        return false;
+    }
+
+    // Reloading starts the new version back in the interpreter.
+    std::lock_guard<std::mutex> lock(scriptsMutex_);
+    scripts_[name] = std::move(script);
+    return true;
+}
+
+std::shared_ptr<TieredRuntime::Script> TieredRuntime::find(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(scriptsMutex_);
+    auto it = scripts_.find(name);
+    return it == scripts_.end() ? nullptr : it->second;
+}
+
+bool TieredRuntime::invoke(const std::string& name, EpochReclaimer::Participant* participant) {
+    std::shared_ptr<Script> script = find(name);
+    if (!script) return false;
+
+    if (script->native.load(std::memory_order_acquire)) {
+        return jit_.run(name, participant) == 0;
+    }
+
+    uint32_t count = script->invocations.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (count >= options_.compileThreshold && !script->queued.exchange(true)) {
+        if (options_.background) {
+            {
+                std::lock_guard<std::mutex> lock(queueMutex_);
+                queue_.emplace_back(name, script);
+            }
+            queueChanged_.notify_one();
+        }
+        else {
+            compileNative(name, *script);
+        }
+    }
+    return interpret(script->chunk, hooks_) == INTERPRET_OK;
+}
+
+void TieredRuntime::compileNative(const std::string& name, Script& script) {
+    // A reload may have replaced this script while it was queued; don't install stale code.
+    if (find(name).get() != &script) return;
+    if (jit_.load(name, script.source)) {
+        script.native.store(true, std::memory_order_release);
+    }
+}
+
+void TieredRuntime::workerLoop() {
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    for (;;) {
+        queueChanged_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (stopping_) return;
+        auto [name, script] = std::move(queue_.front());
+        queue_.pop_front();
+        ++inFlight_;
+        lock.unlock();
+        compileNative(name, *script);
+        jit_.reclaim();
+        lock.lock();
+        --inFlight_;
+        queueChanged_.notify_all();
+    }
+}
+
+void TieredRuntime::waitForCompiles() {
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    queueChanged_.wait(lock, [this] { return stopping_ || (queue_.empty() && inFlight_ == 0); });
+}
+
+TieredRuntime::Tier TieredRuntime::tierOf(const std::string& name) const {
+    std::shared_ptr<Script> script = find(name);
+    return script && script->native.load() ? TIER_NATIVE : TIER_INTERPRETER;
+}
+
+uint32_t TieredRuntime::invocationCount(const std::string& name) const {
+    std::shared_ptr<Script> script = find(name);
+    return script ? script->invocations.load() : 0;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "bytecode.h"
+#include "diagnostics.h"
+#include "jit.h"
+
+struct TieredOptions {
+    uint32_t compileThreshold = 2; // Interpreted invocations before native compilation is queued
+    bool background = true;        // Compile on the worker thread; false compiles inline (deterministic)
+};
+
+// Runs scripts in the bytecode interpreter until they are hot, then in native
+// code. Loading only parses, checks and lowers to bytecode, so the first
+// invocation starts immediately; the native backend compiles hot scripts on a
+// background thread and the next invocation after it finishes runs natively.
+class TieredRuntime {
+public:
+    enum Tier { TIER_INTERPRETER, TIER_NATIVE };
+
+    TieredRuntime(const RuntimeHooks& hooks, const TieredOptions& options = {});
+    ~TieredRuntime();
+    TieredRuntime(const TieredRuntime&) = delete;
+    TieredRuntime& operator=(const TieredRuntime&) = delete;
+
+    bool load(const std::string& name, std::string_view source);
+    const std::vector<Diagnostic>& getErrors() const { return errors_; }
+
+    // `participant` is the calling thread's registration with epochs().
+    bool invoke(const std::string& name, EpochReclaimer::Participant* participant);
+
+    Tier tierOf(const std::string& name) const;
+    uint32_t invocationCount(const std::string& name) const;
+    EpochReclaimer& epochs() { return jit_.epochs(); }
+
+    // Blocks until every queued native compile has finished.
+    void waitForCompiles();
+
+private:
+    struct Script {
+        std::string source;
+        Chunk chunk;
+        std::atomic<uint32_t> invocations{ 0 };
+        std::atomic<bool> queued{ false };
+        std::atomic<bool> native{ false };
+    };
+
+    RuntimeHooks hooks_;
+    TieredOptions options_;
+    JitEngine jit_;
+    std::vector<Diagnostic> errors_;
+
+    mutable std::mutex scriptsMutex_;
+    std::map<std::string, std::shared_ptr<Script>> scripts_;
+
+    // Background compilation
+    std::mutex queueMutex_;
+    std::condition_variable queueChanged_;
+    std::deque<std::pair<std::string, std::shared_ptr<Script>>> queue_;
+    size_t inFlight_ = 0;
+    bool stopping_ = false;
+    std::thread worker_;
+
+    std::shared_ptr<Script> find(const std::string& name) const;
+    void compileNative(const std::string& name, Script& script);
+    void workerLoop();
+};
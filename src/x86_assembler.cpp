@@ -0,0 +1,691 @@
+// x86_assembler.cpp
+#include "x86_assembler.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <map>
+#include <set>
+
+const CodeSymbol* MachineCode::findSymbol(std::string_view name) const {
+    for (const auto& sym : symbols) {
+        if (sym.name == name) return &sym;
+    }
+    return nullptr;
+}
+
+namespace {
+
+// --- Operands ---
+
+enum OperandKind { OPND_NONE, OPND_REG, OPND_IMM, OPND_MEM, OPND_NAME };
+
+struct Operand {
+    OperandKind kind = OPND_NONE;
+    int reg = -1;       // OPND_REG: register number; OPND_MEM: base register
+    int size = 0;       // Operand size in bytes; 0 when it must be inferred
+    int64_t imm = 0;    // OPND_IMM: value; OPND_MEM: displacement
+    int index = -1;     // OPND_MEM: index register, -1 if none
+    int scale = 1;      // OPND_MEM: 1, 2, 4 or 8
+    bool rip = false;   // OPND_MEM: [rip + name], RIP-relative to `name`
+    std::string name;   // OPND_NAME: label or external symbol; OPND_MEM: the RIP-relative target
+};
+
+struct RegInfo {
+    int number;
+    int size;
+};
+
+const std::map<std::string_view, RegInfo> kRegisters = {
+    {"rax", {0, 8}}, {"rcx", {1, 8}}, {"rdx", {2, 8}}, {"rbx", {3, 8}},
+    {"rsp", {4, 8}}, {"rbp", {5, 8}}, {"rsi", {6, 8}}, {"rdi", {7, 8}},
+    {"r8", {8, 8}}, {"r9", {9, 8}}, {"r10", {10, 8}}, {"r11", {11, 8}},
+    {"r12", {12, 8}}, {"r13", {13, 8}}, {"r14", {14, 8}}, {"r15", {15, 8}},
+    {"eax", {0, 4}}, {"ecx", {1, 4}}, {"edx", {2, 4}}, {"ebx", {3, 4}},
+    {"esp", {4, 4}}, {"ebp", {5, 4}}, {"esi", {6, 4}}, {"edi", {7, 4}},
+    {"r8d", {8, 4}}, {"r9d", {9, 4}}, {"r10d", {10, 4}}, {"r11d", {11, 4}},
+    {"r12d", {12, 4}}, {"r13d", {13, 4}}, {"r14d", {14, 4}}, {"r15d", {15, 4}},
+    {"al", {0, 1}}, {"cl", {1, 1}}, {"dl", {2, 1}}, {"bl", {3, 1}},
+    {"spl", {4, 1}}, {"bpl", {5, 1}}, {"sil", {6, 1}}, {"dil", {7, 1}},
+    {"r8b", {8, 1}}, {"r9b", {9, 1}}, {"r10b", {10, 1}}, {"r11b", {11, 1}},
+    {"r12b", {12, 1}}, {"r13b", {13, 1}}, {"r14b", {14, 1}}, {"r15b", {15, 1}},
+};
+
+const std::map<std::string_view, int> kConditions = {
+    {"o", 0}, {"no", 1}, {"b", 2}, {"c", 2}, {"nae", 2}, {"ae", 3}, {"nb", 3}, {"nc", 3},
+    {"e", 4}, {"z", 4}, {"ne", 5}, {"nz", 5}, {"be", 6}, {"na", 6}, {"a", 7}, {"nbe", 7},
+    {"s", 8}, {"ns", 9}, {"p", 10}, {"np", 11}, {"l", 12}, {"nge", 12}, {"ge", 13}, {"nl", 13},
+    {"le", 14}, {"ng", 14}, {"g", 15}, {"nle", 15},
+};
+
+// Integer ALU ops sharing the classic encoding layout: op r/m,r | op r,r/m | 83/81 /ext.
+struct AluOp {
+    uint8_t rmReg;  // op r/m, r  (8-bit form is rmReg - 1)
+    uint8_t regRm;  // op r, r/m  (8-bit form is regRm - 1)
+    uint8_t ext;    // ModRM.reg for the immediate forms
+};
+
+const std::map<std::string_view, AluOp> kAluOps = {
+    {"add", {0x01, 0x03, 0}}, {"or", {0x09, 0x0B, 1}}, {"and", {0x21, 0x23, 4}},
+    {"sub", {0x29, 0x2B, 5}}, {"xor", {0x31, 0x33, 6}}, {"cmp", {0x39, 0x3B, 7}},
+};
+
+// Single-operand F7 group: op r/m
+const std::map<std::string_view, uint8_t> kUnaryOps = {
+    {"not", 2}, {"neg", 3}, {"mul", 4}, {"imul", 5}, {"div", 6}, {"idiv", 7},
+};
+
+const std::map<std::string_view, uint8_t> kShiftOps = {
+    {"shl", 4}, {"sal", 4}, {"shr", 5}, {"sar", 7},
+};
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) s.remove_prefix(1);
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) s.remove_suffix(1);
+    return s;
+}
+
+bool parseInteger(std::string_view s, int64_t& out) {
+    s = trim(s);
+    if (s.empty()) return false;
+    std::string text(s);
+    char* end = nullptr;
+    out = static_cast<int64_t>(std::strtoll(text.c_str(), &end, 0));
+    return end && *end == '\0';
+}
+
+bool fitsInt8(int64_t v) { return v >= -128 && v <= 127; }
+bool fitsInt32(int64_t v) { return v >= INT32_MIN && v <= INT32_MAX; }
+
+// --- Encoder ---
+
+struct Fixup {
+    uint32_t offset;      // rel32 field, the last bytes of the instruction
+    std::string label;
+    size_t line;
+    uint32_t start;       // First byte of the instruction
+    uint8_t shortOpcode;  // rel8 form (jmp/jcc), 0 if the instruction has none (call)
+};
+
+// `.long a - b` between two local labels, filled in once the layout is final.
+struct LabelDifference {
+    uint32_t offset;
+    std::string plus;
+    std::string minus;
+    size_t line;
+};
+
+class Encoder {
+public:
+    explicit Encoder(MachineCode& out) : out_(out) {}
+
+    std::vector<uint8_t>& bytes() { return out_.bytes; }
+
+    void byte(uint8_t b) { out_.bytes.push_back(b); }
+
+    void imm(int64_t v, int size) {
+        for (int i = 0; i < size; ++i) byte(static_cast<uint8_t>((static_cast<uint64_t>(v) >> (8 * i)) & 0xFF));
+    }
+
+    // REX prefix. `forceByteRex` is needed to address spl/bpl/sil/dil instead of ah/ch/dh/bh.
+    void rex(bool w, int reg, int base, bool forceByteRex, int index = -1) {
+        uint8_t r = 0x40;
+        if (w) r |= 0x08;
+        if (reg >= 8) r |= 0x04;
+        if (index >= 8) r |= 0x02;
+        if (base >= 8) r |= 0x01;
+        if (r != 0x40 || forceByteRex) byte(r);
+    }
+
+    void modrm(int regField, const Operand& rm) {
+        if (rm.kind == OPND_REG) {
+            byte(static_cast<uint8_t>(0xC0 | ((regField & 7) << 3) | (rm.reg & 7)));
+            return;
+        }
+        int base = rm.reg & 7;
+        int64_t disp = rm.imm;
+        int mod = (disp == 0 && base != 5) ? 0 : (fitsInt8(disp) ? 1 : 2);
+        bool sib = base == 4 || rm.index >= 0; // rsp/r12 as base always need one
+        byte(static_cast<uint8_t>((mod << 6) | ((regField & 7) << 3) | (sib ? 4 : base)));
+        if (sib) {
+            int scaleBits = rm.scale == 8 ? 3 : rm.scale == 4 ? 2 : rm.scale == 2 ? 1 : 0;
+            int index = rm.index >= 0 ? (rm.index & 7) : 4; // 4: no index
+            byte(static_cast<uint8_t>((scaleBits << 6) | (index << 3) | base));
+        }
+        if (mod == 1) imm(disp, 1);
+        if (mod == 2) imm(disp, 4);
+    }
+
+    // Emits [REX] opcode ModRM for an instruction with a register field and an r/m operand.
+    void rmInstruction(std::initializer_list<uint8_t> opcode, int size, int regField, const Operand& rm, bool regIsByteReg) {
+        bool forceRex = size == 1 && ((regIsByteReg && regField >= 4 && regField < 8) ||
+            (rm.kind == OPND_REG && rm.reg >= 4 && rm.reg < 8));
+        rex(size == 8, regField, rm.reg < 0 ? 0 : rm.reg, forceRex, rm.kind == OPND_MEM ? rm.index : -1);
+        for (uint8_t b : opcode) byte(b);
+        modrm(regField, rm);
+    }
+
+private:
+    MachineCode& out_;
+};
+
+bool isByteReg(const Operand& op) {
+    return op.kind == OPND_REG && op.size == 1;
+}
+
+// --- Branch relaxation ---
+
+// Rewrites local jmp/jcc whose target is within rel8 range to the 2-byte form,
+// as GNU as does. Every candidate starts short; any that does not fit is made
+// long and the layout recomputed until nothing changes (lengthening is
+// monotonic, so this terminates). Short branches are encoded here and removed
+// from `fixups`; the rest get their field offsets and labels remapped.
+void relaxBranches(std::vector<uint8_t>& bytes, std::vector<Fixup>& fixups, std::map<std::string, uint32_t>& labels,
+                   std::vector<LabelDifference>& differences) {
+    size_t n = fixups.size();
+    std::vector<bool> isShort(n);
+    std::vector<uint32_t> starts(n);
+    for (size_t i = 0; i < n; ++i) {
+        isShort[i] = fixups[i].shortOpcode != 0 && labels.count(fixups[i].label);
+        starts[i] = fixups[i].start;
+    }
+
+    std::vector<uint32_t> savedBefore(n + 1); // bytes saved by fixups [0, i)
+    auto newOffset = [&](uint32_t old) {
+        size_t k = static_cast<size_t>(std::lower_bound(starts.begin(), starts.end(), old) - starts.begin());
+        return old - savedBefore[k];
+    };
+    auto layout = [&] {
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t saving = isShort[i] ? fixups[i].offset + 4 - fixups[i].start - 2 : 0;
+            savedBefore[i + 1] = savedBefore[i] + saving;
+        }
+    };
+
+    for (bool changed = true; changed;) {
+        changed = false;
+        layout();
+        for (size_t i = 0; i < n; ++i) {
+            if (!isShort[i]) continue;
+            int64_t disp = static_cast<int64_t>(newOffset(labels.at(fixups[i].label))) - (newOffset(fixups[i].start) + 2);
+            if (!fitsInt8(disp)) {
+                isShort[i] = false;
+                changed = true;
+            }
+        }
+    }
+    if (savedBefore[n] == 0) return;
+
+    std::vector<uint8_t> relaxed;
+    relaxed.reserve(bytes.size() - savedBefore[n]);
+    std::vector<Fixup> remaining;
+    uint32_t cursor = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const Fixup& fix = fixups[i];
+        relaxed.insert(relaxed.end(), bytes.begin() + cursor, bytes.begin() + fix.start);
+        if (isShort[i]) {
+            int64_t disp = static_cast<int64_t>(newOffset(labels.at(fix.label))) - (newOffset(fix.start) + 2);
+            relaxed.push_back(fix.shortOpcode);
+            relaxed.push_back(static_cast<uint8_t>(disp));
+        }
+        else {
+            relaxed.insert(relaxed.end(), bytes.begin() + fix.start, bytes.begin() + fix.offset + 4);
+            Fixup moved = fix;
+            moved.offset = newOffset(fix.start) + (fix.offset - fix.start);
+            moved.start = newOffset(fix.start);
+            remaining.push_back(std::move(moved));
+        }
+        cursor = fix.offset + 4;
+    }
+    relaxed.insert(relaxed.end(), bytes.begin() + cursor, bytes.end());
+
+    for (auto& [name, offset] : labels) offset = newOffset(offset);
+    for (auto& difference : differences) difference.offset = newOffset(difference.offset);
+    bytes = std::move(relaxed);
+    fixups = std::move(remaining);
+}
+
+} // namespace
+
+bool X86Assembler::assemble(std::string_view text, MachineCode& out) {
+    errors_.clear();
+    out = MachineCode{};
+    Encoder enc(out);
+
+    std::map<std::string, uint32_t> labels;
+    std::set<std::string> globals;
+    std::vector<Fixup> fixups;
+    std::vector<LabelDifference> differences;
+    size_t lineNo = 0;
+
+    auto fail = [&](const std::string& msg) {
+        errors_.push_back("Assembler error: line " + std::to_string(lineNo) + ": " + msg);
+    };
+
+    auto parseOperand = [&](std::string_view s, Operand& op) -> bool {
+        s = trim(s);
+        int size = 0;
+        static const std::pair<std::string_view, int> kPtr[] = {
+            {"byte ptr", 1}, {"word ptr", 2}, {"dword ptr", 4}, {"qword ptr", 8},
+        };
+        for (const auto& [prefix, bytes] : kPtr) {
+            if (s.substr(0, prefix.size()) == prefix) {
+                size = bytes;
+                s = trim(s.substr(prefix.size()));
+                break;
+            }
+        }
+
+        if (!s.empty() && s.front() == '[') {
+            if (s.back() != ']') return false;
+            // [base + index*scale + disp]; terms in any order, the displacement may be negative.
+            std::string_view inner = trim(s.substr(1, s.size() - 2));
+            op.kind = OPND_MEM;
+            op.reg = -1;
+            op.size = size;
+            op.imm = 0;
+            bool negative = false;
+            while (!inner.empty()) {
+                size_t split = inner.find_first_of("+-", 1);
+                std::string_view term = trim(inner.substr(0, split));
+                if (!term.empty() && (term.front() == '+' || term.front() == '-')) {
+                    negative = term.front() == '-';
+                    term = trim(term.substr(1));
+                }
+                inner = split == std::string_view::npos ? std::string_view() : inner.substr(split);
+
+                size_t star = term.find('*');
+                auto it = kRegisters.find(trim(term.substr(0, star)));
+                int64_t value = 0;
+                if (term == "rip" && !negative && !op.rip) {
+                    op.rip = true;
+                }
+                else if (it != kRegisters.end()) {
+                    if (negative || it->second.size != 8) return false;
+                    int64_t scale = 1;
+                    if (star != std::string_view::npos &&
+                        (!parseInteger(term.substr(star + 1), scale) || (scale != 1 && scale != 2 && scale != 4 && scale != 8))) {
+                        return false;
+                    }
+                    if (star == std::string_view::npos && op.reg < 0) {
+                        op.reg = it->second.number;
+                    }
+                    else if (op.index < 0 && it->second.number != 4) {
+                        op.index = it->second.number;
+                        op.scale = static_cast<int>(scale);
+                    }
+                    else {
+                        return false;
+                    }
+                }
+                else if (parseInteger(term, value)) {
+                    op.imm += negative ? -value : value;
+                }
+                else if (!negative && op.name.empty() && !term.empty() && !std::isdigit(static_cast<unsigned char>(term.front()))) {
+                    op.name = std::string(term);
+                }
+                else {
+                    return false;
+                }
+                negative = false;
+            }
+            if (op.rip || !op.name.empty()) {
+                // Only [rip + label]: the displacement is the label's distance from the next instruction.
+                return op.rip && !op.name.empty() && op.reg < 0 && op.index < 0 && op.imm == 0;
+            }
+            if (op.reg < 0 || !fitsInt32(op.imm)) return false; // No absolute forms
+            return true;
+        }
+        if (size != 0) return false;
+
+        auto it = kRegisters.find(s);
+        if (it != kRegisters.end()) {
+            op.kind = OPND_REG;
+            op.reg = it->second.number;
+            op.size = it->second.size;
+            return true;
+        }
+        int64_t value = 0;
+        if (!s.empty() && (std::isdigit(static_cast<unsigned char>(s.front())) || s.front() == '-') && parseInteger(s, value)) {
+            op.kind = OPND_IMM;
+            op.imm = value;
+            return true;
+        }
+        if (!s.empty()) {
+            op.kind = OPND_NAME;
+            op.name = std::string(s);
+            return true;
+        }
+        return false;
+    };
+
+    // rel32 branch to a label (resolved later) or an external symbol (relocation).
+    auto branchTarget = [&](const Operand& target, uint32_t start, uint8_t shortOpcode) {
+        uint32_t field = static_cast<uint32_t>(enc.bytes().size());
+        enc.imm(0, 4);
+        fixups.push_back({ field, target.name, lineNo, start, shortOpcode });
+    };
+
+    size_t pos = 0;
+    while (pos <= text.size()) {
+        size_t eol = text.find('\n', pos);
+        if (eol == std::string_view::npos) eol = text.size();
+        std::string_view line = text.substr(pos, eol - pos);
+        pos = eol + 1;
+        ++lineNo;
+
+        size_t hash = line.find('#');
+        if (hash != std::string_view::npos) line = line.substr(0, hash);
+        line = trim(line);
+        if (line.empty()) continue;
+
+        // Label definition
+        if (line.back() == ':') {
+            std::string name(trim(line.substr(0, line.size() - 1)));
+            if (labels.count(name)) {
+                fail("label '" + name + "' defined twice");
+                continue;
+            }
+            labels[name] = static_cast<uint32_t>(enc.bytes().size());
+            continue;
+        }
+
+        size_t space = line.find_first_of(" \t");
+        std::string mnemonic(line.substr(0, space));
+        std::string_view rest = space == std::string_view::npos ? std::string_view{} : trim(line.substr(space));
+
+        // Directives
+        if (mnemonic[0] == '.') {
+            if (mnemonic == ".globl" || mnemonic == ".global") {
+                globals.insert(std::string(rest));
+            }
+            else if (mnemonic == ".section" && rest.substr(0, 15) == ".note.GNU-stack") {
+                // Marks the stack non-executable for the linker; nothing to encode.
+            }
+            else if (mnemonic == ".long") {
+                // An integer, or the distance between two labels (match jump table entries)
+                int64_t value = 0;
+                size_t minus = rest.find(" - ");
+                if (parseInteger(rest, value) && value >= INT32_MIN && value <= UINT32_MAX) {
+                    enc.imm(value, 4);
+                }
+                else if (minus != std::string_view::npos) {
+                    differences.push_back({ static_cast<uint32_t>(enc.bytes().size()),
+                        std::string(trim(rest.substr(0, minus))), std::string(trim(rest.substr(minus + 3))), lineNo });
+                    enc.imm(0, 4);
+                }
+                else {
+                    fail("unsupported operand of .long: '" + std::string(rest) + "'");
+                }
+            }
+            else if (mnemonic != ".intel_syntax" && mnemonic != ".text") {
+                fail("unsupported directive '" + mnemonic + "'");
+            }
+            continue;
+        }
+
+        // Operands
+        std::vector<Operand> ops;
+        bool operandsOk = true;
+        while (!rest.empty()) {
+            size_t comma = rest.find(',');
+            Operand op;
+            if (!parseOperand(rest.substr(0, comma), op)) {
+                operandsOk = false;
+                break;
+            }
+            ops.push_back(op);
+            rest = comma == std::string_view::npos ? std::string_view{} : rest.substr(comma + 1);
+        }
+        if (!operandsOk) {
+            fail("bad operand in '" + std::string(line) + "'");
+            continue;
+        }
+
+        // Infer missing operand sizes from the other operand.
+        if (ops.size() == 2) {
+            if (ops[0].size == 0 && ops[1].kind == OPND_REG) ops[0].size = ops[1].size;
+            if (ops[1].size == 0 && ops[0].kind == OPND_REG && ops[1].kind == OPND_MEM) ops[1].size = ops[0].size;
+        }
+        auto kinds = [&](OperandKind a, OperandKind b = OPND_NONE) {
+            return ops.size() == (b == OPND_NONE ? 1u : 2u) && ops[0].kind == a && (b == OPND_NONE || ops[1].kind == b);
+        };
+        auto isRm = [](const Operand& op) { return op.kind == OPND_REG || op.kind == OPND_MEM; };
+
+        if (std::any_of(ops.begin(), ops.end(), [](const Operand& op) { return op.rip; }) && mnemonic != "lea") {
+            fail("RIP-relative operands are only supported by lea: '" + std::string(line) + "'");
+        }
+        else if (mnemonic == "lea" && kinds(OPND_REG, OPND_MEM) && ops[1].rip) {
+            // ModRM mod=00 rm=101 is [rip + disp32]; the displacement ends the instruction.
+            uint32_t start = static_cast<uint32_t>(enc.bytes().size());
+            enc.rex(ops[0].size == 8, ops[0].reg, 0, false);
+            enc.byte(0x8D);
+            enc.byte(static_cast<uint8_t>(0x05 | ((ops[0].reg & 7) << 3)));
+            Operand target;
+            target.name = ops[1].name;
+            branchTarget(target, start, 0);
+        }
+        else if (mnemonic == "mov" && ops.size() == 2) {
+            Operand& dst = ops[0];
+            Operand& src = ops[1];
+            if (dst.size == 0 || (dst.size != 1 && dst.size != 4 && dst.size != 8)) {
+                fail("unsupported operand size in '" + std::string(line) + "'");
+            }
+            else if (isRm(dst) && src.kind == OPND_REG && src.size == dst.size) {
+                enc.rmInstruction({ static_cast<uint8_t>(dst.size == 1 ? 0x88 : 0x89) }, dst.size, src.reg, dst, isByteReg(src));
+            }
+            else if (dst.kind == OPND_REG && src.kind == OPND_MEM) {
+                enc.rmInstruction({ static_cast<uint8_t>(dst.size == 1 ? 0x8A : 0x8B) }, dst.size, dst.reg, src, isByteReg(dst));
+            }
+            else if (dst.kind == OPND_REG && src.kind == OPND_IMM) {
+                if (dst.size == 8 && !fitsInt32(src.imm)) {
+                    enc.rex(true, 0, dst.reg, false);
+                    enc.byte(static_cast<uint8_t>(0xB8 + (dst.reg & 7)));
+                    enc.imm(src.imm, 8);
+                }
+                else if (dst.size == 8) {
+                    Operand rm = dst;
+                    enc.rmInstruction({ 0xC7 }, 8, 0, rm, false);
+                    enc.imm(src.imm, 4);
+                }
+                else {
+                    enc.rex(false, 0, dst.reg, dst.size == 1 && dst.reg >= 4 && dst.reg < 8);
+                    enc.byte(static_cast<uint8_t>((dst.size == 1 ? 0xB0 : 0xB8) + (dst.reg & 7)));
+                    enc.imm(src.imm, dst.size);
+                }
+            }
+            else if (dst.kind == OPND_MEM && src.kind == OPND_IMM && fitsInt32(src.imm)) {
+                enc.rmInstruction({ static_cast<uint8_t>(dst.size == 1 ? 0xC6 : 0xC7) }, dst.size, 0, dst, false);
+                enc.imm(src.imm, dst.size == 1 ? 1 : 4);
+            }
+            else {
+                fail("unsupported form of mov: '" + std::string(line) + "'");
+            }
+        }
+        else if (mnemonic == "movzx" && ops.size() == 2 && ops[0].kind == OPND_REG && isRm(ops[1])) {
+            if (ops[1].size == 0) ops[1].size = 1;
+            if (ops[1].size != 1 || ops[0].size < 4) {
+                fail("unsupported form of movzx: '" + std::string(line) + "'");
+            }
+            else {
+                bool forceRex = ops[1].kind == OPND_REG && ops[1].reg >= 4 && ops[1].reg < 8;
+                enc.rex(ops[0].size == 8, ops[0].reg, ops[1].reg, forceRex, ops[1].kind == OPND_MEM ? ops[1].index : -1);
+                enc.byte(0x0F);
+                enc.byte(0xB6);
+                enc.modrm(ops[0].reg, ops[1]);
+            }
+        }
+        else if (mnemonic == "movsxd" && ops.size() == 2 && ops[0].kind == OPND_REG && ops[0].size == 8 && isRm(ops[1])) {
+            if (ops[1].size == 0) ops[1].size = 4;
+            if (ops[1].size != 4) {
+                fail("unsupported form of movsxd: '" + std::string(line) + "'");
+            }
+            else {
+                enc.rmInstruction({ 0x63 }, 8, ops[0].reg, ops[1], false);
+            }
+        }
+        else if (mnemonic == "bt" && ops.size() == 2 && isRm(ops[0]) && ops[1].kind == OPND_REG && ops[1].size >= 4) {
+            enc.rmInstruction({ 0x0F, 0xA3 }, ops[1].size, ops[1].reg, ops[0], false);
+        }
+        else if (mnemonic == "lea" && kinds(OPND_REG, OPND_MEM)) {
+            enc.rmInstruction({ 0x8D }, ops[0].size, ops[0].reg, ops[1], false);
+        }
+        else if (kAluOps.count(mnemonic) && ops.size() == 2) {
+            const AluOp& alu = kAluOps.at(mnemonic);
+            Operand& dst = ops[0];
+            Operand& src = ops[1];
+            int size = dst.size;
+            if (size == 0) {
+                fail("operand size required in '" + std::string(line) + "'");
+            }
+            else if (isRm(dst) && src.kind == OPND_REG) {
+                enc.rmInstruction({ static_cast<uint8_t>(size == 1 ? alu.rmReg - 1 : alu.rmReg) }, size, src.reg, dst, isByteReg(src));
+            }
+            else if (dst.kind == OPND_REG && src.kind == OPND_MEM) {
+                enc.rmInstruction({ static_cast<uint8_t>(size == 1 ? alu.regRm - 1 : alu.regRm) }, size, dst.reg, src, isByteReg(dst));
+            }
+            else if (dst.kind == OPND_REG && dst.reg == 0 && src.kind == OPND_IMM && fitsInt32(src.imm) && (size == 1 || !fitsInt8(src.imm))) {
+                // Accumulator forms (op al, imm8 / op eax|rax, imm32), one byte shorter, as GNU as picks them
+                enc.rex(size == 8, 0, 0, false);
+                enc.byte(static_cast<uint8_t>(alu.rmReg + (size == 1 ? 3 : 4)));
+                enc.imm(src.imm, size == 1 ? 1 : 4);
+            }
+            else if (isRm(dst) && src.kind == OPND_IMM && fitsInt32(src.imm)) {
+                if (size == 1) {
+                    enc.rmInstruction({ 0x80 }, 1, alu.ext, dst, false);
+                    enc.imm(src.imm, 1);
+                }
+                else if (fitsInt8(src.imm)) {
+                    enc.rmInstruction({ 0x83 }, size, alu.ext, dst, false);
+                    enc.imm(src.imm, 1);
+                }
+                else {
+                    enc.rmInstruction({ 0x81 }, size, alu.ext, dst, false);
+                    enc.imm(src.imm, 4);
+                }
+            }
+            else {
+                fail("unsupported form of " + mnemonic + ": '" + std::string(line) + "'");
+            }
+        }
+        else if (mnemonic == "test" && ops.size() == 2 && isRm(ops[0]) && ops[1].kind == OPND_REG) {
+            int size = ops[1].size;
+            enc.rmInstruction({ static_cast<uint8_t>(size == 1 ? 0x84 : 0x85) }, size, ops[1].reg, ops[0], isByteReg(ops[1]));
+        }
+        else if (mnemonic == "imul" && ops.size() == 2 && ops[0].kind == OPND_REG && isRm(ops[1])) {
+            enc.rmInstruction({ 0x0F, 0xAF }, ops[0].size, ops[0].reg, ops[1], false);
+        }
+        else if (mnemonic == "imul" && ops.size() == 3 && ops[0].kind == OPND_REG && isRm(ops[1]) && ops[2].kind == OPND_IMM && fitsInt32(ops[2].imm)) {
+            bool short8 = fitsInt8(ops[2].imm);
+            enc.rmInstruction({ static_cast<uint8_t>(short8 ? 0x6B : 0x69) }, ops[0].size, ops[0].reg, ops[1], false);
+            enc.imm(ops[2].imm, short8 ? 1 : 4);
+        }
+        else if (kUnaryOps.count(mnemonic) && ops.size() == 1 && isRm(ops[0]) && ops[0].size >= 4) {
+            enc.rmInstruction({ 0xF7 }, ops[0].size, kUnaryOps.at(mnemonic), ops[0], false);
+        }
+        else if (kShiftOps.count(mnemonic) && ops.size() == 2 && isRm(ops[0]) && ops[0].size >= 4 && ops[1].kind == OPND_IMM) {
+            if (ops[1].imm == 1) {
+                enc.rmInstruction({ 0xD1 }, ops[0].size, kShiftOps.at(mnemonic), ops[0], false);
+            }
+            else {
+                enc.rmInstruction({ 0xC1 }, ops[0].size, kShiftOps.at(mnemonic), ops[0], false);
+                enc.imm(ops[1].imm, 1);
+            }
+        }
+        else if (mnemonic == "cqo" && ops.empty()) {
+            enc.byte(0x48);
+            enc.byte(0x99);
+        }
+        else if (mnemonic == "cdq" && ops.empty()) {
+            enc.byte(0x99);
+        }
+        else if (mnemonic == "ret" && ops.empty()) {
+            enc.byte(0xC3);
+        }
+        else if (mnemonic == "leave" && ops.empty()) {
+            enc.byte(0xC9);
+        }
+        else if (mnemonic == "nop" && ops.empty()) {
+            enc.byte(0x90);
+        }
+        else if ((mnemonic == "push" || mnemonic == "pop") && kinds(OPND_REG) && ops[0].size == 8) {
+            enc.rex(false, 0, ops[0].reg, false);
+            enc.byte(static_cast<uint8_t>((mnemonic == "push" ? 0x50 : 0x58) + (ops[0].reg & 7)));
+        }
+        else if (mnemonic == "push" && kinds(OPND_IMM) && fitsInt32(ops[0].imm)) {
+            if (fitsInt8(ops[0].imm)) {
+                enc.byte(0x6A);
+                enc.imm(ops[0].imm, 1);
+            }
+            else {
+                enc.byte(0x68);
+                enc.imm(ops[0].imm, 4);
+            }
+        }
+        else if ((mnemonic == "call" || mnemonic == "jmp") && kinds(OPND_NAME)) {
+            uint32_t start = static_cast<uint32_t>(enc.bytes().size());
+            enc.byte(mnemonic == "call" ? 0xE8 : 0xE9);
+            branchTarget(ops[0], start, mnemonic == "call" ? 0 : 0xEB);
+        }
+        else if (mnemonic == "jmp" && kinds(OPND_REG) && ops[0].size == 8) {
+            enc.rex(false, 0, ops[0].reg, false);
+            enc.byte(0xFF);
+            enc.modrm(4, ops[0]);
+        }
+        else if (mnemonic.size() > 1 && mnemonic[0] == 'j' && kConditions.count(mnemonic.substr(1)) && kinds(OPND_NAME)) {
+            uint32_t start = static_cast<uint32_t>(enc.bytes().size());
+            int cc = kConditions.at(mnemonic.substr(1));
+            enc.byte(0x0F);
+            enc.byte(static_cast<uint8_t>(0x80 + cc));
+            branchTarget(ops[0], start, static_cast<uint8_t>(0x70 + cc));
+        }
+        else if (mnemonic.size() > 3 && mnemonic.compare(0, 3, "set") == 0 && kConditions.count(mnemonic.substr(3)) &&
+            ops.size() == 1 && isRm(ops[0]) && (ops[0].size == 1 || ops[0].size == 0)) {
+            ops[0].size = 1;
+            enc.rmInstruction({ 0x0F, static_cast<uint8_t>(0x90 + kConditions.at(mnemonic.substr(3))) }, 1, 0, ops[0], false);
+        }
+        else if (mnemonic.size() > 4 && mnemonic.compare(0, 4, "cmov") == 0 && kConditions.count(mnemonic.substr(4)) &&
+            ops.size() == 2 && ops[0].kind == OPND_REG && isRm(ops[1]) && ops[0].size >= 4) {
+            enc.rmInstruction({ 0x0F, static_cast<uint8_t>(0x40 + kConditions.at(mnemonic.substr(4))) }, ops[0].size, ops[0].reg, ops[1], false);
+        }
+        else {
+            fail("unsupported instruction '" + std::string(line) + "'");
+        }
+    }
+
+    relaxBranches(out.bytes, fixups, labels, differences);
+
+    // Resolve branches: local labels become rel32 displacements, everything else a relocation.
+    for (const auto& fix : fixups) {
+        auto it = labels.find(fix.label);
+        if (it != labels.end()) {
+            int64_t rel = static_cast<int64_t>(it->second) - static_cast<int64_t>(fix.offset + 4);
+            for (int i = 0; i < 4; ++i) out.bytes[fix.offset + i] = static_cast<uint8_t>((static_cast<uint64_t>(rel) >> (8 * i)) & 0xFF);
+        }
+        else if (fix.label.compare(0, 2, ".L") == 0) {
+            errors_.push_back("Assembler error: line " + std::to_string(fix.line) + ": undefined label '" + fix.label + "'");
+        }
+        else {
+            out.relocations.push_back({ fix.offset, fix.label, -4 });
+        }
+    }
+
+    for (const auto& d : differences) {
+        auto plus = labels.find(d.plus);
+        auto minus = labels.find(d.minus);
+        if (plus == labels.end() || minus == labels.end()) {
+            errors_.push_back("Assembler error: line " + std::to_string(d.line) + ": .long needs two labels defined in this text");
+            continue;
+        }
+        int64_t value = static_cast<int64_t>(plus->second) - static_cast<int64_t>(minus->second);
+        for (int i = 0; i < 4; ++i) out.bytes[d.offset + i] = static_cast<uint8_t>((static_cast<uint64_t>(value) >> (8 * i)) & 0xFF);
+    }
+
+    for (const auto& [name, offset] : labels) {
+        if (name.compare(0, 2, ".L") == 0) continue;
+        out.symbols.push_back({ name, offset, globals.count(name) > 0 });
+    }
+    std::sort(out.symbols.begin(), out.symbols.end(), [](const CodeSymbol& a, const CodeSymbol& b) { return a.offset < b.offset; });
+
+    return errors_.empty();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// PC-relative 32-bit fixup against a symbol defined outside the assembled text
+// (e.g. `call print_int`). Resolves to  S + addend - (address of the field).
+struct Relocation {
+    uint32_t offset;     // Offset of the 4-byte field in MachineCode::bytes
+    std::string symbol;
+    int32_t addend;
+};
+
+struct CodeSymbol {
+    std::string name;
+    uint32_t offset;
+    bool global;
+};
+
+// Position-independent machine code plus what a linker or JIT needs to place it.
+struct MachineCode {
+    std::vector<uint8_t> bytes;
+    std::vector<Relocation> relocations;
+    std::vector<CodeSymbol> symbols;     // Non-local labels (".L" labels are resolved internally)
+
+    const CodeSymbol* findSymbol(std::string_view name) const;
+};
+
+// Assembles the Intel-syntax GNU as subset that CodeGenerator emits: general
+// purpose register/immediate/[base+index*scale+disp] operands, the integer ALU,
+// mov/movzx/movsxd, bt, push/pop, setcc/jcc/jmp/call/ret, `lea r, [rip + label]`
+// and the .globl/.text/.long directives (`.long a - b` for jump tables).
+class X86Assembler {
+public:
+    bool assemble(std::string_view text, MachineCode& out);
+    const std::vector<std::string>& getErrors() const { return errors_; }
+
+private:
+    std::vector<std::string> errors_;
+};
@@ -0,0 +1,579 @@
+// compile_bench.cpp
+//
+// Throughput benchmarks for the compiler itself. Each benchmark generates a
+// synthetic input, runs one compiler phase over it several times and reports
+// the best time as MB/s plus a phase-specific rate.
+//
+// Usage: GLFXBench [name-filter] [--kb N]
+// Some filters also print a comparison after the phase benchmarks:
+//   "tiered"  cumulative interpreter, native and tiered run time by invocation count
+//   "scan"    GB/s of the reduce/scan runtime against scalar loops
+//   "sort"    Mkeys/s of the radix sort against std::sort
+//   "raster"  triangles and pixels per second of the software rasterizer on test scenes
+//   "mmap"    GB/s loading and summing a file through MappedFile against reading it into a buffer
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Codegen.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "ast.h"
+#include "jit.h"
+#include "mapped_file.h"
+#include "radix_sort.h"
+#include "rasterizer.h"
+#include "reduce_scan.h"
+#include "semantic_analyzer.h"
+#include "tiered.h"
+
+struct BenchResult {
+    double seconds = 0.0; // best of several repetitions
+    size_t items = 0;     // phase-specific unit (tokens, statements, ...)
+};
+
+struct Benchmark {
+    const char* name;
+    const char* unit;
+    std::function<std::string(size_t targetBytes)> input;
+    std::function<size_t(const std::string& source)> run; // returns item count
+};
+
+// --- Input generators ---
+
+// Every statement mixes all binary operator levels, unary operators, calls,
+// member access and ?: so that parseExpression dispatches on every token.
+static std::string operatorDenseSource(size_t targetBytes) {
+    static const char* kStatements[] = {
+        "r = (a + b * c - d / e % f < g) == (h >= i) && !j || k ? -l : m;\n",
+        "s = a * -b + c % d - (e / f) * g <= h != i > j;\n",
+        "t = p || q && r == s != t ? u + v : w - x * y;\n",
+        "u = f(a, b + c, -d) -> x + g(h * i) % j;\n",
+        "v = a < b ? c < d ? e : f : g >= h ? i : j;\n",
+    };
+    std::string out;
+    out.reserve(targetBytes + 128);
+    for (size_t i = 0; out.size() < targetBytes; ++i) {
+        out += kStatements[i % (sizeof(kStatements) / sizeof(kStatements[0]))];
+    }
+    return out;
+}
+
+// Straight-line code over a few thousand long-named variables: every operand
+// is a variable reference, so the run is dominated by resolving them.
+static std::string variableDenseSource(size_t targetBytes) {
+    const size_t kVariables = 4096;
+    auto name = [](size_t v) { return "particle_velocity_" + std::to_string(v); };
+    std::string out;
+    out.reserve(targetBytes + 256);
+    for (size_t v = 0; v < kVariables && out.size() < targetBytes; ++v) {
+        out += name(v) + " = " + std::to_string(v) + ";\n";
+    }
+    uint32_t state = 12345;
+    auto pick = [&] { state = state * 1664525u + 1013904223u; return name((state >> 8) % kVariables); };
+    while (out.size() < targetBytes) {
+        out += pick() + " = " + pick() + " + " + pick() + " * " + pick() + " - " + pick() + ";\n";
+    }
+    return out;
+}
+
+// --- Phases ---
+
+static size_t lexOnly(const std::string& source) {
+    Lexer lexer(source);
+    size_t tokens = 0;
+    while (lexer.nextToken().type != END_OF_FILE) {
+        ++tokens;
+    }
+    return tokens;
+}
+
+static size_t lexAndParse(const std::string& source) {
+    Lexer lexer(source);
+    Parser parser(lexer);
+    auto program = parser.parseProgram();
+    return program->statements.size();
+}
+
+static size_t lexParseAnalyze(const std::string& source) {
+    Lexer lexer(source);
+    Parser parser(lexer);
+    auto program = parser.parseProgram();
+    SemanticAnalyzer sema;
+    sema.analyze(*program);
+    return program->statements.size();
+}
+
+// Everything up to assembly text; less analyze_variables, the code generator's share.
+static size_t lexParseAnalyzeGenerate(const std::string& source) {
+    Lexer lexer(source);
+    Parser parser(lexer);
+    auto program = parser.parseProgram();
+    SemanticAnalyzer sema;
+    sema.analyze(*program);
+    CodeGenerator codegen;
+    codegen.generate(program.get());
+    return program->statements.size();
+}
+
+// --- JIT ---
+
+// A typical live-edited script: a handful of statements.
+static std::string smallScript(size_t) {
+    return "a = 3;\nb = a * 7 + 1;\nc = b % 5 == 1 ? a : b;\nprint(c);\n";
+}
+
+static std::atomic<long> gSink{ 0 };
+static void sinkPrintInt(long n) { gSink.fetch_add(n, std::memory_order_relaxed); }
+static void sinkPrintBool(bool b) { gSink.fetch_add(b, std::memory_order_relaxed); }
+
+static void defineSinks(JitEngine& jit) {
+    jit.defineSymbol("print_int", reinterpret_cast<const void*>(&sinkPrintInt));
+    jit.defineSymbol("print_bool", reinterpret_cast<const void*>(&sinkPrintBool));
+}
+
+// Compile-to-running latency of an edit: compile, link, swap the stub and
+// reclaim the old code, while another thread keeps calling through the stub.
+static size_t jitSwap(const std::string& source) {
+    JitEngine jit;
+    defineSinks(jit);
+    jit.load("script", source);
+
+    std::atomic<bool> stop{ false };
+    std::thread caller([&] {
+        EpochReclaimer::Participant* self = jit.epochs().registerThread();
+        while (!stop.load(std::memory_order_relaxed)) jit.run("script", self);
+        jit.epochs().unregisterThread(self);
+    });
+
+    const size_t swaps = 200;
+    for (size_t i = 0; i < swaps; ++i) {
+        jit.load("script", source);
+        jit.reclaim();
+    }
+    stop = true;
+    caller.join();
+    return swaps;
+}
+
+static constexpr size_t kCalls = 1000000;
+
+// Steady-state cost of a call through the patchable stub...
+static size_t jitCallStub(const std::string& source) {
+    JitEngine jit;
+    defineSinks(jit);
+    jit.load("script", source);
+    EpochReclaimer::Participant* self = jit.epochs().registerThread();
+    JitEngine::Entry fn = jit.entry("script");
+    {
+        EpochGuard guard(jit.epochs(), self);
+        for (size_t i = 0; i < kCalls; ++i) fn();
+    }
+    jit.epochs().unregisterThread(self);
+    return kCalls;
+}
+
+// ...versus calling the same code directly.
+static size_t jitCallDirect(const std::string& source) {
+    JitEngine jit;
+    defineSinks(jit);
+    jit.load("script", source);
+    EpochReclaimer::Participant* self = jit.epochs().registerThread();
+    {
+        EpochGuard guard(jit.epochs(), self);
+        JitEngine::Entry fn = jit.target("script");
+        for (size_t i = 0; i < kCalls; ++i) fn();
+    }
+    jit.epochs().unregisterThread(self);
+    return kCalls;
+}
+
+static const std::vector<Benchmark> kBenchmarks = {
+    { "lex_operators", "tokens", operatorDenseSource, lexOnly },
+    { "parse_operators", "statements", operatorDenseSource, lexAndParse },
+    { "analyze_variables", "statements", variableDenseSource, lexParseAnalyze },
+    { "codegen_variables", "statements", variableDenseSource, lexParseAnalyzeGenerate },
+    { "jit_swap", "swaps", smallScript, jitSwap },
+    { "jit_call_stub", "calls", smallScript, jitCallStub },
+    { "jit_call_direct", "calls", smallScript, jitCallDirect },
+};
+
+// --- Tiering curves ---
+
+// A script with enough straight-line work that native code clearly wins per call.
+static std::string tieringScript() {
+    std::string out = "x0 = 7;\n";
+    for (int i = 1; i < 200; ++i) {
+        out += "x" + std::to_string(i) + " = x" + std::to_string(i - 1) + " * 3 % 1009 + " + std::to_string(i) + ";\n";
+    }
+    out += "print(x199);\n";
+    return out;
+}
+
+// Cumulative wall time from load to the end of the k-th invocation, for the
+// interpreter alone, native code alone, and the tiered runtime.
+static void printTieringCurves() {
+    using clock = std::chrono::steady_clock;
+    static const size_t kCheckpoints[] = { 1, 10, 100, 1000, 10000 };
+    const size_t maxCalls = 10000;
+    const std::string source = tieringScript();
+    RuntimeHooks hooks;
+    hooks.printInt = sinkPrintInt;
+    hooks.printBool = sinkPrintBool;
+
+    auto curve = [&](auto&& loadFn, auto&& invokeFn) {
+        std::vector<double> ms;
+        auto start = clock::now();
+        loadFn();
+        size_t next = 0;
+        for (size_t call = 1; call <= maxCalls; ++call) {
+            invokeFn();
+            if (call == kCheckpoints[next]) {
+                ms.push_back(std::chrono::duration<double, std::milli>(clock::now() - start).count());
+                ++next;
+            }
+        }
+        return ms;
+    };
+
+    std::vector<double> interp, native, tiered;
+    {
+        TieredOptions options;
+        options.compileThreshold = UINT32_MAX;
+        TieredRuntime rt(hooks, options);
+        EpochReclaimer::Participant* self = rt.epochs().registerThread();
+        interp = curve([&] { rt.load("s", source); }, [&] { rt.invoke("s", self); });
+        rt.epochs().unregisterThread(self);
+    }
+    {
+        JitEngine jit;
+        defineSinks(jit);
+        EpochReclaimer::Participant* self = jit.epochs().registerThread();
+        native = curve([&] { jit.load("s", source); }, [&] { jit.run("s", self); });
+        jit.epochs().unregisterThread(self);
+    }
+    {
+        TieredRuntime rt(hooks);
+        EpochReclaimer::Participant* self = rt.epochs().registerThread();
+        tiered = curve([&] { rt.load("s", source); }, [&] { rt.invoke("s", self); });
+        rt.epochs().unregisterThread(self);
+    }
+
+    std::printf("\n%-12s %14s %14s %14s   (cumulative ms from load, %zu-byte script)\n",
+        "invocations", "interpreter", "native", "tiered", source.size());
+    for (size_t i = 0; i < interp.size(); ++i) {
+        std::printf("%-12zu %14.3f %14.3f %14.3f\n", kCheckpoints[i], interp[i], native[i], tiered[i]);
+    }
+}
+
+// --- Reduce and scan ---
+
+template <typename Fn>
+static double bestSeconds(Fn&& fn) {
+    using clock = std::chrono::steady_clock;
+    double best = 1e30;
+    for (int rep = 0; rep < 5; ++rep) {
+        auto start = clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double>(clock::now() - start).count());
+    }
+    return best;
+}
+
+// GB/s read by a scalar loop, the SIMD kernels on one thread and the blocked
+// parallel version, over 64 MiB of int32 and int64 input.
+template <typename T>
+static void printScanRows(const char* type) {
+    const size_t n = (size_t(64) << 20) / sizeof(T);
+    std::vector<T> in(n), out(n);
+    std::mt19937_64 rng(42);
+    for (auto& v : in) v = static_cast<T>(rng() % 1000);
+    ScanOptions serial;
+    serial.parallelThreshold = SIZE_MAX;
+    ScanOptions parallel;
+    const double gb = n * sizeof(T) / 1e9;
+    std::atomic<long> sink{ 0 };
+
+    for (ScanOp op : { SCAN_ADD, SCAN_MAX, SCAN_XOR }) {
+        auto scalarReduce = [&] {
+            T acc = op == SCAN_MAX ? std::numeric_limits<T>::min() : 0;
+            for (size_t i = 0; i < n; ++i) acc = op == SCAN_ADD ? acc + in[i] : op == SCAN_MAX ? std::max(acc, in[i]) : acc ^ in[i];
+            sink += static_cast<long>(acc);
+        };
+        auto scalarScan = [&] {
+            T acc = op == SCAN_MAX ? std::numeric_limits<T>::min() : 0;
+            for (size_t i = 0; i < n; ++i) out[i] = acc = op == SCAN_ADD ? acc + in[i] : op == SCAN_MAX ? std::max(acc, in[i]) : acc ^ in[i];
+        };
+        std::string name = std::string("reduce ") + scanOpName(op) + " " + type;
+        std::printf("%-24s %10.2f %10.2f %10.2f\n", name.c_str(), gb / bestSeconds(scalarReduce),
+            gb / bestSeconds([&] { sink += static_cast<long>(reduce(in.data(), n, op, serial)); }),
+            gb / bestSeconds([&] { sink += static_cast<long>(reduce(in.data(), n, op, parallel)); }));
+        name = std::string("inclusive_scan ") + scanOpName(op) + " " + type;
+        std::printf("%-24s %10.2f %10.2f %10.2f\n", name.c_str(), gb / bestSeconds(scalarScan),
+            gb / bestSeconds([&] { inclusiveScan(in.data(), out.data(), n, op, serial); }),
+            gb / bestSeconds([&] { inclusiveScan(in.data(), out.data(), n, op, parallel); }));
+    }
+}
+
+static void printScanThroughput() {
+    std::printf("\n%-24s %10s %10s %10s   (GB/s of input, %u threads)\n",
+        "operation", "scalar", "simd", "parallel", std::max(1u, std::thread::hardware_concurrency()));
+    printScanRows<int32_t>("i32");
+    printScanRows<int64_t>("i64");
+}
+
+// --- Radix sort ---
+
+// Mkeys/s sorting `n` random keys with their indices as values (each run
+// restores the unsorted input first): std::sort on pairs, the radix sort on
+// the calling thread, and the radix sort with threaded passes.
+template <typename K>
+static void printSortRows(const char* type) {
+    std::mt19937_64 rng(7);
+    for (size_t n : { size_t(16), size_t(1) << 10, size_t(1) << 16, size_t(1) << 20, size_t(1) << 22 }) {
+        std::vector<K> input(n), keys(n);
+        std::vector<uint32_t> values(n);
+        for (auto& k : input) {
+            if constexpr (std::is_floating_point_v<K>) k = static_cast<K>(std::uniform_real_distribution<double>(-1e6, 1e6)(rng));
+            else k = static_cast<K>(rng());
+        }
+        std::vector<std::pair<K, uint32_t>> pairs(n);
+        const size_t runs = std::max<size_t>(1, (size_t(1) << 22) / n);
+        auto mkeys = [&](auto&& sortOnce) {
+            double seconds = bestSeconds([&] { for (size_t r = 0; r < runs; ++r) sortOnce(); });
+            return n * runs / seconds / 1e6;
+        };
+        SortOptions serial;
+        serial.parallelThreshold = SIZE_MAX;
+        SortOptions parallel;
+        double stdSort = mkeys([&] {
+            for (size_t i = 0; i < n; ++i) pairs[i] = { input[i], static_cast<uint32_t>(i) };
+            std::sort(pairs.begin(), pairs.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        });
+        auto radix = [&](const SortOptions& options) {
+            return mkeys([&] {
+                keys = input;
+                for (size_t i = 0; i < n; ++i) values[i] = static_cast<uint32_t>(i);
+                radixSort(keys.data(), values.data(), n, options);
+            });
+        };
+        std::string name = std::string("sort ") + type + " n=" + std::to_string(n);
+        std::printf("%-24s %10.1f %10.1f %10.1f\n", name.c_str(), stdSort, radix(serial), radix(parallel));
+    }
+}
+
+static void printSortThroughput() {
+    std::printf("\n%-24s %10s %10s %10s   (Mkeys/s with uint32 values, %u threads)\n",
+        "keys", "std::sort", "radix", "threaded", std::max(1u, std::thread::hardware_concurrency()));
+    printSortRows<uint32_t>("u32");
+    printSortRows<uint64_t>("u64");
+    printSortRows<float>("f32");
+}
+
+// --- Rasterizer ---
+
+struct RasterScene {
+    const char* name;
+    std::vector<RasterVertex> vertices;
+    std::vector<uint32_t> indices;
+    bool depth;
+};
+
+static void gradientShader(const RasterQuad& quad, uint32_t colors[4], void*) {
+    for (int i = 0; i < 4; ++i) {
+        uint32_t r = static_cast<uint32_t>(quad.b1[i] * 255.0f), g = static_cast<uint32_t>(quad.b2[i] * 255.0f);
+        colors[i] = 0xFF000000u | (r << 16) | (g << 8) | (quad.triangle & 0xFF);
+    }
+}
+
+// 1920x1080 scenes: a mesh of small triangles sharing edges, a few triangles
+// covering most of the screen, and depth-tested random triangles.
+static std::vector<RasterScene> rasterScenes(int width, int height) {
+    std::vector<RasterScene> scenes;
+    std::mt19937 rng(11);
+
+    RasterScene grid{ "mesh 73k tris", {}, {}, false };
+    const int cellsX = 256, cellsY = 144;
+    for (int y = 0; y <= cellsY; ++y) {
+        for (int x = 0; x <= cellsX; ++x) {
+            grid.vertices.push_back({ x * float(width) / cellsX, y * float(height) / cellsY, 0.5f });
+        }
+    }
+    for (int y = 0; y < cellsY; ++y) {
+        for (int x = 0; x < cellsX; ++x) {
+            uint32_t p = y * (cellsX + 1) + x;
+            grid.indices.insert(grid.indices.end(), { p, p + 1, p + cellsX + 1, p + 1, p + cellsX + 2, p + cellsX + 1 });
+        }
+    }
+    scenes.push_back(std::move(grid));
+
+    RasterScene large{ "large 64 tris", {}, {}, false };
+    std::uniform_real_distribution<float> wide(-0.25f, 1.25f);
+    for (uint32_t i = 0; i < 3 * 64; ++i) {
+        large.vertices.push_back({ wide(rng) * width, wide(rng) * height, 0.5f });
+        large.indices.push_back(i);
+    }
+    scenes.push_back(std::move(large));
+
+    RasterScene random{ "random 20k tris, depth", {}, {}, true };
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f), offset(-24.0f, 24.0f);
+    for (uint32_t i = 0; i < 20000; ++i) {
+        float cx = unit(rng) * width, cy = unit(rng) * height, z = unit(rng);
+        for (int k = 0; k < 3; ++k) random.vertices.push_back({ cx + offset(rng), cy + offset(rng), z });
+        random.indices.insert(random.indices.end(), { 3 * i, 3 * i + 1, 3 * i + 2 });
+    }
+    scenes.push_back(std::move(random));
+    return scenes;
+}
+
+static void printRasterThroughput() {
+    const int width = 1920, height = 1080;
+    std::vector<uint32_t> pixels(size_t(width) * height);
+    std::vector<float> depth(pixels.size());
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("\n%-24s %8s %12s %12s %12s %12s   (%dx%d)\n",
+        "scene", "threads", "Ktris/s", "Mpixels/s", "ms/frame", "pixels", width, height);
+    for (const auto& scene : rasterScenes(width, height)) {
+        for (unsigned count : { 1u, threads }) {
+            RasterOptions options;
+            options.threads = count;
+            RasterStats stats;
+            double seconds = bestSeconds([&] {
+                RasterImage image{ pixels.data(), scene.depth ? depth.data() : nullptr, width, height, width };
+                if (scene.depth) std::fill(depth.begin(), depth.end(), 1.0f);
+                stats = drawTriangles(image, scene.vertices.data(), scene.indices.data(), scene.indices.size() / 3,
+                    gradientShader, nullptr, options);
+            });
+            std::printf("%-24s %8u %12.2f %12.1f %12.2f %12zu\n", scene.name, count, stats.triangles / seconds / 1e3,
+                stats.pixels / seconds / 1e6, seconds * 1e3, stats.pixels);
+            if (count == threads) break;
+        }
+    }
+}
+
+// --- File loading ---
+
+// Loads a 256 MiB file and sums it as 64-bit words, so every page is touched:
+// fread into a buffer, then MappedFile with each access hint. The file was
+// just written, so both read from the page cache.
+static void printMappedFileThroughput() {
+    const size_t bytes = size_t(256) << 20;
+    auto path = std::filesystem::temp_directory_path() / "glfx_bench_mmap.bin";
+    {
+        std::vector<uint64_t> words(bytes / sizeof(uint64_t));
+        std::mt19937_64 rng(3);
+        for (auto& w : words) w = rng();
+        std::FILE* f = std::fopen(path.string().c_str(), "wb");
+        if (!f) return;
+        std::fwrite(words.data(), 1, bytes, f);
+        std::fclose(f);
+    }
+
+    std::atomic<uint64_t> sink{ 0 };
+    auto sum = [&](std::span<const uint64_t> words) {
+        uint64_t acc = 0;
+        for (uint64_t w : words) acc += w;
+        sink += acc;
+    };
+    auto report = [&](const char* name, double seconds) {
+        std::printf("%-24s %10.2f %10.1f\n", name, bytes / seconds / 1e9, seconds * 1e3);
+    };
+
+    std::printf("\n%-24s %10s %10s   (%zu MiB file, page cache warm)\n", "load and sum", "GB/s", "ms", bytes >> 20);
+    report("fread into buffer", bestSeconds([&] {
+        std::vector<uint64_t> buffer(bytes / sizeof(uint64_t));
+        std::FILE* f = std::fopen(path.string().c_str(), "rb");
+        if (!f) return;
+        size_t got = std::fread(buffer.data(), 1, bytes, f);
+        std::fclose(f);
+        sum({ buffer.data(), got / sizeof(uint64_t) });
+    }));
+    const std::pair<const char*, uint32_t> hints[] = {
+        { "mmap", MappedFile::ACCESS_NORMAL },
+        { "mmap sequential", MappedFile::ACCESS_SEQUENTIAL },
+        { "mmap will-need", MappedFile::ACCESS_WILL_NEED },
+    };
+    for (const auto& [name, hint] : hints) {
+        report(name, bestSeconds([&] {
+            MappedFile file(path, hint);
+            std::span<const uint64_t> words;
+            if (file.ok() && file.view(words)) sum(words);
+        }));
+    }
+    std::filesystem::remove(path);
+}
+
+// --- Driver ---
+
+static BenchResult measure(const Benchmark& bench, const std::string& source) {
+    using clock = std::chrono::steady_clock;
+    BenchResult result;
+    result.seconds = 1e30;
+    double total = 0.0;
+    for (int rep = 0; rep < 50 && (rep < 3 || total < 0.5); ++rep) {
+        auto start = clock::now();
+        result.items = bench.run(source);
+        double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        result.seconds = std::min(result.seconds, elapsed);
+        total += elapsed;
+    }
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    std::string filter;
+    size_t targetBytes = 4 * 1024 * 1024;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--kb" && i + 1 < argc) {
+            targetBytes = std::strtoull(argv[++i], nullptr, 10) * 1024;
+        }
+        else if (!arg.empty() && arg[0] != '-') {
+            filter = arg;
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [name-filter] [--kb N]\n";
+            return 2;
+        }
+    }
+
+    std::printf("%-24s %10s %10s %16s %12s\n", "benchmark", "bytes", "MB/s", "rate", "ns/item");
+    for (const auto& bench : kBenchmarks) {
+        if (!filter.empty() && std::string(bench.name).find(filter) == std::string::npos) continue;
+
+        std::string source = bench.input(targetBytes);
+        BenchResult r = measure(bench, source);
+        double mbps = source.size() / r.seconds / 1e6;
+        double rate = r.items / r.seconds / 1e6;
+        double nsPerItem = r.seconds * 1e9 / r.items;
+        std::printf("%-24s %10zu %10.1f %9.2f M%s/s %12.1f\n", bench.name, source.size(), mbps, rate, bench.unit, nsPerItem);
+    }
+    if (filter.empty() || std::string("tiered").find(filter) != std::string::npos) {
+        printTieringCurves();
+    }
+    if (filter.empty() || std::string("scan").find(filter) != std::string::npos) {
+        printScanThroughput();
+    }
+    if (filter.empty() || std::string("sort").find(filter) != std::string::npos) {
+        printSortThroughput();
+    }
+    if (filter.empty() || std::string("raster").find(filter) != std::string::npos) {
+        printRasterThroughput();
+    }
+    if (filter.empty() || std::string("mmap").find(filter) != std::string::npos) {
+        printMappedFileThroughput();
+    }
+    return 0;
+}
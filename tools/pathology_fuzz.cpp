@@ -0,0 +1,357 @@
+// pathology_fuzz.cpp
+//
+// Performance-pathology fuzzer for the Lexer -> Parser -> SemanticAnalyzer pipeline.
+//
+// Every candidate is a small fragment that gets scaled up (repeated, nested, ...)
+// to several sizes. For each size we measure compile time and peak heap usage and
+// estimate the growth exponent between the two largest sizes. Linear behaviour gives
+// an exponent near 1.0; anything above the threshold is reported as super-linear,
+// minimized by dropping pieces of the fragment while the pathology persists, and
+// written to the output directory as a regression benchmark.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Lexer.h"
+#include "Parser.h"
+#include "ast.h"
+#include "semantic_analyzer.h"
+
+// --- Heap accounting ---
+// Every allocation carries a small header with its size so peak live bytes can be
+// tracked without relying on platform-specific malloc introspection.
+
+static std::atomic<size_t> liveBytes{ 0 };
+static std::atomic<size_t> peakBytes{ 0 };
+
+static constexpr size_t kHeader = alignof(std::max_align_t);
+
+static void* trackedAlloc(size_t size) {
+    void* raw = std::malloc(size + kHeader);
+    if (!raw) throw std::bad_alloc();
+    *static_cast<size_t*>(raw) = size;
+    size_t live = liveBytes.fetch_add(size) + size;
+    size_t peak = peakBytes.load();
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live)) {}
+    return static_cast<char*>(raw) + kHeader;
+}
+
+static void trackedFree(void* p) noexcept {
+    if (!p) return;
+    void* raw = static_cast<char*>(p) - kHeader;
+    liveBytes.fetch_sub(*static_cast<size_t*>(raw));
+    std::free(raw);
+}
+
+void* operator new(size_t size) { return trackedAlloc(size); }
+void* operator new[](size_t size) { return trackedAlloc(size); }
+void operator delete(void* p) noexcept { trackedFree(p); }
+void operator delete[](void* p) noexcept { trackedFree(p); }
+void operator delete(void* p, size_t) noexcept { trackedFree(p); }
+void operator delete[](void* p, size_t) noexcept { trackedFree(p); }
+
+// --- Pipeline measurement ---
+
+struct Measurement {
+    size_t bytes = 0;
+    double seconds = 0.0;  // best of several repetitions
+    double heap = 0.0;     // peak live heap bytes during one compile
+};
+
+static void compileOnce(const std::string& source) {
+    Lexer lexer(source);
+    Parser parser(lexer);
+    auto program = parser.parseProgram();
+    if (program && parser.getErrors().empty()) {
+        SemanticAnalyzer sema;
+        sema.analyze(*program);
+    }
+}
+
+static Measurement measure(const std::string& source, double minTotalSeconds) {
+    using clock = std::chrono::steady_clock;
+    Measurement m;
+    m.bytes = source.size();
+    m.seconds = 1e30;
+
+    size_t baseline = liveBytes.load();
+    peakBytes.store(baseline);
+    double total = 0.0;
+    int reps = 0;
+    do {
+        auto start = clock::now();
+        compileOnce(source);
+        double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        m.seconds = std::min(m.seconds, elapsed);
+        total += elapsed;
+        ++reps;
+    } while (total < minTotalSeconds && reps < 1000);
+    m.heap = static_cast<double>(peakBytes.load() - baseline);
+    return m;
+}
+
+// --- Scaling families ---
+// A family turns (fragment, n) into an input whose size grows linearly with n.
+
+struct Family {
+    const char* name;
+    std::function<std::string(const std::string& fragment, size_t n)> scale;
+};
+
+static std::string repeat(const std::string& s, size_t n) {
+    std::string out;
+    out.reserve(s.size() * n);
+    for (size_t i = 0; i < n; ++i) out += s;
+    return out;
+}
+
+static const std::vector<Family> kFamilies = {
+    // fragment repeated back to back
+    { "repeat", [](const std::string& f, size_t n) { return repeat(f, n); } },
+    // fragment repeated inside an unterminated multi-line comment
+    { "unterminated_comment", [](const std::string& f, size_t n) { return "###" + repeat(f, n); } },
+    // fragment used as the innermost operand of n nested parentheses
+    { "deep_nesting", [](const std::string& f, size_t n) {
+        return "a = " + repeat("(", n) + f + repeat(")", n) + ";";
+    } },
+    // fragment used as the right-hand side of a chain of n dependent definitions
+    { "identifier_chain", [](const std::string& f, size_t n) {
+        std::string out = "v0 = " + f + ";\n";
+        for (size_t i = 1; i < n; ++i) {
+            out += "v" + std::to_string(i) + " = v" + std::to_string(i - 1) + " + " + f + ";\n";
+        }
+        return out;
+    } },
+    // fragment as every operand of one long binary expression
+    { "long_expression", [](const std::string& f, size_t n) {
+        std::string out = "a = " + f;
+        for (size_t i = 1; i < n; ++i) out += " + " + f;
+        return out + ";";
+    } },
+};
+
+// --- Random fragments ---
+
+static const std::vector<std::string> kVocabulary = {
+    "a", "b", "x1", "_tmp", "print", "true", "false",
+    "0", "1", "42", "0x1F", "017", "3.14",
+    "\"s\"", "\"", "'c'", "'",
+    "=", "+", "-", "*", "/", "(", ")", ";", ":",
+    "#", "###", "\n", " ", "@", "$",
+};
+
+static std::string randomFragment(std::mt19937_64& rng, size_t maxTokens) {
+    std::uniform_int_distribution<size_t> count(1, maxTokens);
+    std::uniform_int_distribution<size_t> pick(0, kVocabulary.size() - 1);
+    std::string out;
+    size_t n = count(rng);
+    for (size_t i = 0; i < n; ++i) {
+        out += kVocabulary[pick(rng)];
+        out += ' ';
+    }
+    return out;
+}
+
+// --- Growth analysis ---
+
+struct Options {
+    size_t iterations = 200;
+    uint64_t seed = 1;
+    double threshold = 1.5;      // growth exponent that counts as super-linear
+    size_t targetBytes = 32768;  // approximate input size of the largest scale step
+    double minSeconds = 0.005;   // minimum accumulated time per measurement
+    std::string outDir = "bench/pathology";
+};
+
+struct Finding {
+    const Family* family = nullptr;
+    std::string fragment;
+    size_t n = 0;
+    double timeExponent = 0.0;
+    double memoryExponent = 0.0;
+    std::vector<Measurement> steps;
+};
+
+// Least-squares slope of log(value) over log(bytes): the empirical growth exponent.
+static double growthExponent(const std::vector<Measurement>& steps, double Measurement::* field) {
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    size_t n = 0;
+    for (const auto& m : steps) {
+        double v = m.*field;
+        if (m.bytes == 0 || v <= 0.0) continue;
+        double x = std::log2(static_cast<double>(m.bytes));
+        double y = std::log2(v);
+        sx += x; sy += y; sxx += x * x; sxy += x * y;
+        ++n;
+    }
+    double denom = n * sxx - sx * sx;
+    return (n < 2 || denom <= 0.0) ? 0.0 : (n * sxy - sx * sy) / denom;
+}
+
+// Measures the family at n, 2n, 4n and 8n, where n is chosen so that the largest
+// input is around targetBytes. Returns true when time or memory grows super-linearly.
+static bool analyze(const Family& family, const std::string& fragment, const Options& opt, Finding& out) {
+    size_t unit = std::max<size_t>(1, family.scale(fragment, 2).size() - family.scale(fragment, 1).size());
+    size_t n = std::max<size_t>(4, opt.targetBytes / (8 * unit));
+
+    out.family = &family;
+    out.fragment = fragment;
+    out.n = n;
+    out.steps.clear();
+    for (size_t k = 1; k <= 8; k *= 2) {
+        out.steps.push_back(measure(family.scale(fragment, n * k), opt.minSeconds));
+    }
+
+    out.timeExponent = growthExponent(out.steps, &Measurement::seconds);
+    out.memoryExponent = growthExponent(out.steps, &Measurement::heap);
+    if (out.timeExponent <= opt.threshold && out.memoryExponent <= opt.threshold) return false;
+
+    // Timing noise is common on small inputs; only trust time findings that reproduce.
+    if (out.memoryExponent <= opt.threshold) {
+        std::vector<Measurement> again;
+        for (size_t k = 1; k <= 8; k *= 2) {
+            again.push_back(measure(family.scale(fragment, n * k), opt.minSeconds));
+        }
+        for (size_t i = 0; i < again.size(); ++i) {
+            out.steps[i].seconds = std::min(out.steps[i].seconds, again[i].seconds);
+        }
+        out.timeExponent = growthExponent(out.steps, &Measurement::seconds);
+    }
+    return out.timeExponent > opt.threshold || out.memoryExponent > opt.threshold;
+}
+
+// Delta-debugging style minimization over whitespace-separated pieces of the fragment.
+static std::string minimize(const Family& family, std::string fragment, const Options& opt) {
+    auto split = [](const std::string& s) {
+        std::vector<std::string> parts;
+        size_t i = 0;
+        while (i < s.size()) {
+            size_t j = s.find(' ', i);
+            if (j == std::string::npos) j = s.size();
+            if (j > i) parts.push_back(s.substr(i, j - i));
+            i = j + 1;
+        }
+        return parts;
+    };
+    auto join = [](const std::vector<std::string>& parts) {
+        std::string out;
+        for (const auto& p : parts) out += p + ' ';
+        return out;
+    };
+
+    std::vector<std::string> parts = split(fragment);
+    size_t chunk = std::max<size_t>(1, parts.size() / 2);
+    while (chunk >= 1 && parts.size() > 1) {
+        bool reduced = false;
+        for (size_t start = 0; start < parts.size() && parts.size() > 1; ) {
+            std::vector<std::string> candidate;
+            for (size_t i = 0; i < parts.size(); ++i) {
+                if (i < start || i >= start + chunk) candidate.push_back(parts[i]);
+            }
+            Finding probe;
+            if (!candidate.empty() && analyze(family, join(candidate), opt, probe)) {
+                parts = std::move(candidate);
+                reduced = true;
+            }
+            else {
+                start += chunk;
+            }
+        }
+        if (!reduced) {
+            if (chunk == 1) break;
+            chunk /= 2;
+        }
+    }
+    return join(parts);
+}
+
+static void report(const Finding& f) {
+    std::cout << "[!] super-linear " << f.family->name
+        << " (time exponent " << f.timeExponent
+        << ", memory exponent " << f.memoryExponent << ")\n";
+    std::cout << "    fragment: \"" << f.fragment << "\"\n";
+    for (const auto& m : f.steps) {
+        std::cout << "    " << m.bytes << " bytes: "
+            << (m.seconds * 1e9 / std::max<size_t>(1, m.bytes)) << " ns/byte, "
+            << m.heap << " peak heap bytes\n";
+    }
+}
+
+static std::string save(const Finding& f, const Options& opt) {
+    std::filesystem::create_directories(opt.outDir);
+    size_t hash = std::hash<std::string>{}(f.fragment) & 0xffffff;
+    char name[64];
+    std::snprintf(name, sizeof(name), "%s-%06zx.glx", f.family->name, hash);
+    std::filesystem::path path = std::filesystem::path(opt.outDir) / name;
+    std::ofstream out(path, std::ios::binary);
+    out << f.family->scale(f.fragment, f.n * 8);
+    return path.string();
+}
+
+static bool parseArgs(int argc, char* argv[], Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : nullptr; };
+        const char* v = nullptr;
+        if (arg == "--iterations" && (v = value())) opt.iterations = std::strtoull(v, nullptr, 10);
+        else if (arg == "--seed" && (v = value())) opt.seed = std::strtoull(v, nullptr, 10);
+        else if (arg == "--threshold" && (v = value())) opt.threshold = std::strtod(v, nullptr);
+        else if (arg == "--bytes" && (v = value())) opt.targetBytes = std::strtoull(v, nullptr, 10);
+        else if (arg == "--out" && (v = value())) opt.outDir = v;
+        else {
+            std::cerr << "Usage: " << argv[0]
+                << " [--iterations N] [--seed S] [--threshold X] [--bytes N] [--out dir]\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) return 2;
+
+    std::mt19937_64 rng(opt.seed);
+    std::vector<std::string> fragments = { "1", "a", "x1 + 2", "print(a);" };
+    for (size_t i = 0; i < opt.iterations; ++i) {
+        fragments.push_back(randomFragment(rng, 12));
+    }
+
+    // One finding per family: once a family is super-linear, every other fragment
+    // scaled the same way almost always hits the same root cause.
+    std::vector<bool> flagged(kFamilies.size(), false);
+    size_t findings = 0;
+    for (const auto& fragment : fragments) {
+        for (size_t i = 0; i < kFamilies.size(); ++i) {
+            const Family& family = kFamilies[i];
+            Finding f;
+            if (flagged[i] || !analyze(family, fragment, opt, f)) continue;
+
+            std::string minimal = minimize(family, fragment, opt);
+            if (!analyze(family, minimal, opt, f) && !analyze(family, fragment, opt, f)) {
+                continue; // did not reproduce
+            }
+            report(f);
+            std::cout << "    saved " << save(f, opt) << "\n";
+            flagged[i] = true;
+            ++findings;
+        }
+    }
+
+    std::cout << fragments.size() << " fragments x " << kFamilies.size() << " families, "
+        << findings << " super-linear finding(s)\n";
+    return findings ? 1 : 0;
+}